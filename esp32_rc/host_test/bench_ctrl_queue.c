@@ -0,0 +1,131 @@
+/*
+ * 控制数据按值过队列的开销: 旧的 double 结构体和现在 24 字节的 UiDataStruct 对比
+ *
+ * 队列按 FreeRTOS 的做法实现: 条目大小运行时给定，入队 / 出队各 memcpy 一次。
+ * 旧结构体按原来 udp_task.h 里的定义照抄。
+ *
+ * 用法: bench_ctrl_queue [-n 条数]
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "rc_ctrl_data.h"
+
+typedef struct
+{
+    double x;
+    double y;
+    double long_value;
+    int angle;
+} old_joystick_t;
+
+typedef struct
+{
+    old_joystick_t joystick1;
+    old_joystick_t joystick2;
+    float scroller_horiz1;
+    float scroller_vertical1;
+    int button_group1[10];
+    int button_group2[10];
+} old_ui_data_t;
+
+#define QUEUE_DEPTH 8
+
+typedef struct
+{
+    uint8_t *storage;
+    size_t item_size;
+    unsigned head;
+    unsigned count;
+} copy_queue_t;
+
+static void queue_init(copy_queue_t *q, size_t item_size)
+{
+    q->storage = malloc(item_size * QUEUE_DEPTH);
+    q->item_size = item_size;
+    q->head = 0;
+    q->count = 0;
+}
+
+static bool queue_send(copy_queue_t *q, const void *item)
+{
+    if (q->count == QUEUE_DEPTH)
+        return false;
+    unsigned tail = (q->head + q->count) % QUEUE_DEPTH;
+    memcpy(q->storage + tail * q->item_size, item, q->item_size);
+    q->count++;
+    return true;
+}
+
+static bool queue_receive(copy_queue_t *q, void *item)
+{
+    if (q->count == 0)
+        return false;
+    memcpy(item, q->storage + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % QUEUE_DEPTH;
+    q->count--;
+    return true;
+}
+
+// 每次写满半个队列再读空，模拟生产者 / 消费者交替
+static double run(size_t item_size, void *in, void *out, int items)
+{
+    copy_queue_t q;
+    queue_init(&q, item_size);
+    volatile int32_t sink = 0;
+    uint64_t t0 = test_now_ns();
+    for (int i = 0; i < items; i += QUEUE_DEPTH / 2)
+    {
+        for (int k = 0; k < QUEUE_DEPTH / 2; k++)
+        {
+            ((uint8_t *)in)[0] = (uint8_t)(i + k); // 每个条目内容不同
+            queue_send(&q, in);
+        }
+        for (int k = 0; k < QUEUE_DEPTH / 2; k++)
+        {
+            if (queue_receive(&q, out))
+                sink += (int32_t)((const uint8_t *)out)[0];
+        }
+    }
+    uint64_t dt = test_now_ns() - t0;
+    (void)sink;
+    free(q.storage);
+    return (double)dt / items;
+}
+
+int main(int argc, char **argv)
+{
+    int items = 10000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        if (opt == 'n')
+            items = atoi(optarg);
+    }
+
+    old_ui_data_t old_in, old_out;
+    memset(&old_in, 0, sizeof(old_in));
+    UiDataStruct in, out;
+    memset(&in, 0, sizeof(in));
+
+    double ns_old = run(sizeof(old_ui_data_t), &old_in, &old_out, items);
+    double ns_new = run(sizeof(UiDataStruct), &in, &out, items);
+
+    // 往返一次，内容要完全一致
+    copy_queue_t q;
+    queue_init(&q, sizeof(UiDataStruct));
+    in.x1 = 1234;
+    in.btn_g1 = 0x0155;
+    CHECK(queue_send(&q, &in));
+    CHECK(queue_receive(&q, &out));
+    CHECK(memcmp(&in, &out, sizeof(in)) == 0);
+    CHECK(!queue_receive(&q, &out));
+    free(q.storage);
+
+    printf("old double struct: %3zu B/item  %5.1f ns send+receive\n", sizeof(old_ui_data_t), ns_old);
+    printf("UiDataStruct:      %3zu B/item  %5.1f ns send+receive\n", sizeof(UiDataStruct), ns_new);
+    printf("queue storage at depth %d: %zu B -> %zu B\n", QUEUE_DEPTH, sizeof(old_ui_data_t) * QUEUE_DEPTH,
+           sizeof(UiDataStruct) * QUEUE_DEPTH);
+    return TEST_RESULT();
+}
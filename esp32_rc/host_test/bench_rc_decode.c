@@ -0,0 +1,139 @@
+/*
+ * 控制帧解码开销: JSON (rc_json_parse + rc_json_to_ctrl) 和二进制 (rc_packet_decode) 对比
+ *
+ * 随机生成一批控制状态，分别编码成手机端发的 JSON 文本和 24 字节二进制帧，
+ * 然后反复解码，报告每包字节数和每包解码耗时。两种解码结果要和原始状态一致
+ * (二进制逐位相同，JSON 在量化误差之内)，所以顺带也是一个对拍测试。
+ *
+ * 用法: bench_rc_decode [-n 轮数]
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "rc_json.h"
+#include "rc_packet.h"
+
+#define BENCH_PKTS 256
+
+static char s_json[BENCH_PKTS][256];
+static size_t s_json_len[BENCH_PKTS];
+static uint8_t s_bin[BENCH_PKTS][RC_PKT_SIZE];
+static UiDataStruct s_ref[BENCH_PKTS];
+
+static int16_t rand_q15(uint32_t *rng)
+{
+    return (int16_t)((int32_t)(test_rand(rng) % (2 * UI_AXIS_SCALE + 1)) - UI_AXIS_SCALE);
+}
+
+static void make_packets(void)
+{
+    uint32_t rng = 0xC0FFEEu;
+    for (int i = 0; i < BENCH_PKTS; i++)
+    {
+        UiDataStruct *d = &s_ref[i];
+        memset(d, 0, sizeof(*d));
+        d->x1 = rand_q15(&rng);
+        d->y1 = rand_q15(&rng);
+        d->x2 = rand_q15(&rng);
+        d->y2 = rand_q15(&rng);
+        d->sc_h1 = (int16_t)(test_rand(&rng) % 20001) - 10000;
+        d->sc_v1 = (int16_t)(test_rand(&rng) % 20001) - 10000;
+        d->btn_g1 = (uint16_t)(test_rand(&rng) & RC_PKT_BTN_MASK);
+
+        // 手机端的格式: 浮点摇杆 / 滑条，按钮是 0/1 数组
+        int n = snprintf(s_json[i], sizeof(s_json[i]),
+                         "{\"cmd\":\"ctrl\",\"seq\":%d,\"x1\":%.6f,\"y1\":%.6f,\"x2\":%.6f,\"y2\":%.6f,"
+                         "\"sc_h1\":%.2f,\"sc_v1\":%.2f,\"btn_g1\":[%d,%d,%d,%d,%d,%d,%d,%d,%d,%d]}",
+                         i, (double)d->x1 / UI_AXIS_SCALE, (double)d->y1 / UI_AXIS_SCALE,
+                         (double)d->x2 / UI_AXIS_SCALE, (double)d->y2 / UI_AXIS_SCALE,
+                         (double)d->sc_h1 / UI_SCROLLER_SCALE, (double)d->sc_v1 / UI_SCROLLER_SCALE,
+                         ui_button(d->btn_g1, 0), ui_button(d->btn_g1, 1), ui_button(d->btn_g1, 2),
+                         ui_button(d->btn_g1, 3), ui_button(d->btn_g1, 4), ui_button(d->btn_g1, 5),
+                         ui_button(d->btn_g1, 6), ui_button(d->btn_g1, 7), ui_button(d->btn_g1, 8),
+                         ui_button(d->btn_g1, 9));
+        CHECK(n > 0 && (size_t)n < sizeof(s_json[i]));
+        s_json_len[i] = (size_t)n;
+        CHECK_EQ(rc_packet_encode(d, (uint16_t)i, s_bin[i], RC_PKT_SIZE), RC_PKT_SIZE);
+    }
+}
+
+static bool same_ctrl(const UiDataStruct *a, const UiDataStruct *b, int tol)
+{
+    return abs(a->x1 - b->x1) <= tol && abs(a->y1 - b->y1) <= tol && abs(a->x2 - b->x2) <= tol &&
+           abs(a->y2 - b->y2) <= tol && a->sc_h1 == b->sc_h1 && a->sc_v1 == b->sc_v1 && a->btn_g1 == b->btn_g1;
+}
+
+static void check_decode(void)
+{
+    for (int i = 0; i < BENCH_PKTS; i++)
+    {
+        rc_json_msg_t m;
+        UiDataStruct d;
+        CHECK(rc_json_parse(s_json[i], s_json_len[i], &m));
+        CHECK_EQ(m.cmd, RC_CMD_CTRL);
+        rc_json_to_ctrl(&m, &d);
+        CHECK(same_ctrl(&d, &s_ref[i], 1)); // %.6f 往返最多差 1 个 Q15 步长
+
+        uint16_t seq = 0;
+        CHECK_EQ(rc_packet_decode(s_bin[i], RC_PKT_SIZE, &d, &seq), RC_PKT_OK);
+        CHECK_EQ(seq, i);
+        CHECK(same_ctrl(&d, &s_ref[i], 0));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        if (opt == 'n')
+            rounds = atoi(optarg);
+    }
+
+    make_packets();
+    check_decode();
+
+    size_t json_bytes = 0;
+    for (int i = 0; i < BENCH_PKTS; i++)
+        json_bytes += s_json_len[i];
+
+    // 累加解码结果，防止循环被优化掉
+    volatile int32_t sink = 0;
+    rc_json_msg_t m;
+    UiDataStruct d;
+
+    uint64_t t0 = test_now_ns();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < BENCH_PKTS; i++)
+        {
+            rc_json_parse(s_json[i], s_json_len[i], &m);
+            rc_json_to_ctrl(&m, &d);
+            sink += d.x1;
+        }
+    }
+    uint64_t t_json = test_now_ns() - t0;
+
+    t0 = test_now_ns();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int i = 0; i < BENCH_PKTS; i++)
+        {
+            rc_packet_decode(s_bin[i], RC_PKT_SIZE, &d, NULL);
+            sink += d.x1;
+        }
+    }
+    uint64_t t_bin = test_now_ns() - t0;
+    (void)sink;
+
+    double n = (double)rounds * BENCH_PKTS;
+    double ns_json = (double)t_json / n;
+    double ns_bin = (double)t_bin / n;
+    printf("json:   %5.1f B/pkt  %7.1f ns/pkt\n", (double)json_bytes / BENCH_PKTS, ns_json);
+    printf("binary: %5d B/pkt  %7.1f ns/pkt\n", RC_PKT_SIZE, ns_bin);
+    printf("binary is %.1fx smaller, %.1fx faster to decode\n", (double)json_bytes / BENCH_PKTS / RC_PKT_SIZE,
+           ns_json / (ns_bin > 0 ? ns_bin : 1));
+    return TEST_RESULT();
+}
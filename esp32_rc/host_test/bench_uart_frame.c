@@ -0,0 +1,101 @@
+/*
+ * UART 帧开销: 文本帧 (uart_frame_encode_text) 和 COBS 二进制帧 (uart_frame_encode_binary) 对比
+ *
+ * 对一批随机控制状态编码，报告每帧字节数 (平均 / 最大)、115200 8N1 下的线上时间
+ * 和这个波特率能撑的最高帧率，以及每帧编码耗时。
+ *
+ * 用法: bench_uart_frame [-n 轮数] [-b 波特率]
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "uart_frame.h"
+
+#define BENCH_FRAMES 256
+
+static UiDataStruct s_ref[BENCH_FRAMES];
+
+static int16_t rand_range(uint32_t *rng, int lim)
+{
+    return (int16_t)((int32_t)(test_rand(rng) % (2u * lim + 1)) - lim);
+}
+
+typedef struct {
+    const char *name;
+    size_t total;
+    size_t max;
+    double ns;
+} frame_cost_t;
+
+static void report(const frame_cost_t *c, uint32_t baud)
+{
+    double avg = (double)c->total / BENCH_FRAMES;
+    // 8N1: 每字节 10 位
+    double wire_us = c->max * 10.0 * 1e6 / baud;
+    printf("%-6s: %5.1f B avg  %3zu B max  %6.0f us/frame @%u  <= %4.0f Hz  %6.1f ns encode\n", c->name, avg, c->max,
+           wire_us, baud, 1e6 / wire_us, c->ns);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = 2000;
+    uint32_t baud = 115200;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:b:")) != -1)
+    {
+        if (opt == 'n')
+            rounds = atoi(optarg);
+        else if (opt == 'b')
+            baud = (uint32_t)strtoul(optarg, NULL, 10);
+    }
+
+    uint32_t rng = 0xBADC0DEu;
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        UiDataStruct *d = &s_ref[i];
+        memset(d, 0, sizeof(*d));
+        d->x1 = rand_range(&rng, UI_AXIS_SCALE);
+        d->y1 = rand_range(&rng, UI_AXIS_SCALE);
+        d->x2 = rand_range(&rng, UI_AXIS_SCALE);
+        d->y2 = rand_range(&rng, UI_AXIS_SCALE);
+        d->sc_h1 = rand_range(&rng, 10000);
+        d->sc_v1 = rand_range(&rng, 10000);
+        d->btn_g1 = (uint16_t)(test_rand(&rng) & 0x03FF);
+    }
+
+    frame_cost_t text = {.name = "text"}, bin = {.name = "binary"};
+    uint8_t buf[UART_FRAME_MAX_LEN];
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        size_t n = uart_frame_encode_text(&s_ref[i], (char *)buf, sizeof(buf));
+        CHECK(n > 0);
+        text.total += n;
+        if (n > text.max)
+            text.max = n;
+
+        n = uart_frame_encode_binary(&s_ref[i], (uint8_t)i, buf, sizeof(buf));
+        CHECK_EQ(n, UART_COBS_MAX_LEN(UART_CTRL_RAW_LEN));
+        bin.total += n;
+        if (n > bin.max)
+            bin.max = n;
+    }
+
+    volatile size_t sink = 0;
+    uint64_t t0 = test_now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_FRAMES; i++)
+            sink += uart_frame_encode_text(&s_ref[i], (char *)buf, sizeof(buf));
+    text.ns = (double)(test_now_ns() - t0) / ((double)rounds * BENCH_FRAMES);
+
+    t0 = test_now_ns();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < BENCH_FRAMES; i++)
+            sink += uart_frame_encode_binary(&s_ref[i], (uint8_t)i, buf, sizeof(buf));
+    bin.ns = (double)(test_now_ns() - t0) / ((double)rounds * BENCH_FRAMES);
+    (void)sink;
+
+    report(&text, baud);
+    report(&bin, baud);
+    return TEST_RESULT();
+}
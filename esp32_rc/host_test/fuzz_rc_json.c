@@ -0,0 +1,220 @@
+/*
+ * rc_json_parse 的模糊测试和吞吐量测量
+ *
+ * 默认是自带的变异模糊器: 从一组合法报文出发做翻转 / 插入 / 删除 / 截断 / 拼接，
+ * 每个输入放进正好同样大小的堆缓冲区解析 (配合 RC_HOST_SANITIZE=ON 能抓到越界读)，
+ * 并检查解析结果的不变量。随机种子固定，失败可以复现。
+ * 最后测一下典型 ctrl 报文的解析速度 (ns/包、MB/s)。
+ *
+ * 也可以用 libFuzzer 跑 (需要 clang):
+ *   clang -g -O1 -fsanitize=fuzzer,address -DRC_LIBFUZZER -I../main/wifi/sta_communicate -I. \
+ *         fuzz_rc_json.c ../main/wifi/sta_communicate/rc_json.c -o fuzz_rc_json
+ *
+ * 用法: fuzz_rc_json [-n 次数] [-s 种子]
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "rc_json.h"
+
+static uint32_t s_accepted;
+
+static bool within(const char *p, size_t n, const uint8_t *buf, size_t size)
+{
+    return p >= (const char *)buf && p + n <= (const char *)buf + size;
+}
+
+static void check_one(const uint8_t *data, size_t size)
+{
+    // 正好 size 字节的缓冲区，越界读会被 ASan 发现
+    uint8_t *buf = malloc(size ? size : 1);
+    memcpy(buf, data, size);
+
+    rc_json_msg_t m;
+    if (rc_json_parse((const char *)buf, size, &m))
+    {
+        s_accepted++;
+        CHECK(m.cmd >= RC_CMD_NONE && m.cmd <= RC_CMD_TAKEOVER);
+        CHECK(m.btn_g1_count >= 0);
+        for (int i = 0; i < m.btn_g1_count; i++)
+            CHECK(m.btn_g1[i] == 0 || m.btn_g1[i] == 1);
+        if (m.present & RC_JSON_HAS_DEVICE)
+            CHECK(within(m.device, m.device_len, buf, size));
+        if (m.present & RC_JSON_HAS_AUTH)
+            CHECK(within(m.auth, m.auth_len, buf, size));
+
+        UiDataStruct d;
+        rc_json_to_ctrl(&m, &d);
+        CHECK(d.x1 >= -UI_AXIS_SCALE && d.x1 <= UI_AXIS_SCALE);
+        CHECK((d.btn_g1 & ~((1u << UI_BUTTON_COUNT) - 1)) == 0);
+
+        char copy[16];
+        if (m.present & RC_JSON_HAS_DEVICE)
+        {
+            rc_json_copy_string(copy, sizeof(copy), m.device, m.device_len);
+            CHECK(strlen(copy) < sizeof(copy));
+        }
+    }
+    free(buf);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    check_one(data, size);
+    return 0;
+}
+
+#ifndef RC_LIBFUZZER
+
+static const char *const s_seeds[] = {
+    "{\"cmd\":\"ctrl\",\"seq\":42,\"x1\":0.1,\"y1\":-0.2,\"x2\":0,\"y2\":0,\"sc_h1\":0,\"sc_v1\":0,\"btn_g1\":[0,1,0]}",
+    "{\"cmd\":\"connect\",\"device\":\"Pixel 7 \\\"a\\\" \\u00e9\",\"role\":\"spectator\"}",
+    "{\"cmd\":\"takeover\",\"auth\":\"0123456789abcdef0123456789abcdef\",\"prio\":2}",
+    "{\"cmd\":\"disconnect\"}",
+    "{ \"x1\" : -1.5e-3 , \"y1\" : 1E2, \"extra\": {\"a\": [true, false, null, {\"b\": []}]}, \"cmd\": \"ctrl\" }",
+    "{}",
+    "{\"cmd\":\"ctrl\",\"btn_g1\":[1e18,3e9,-4e9,0.5]}",
+};
+
+static const char *const s_tokens[] = {
+    "{", "}", "[", "]", "\"", ":", ",", "\\", "\\u", "-", ".", "e", "E+", "0", "9", "null", "true",
+    "\"cmd\"", "\"ctrl\"", "\"btn_g1\"", "\"device\"", "1e999", "-0", "\0", " ", "\xff",
+};
+
+#define FUZZ_MAX_LEN 512
+
+static size_t mutate(uint8_t *buf, size_t len, uint32_t *rng)
+{
+    int rounds = 1 + (int)(test_rand(rng) % 4);
+    for (int r = 0; r < rounds; r++)
+    {
+        uint32_t op = test_rand(rng) % 7;
+        size_t pos = len ? test_rand(rng) % (len + 1) : 0;
+        switch (op)
+        {
+        case 0: // 翻转一位
+            if (len)
+                buf[pos % len] ^= (uint8_t)(1u << (test_rand(rng) % 8));
+            break;
+        case 1: // 改成随机字节
+            if (len)
+                buf[pos % len] = (uint8_t)test_rand(rng);
+            break;
+        case 2: // 删除一段
+            if (len)
+            {
+                size_t n = 1 + test_rand(rng) % 8;
+                if (pos + n > len)
+                    n = len - pos;
+                memmove(buf + pos, buf + pos + n, len - pos - n);
+                len -= n;
+            }
+            break;
+        case 3: // 截断
+            len = pos;
+            break;
+        case 4: // 插入一个语法记号
+        {
+            const char *t = s_tokens[test_rand(rng) % (sizeof(s_tokens) / sizeof(s_tokens[0]))];
+            size_t n = t[0] ? strlen(t) : 1;
+            if (len + n > FUZZ_MAX_LEN)
+                break;
+            memmove(buf + pos + n, buf + pos, len - pos);
+            memcpy(buf + pos, t, n);
+            len += n;
+            break;
+        }
+        case 5: // 复制一段 (制造深嵌套 / 重复 key)
+        {
+            if (!len)
+                break;
+            size_t from = test_rand(rng) % len;
+            size_t n = 1 + test_rand(rng) % 32;
+            if (from + n > len)
+                n = len - from;
+            if (len + n > FUZZ_MAX_LEN)
+                break;
+            uint8_t tmp[FUZZ_MAX_LEN];
+            memcpy(tmp, buf + from, n);
+            memmove(buf + pos + n, buf + pos, len - pos);
+            memcpy(buf + pos, tmp, n);
+            len += n;
+            break;
+        }
+        default: // 重复一个字符很多次 (长数字 / 长字符串)
+        {
+            if (!len)
+                break;
+            uint8_t ch = buf[pos % len];
+            size_t n = 1 + test_rand(rng) % 64;
+            if (len + n > FUZZ_MAX_LEN)
+                break;
+            memmove(buf + pos + n, buf + pos, len - pos);
+            memset(buf + pos, ch, n);
+            len += n;
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+// 典型 ctrl 报文的解析速度
+static void bench_ctrl(void)
+{
+    const char *msg = s_seeds[0];
+    size_t len = strlen(msg);
+    const int iters = 200000;
+    rc_json_msg_t m;
+    uint64_t t0 = test_now_ns();
+    for (int i = 0; i < iters; i++)
+    {
+        if (!rc_json_parse(msg, len, &m))
+            test_failures++;
+    }
+    uint64_t dt = test_now_ns() - t0;
+    printf("ctrl parse: %zu B, %.0f ns/msg, %.1f MB/s\n", len, (double)dt / iters,
+           (double)len * iters * 1e3 / (double)dt);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iters = 200000;
+    uint32_t rng = 0x1234567u;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        if (opt == 'n')
+            iters = (uint32_t)strtoul(optarg, NULL, 10);
+        else if (opt == 's')
+            rng = (uint32_t)strtoul(optarg, NULL, 0) | 1u;
+    }
+
+    const size_t nseeds = sizeof(s_seeds) / sizeof(s_seeds[0]);
+    for (size_t i = 0; i < nseeds; i++)
+    {
+        rc_json_msg_t m;
+        CHECK(rc_json_parse(s_seeds[i], strlen(s_seeds[i]), &m));
+    }
+
+    uint8_t buf[FUZZ_MAX_LEN];
+    uint64_t bytes = 0;
+    uint64_t t0 = test_now_ns();
+    for (uint32_t i = 0; i < iters; i++)
+    {
+        const char *seed = s_seeds[test_rand(&rng) % nseeds];
+        size_t len = strlen(seed);
+        memcpy(buf, seed, len);
+        len = mutate(buf, len, &rng);
+        check_one(buf, len);
+        bytes += len;
+    }
+    uint64_t dt = test_now_ns() - t0;
+    printf("fuzz: %u inputs, %u accepted, %.1f MB/s (incl. malloc + checks)\n", iters, s_accepted,
+           (double)bytes * 1e3 / (double)(dt ? dt : 1));
+    bench_ctrl();
+    return TEST_RESULT();
+}
+
+#endif
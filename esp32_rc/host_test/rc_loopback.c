@@ -0,0 +1,386 @@
+/*
+ * 主机上的端到端回环: 手机 (UDP 发送) -> 设备逻辑 -> UART (pty) -> 电机板 (解析)
+ *
+ *   发送线程 (main): 通过本机回环 UDP 发 connect，然后按给定速率发控制包 (二进制帧或 JSON)
+ *   设备线程: select() 收包 -> rc_packet / rc_json 解析 -> rc_session / rc_link 检查
+ *             -> rc_shape_axis 整形 -> uart_sched 判断 -> uart_frame_encode_binary -> 写 pty 主端
+ *   电机板线程: 从 pty 从端读字节流 -> uart_frame_parser 切帧、CRC 校验 -> 解码
+ *
+ * 控制包的 x1 等于包序号 (0..29999 循环)，电机板由 x1 找回发送时间，
+ * 统计每包 UDP 发送 -> UART 帧解析完成 的延迟 (p50 / p99 / 最大) 和吞吐量。
+ * 设备线程用的都是固件里的纯逻辑源文件，只有 socket / pty / 线程是主机的。
+ *
+ * 用法: rc_loopback [-n 包数] [-r 每秒包数，0 = 尽快] [-j 发 JSON]
+ * 没有 pty 的环境返回 77 (ctest 记为跳过)。
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include "test_util.h"
+#include "rc_packet.h"
+#include "rc_json.h"
+#include "rc_session.h"
+#include "rc_link.h"
+#include "rc_shaping.h"
+#include "uart_sched.h"
+#include "uart_frame.h"
+
+#define SEQ_SPAN 30000   // x1 能表示的序号范围
+#define SKIP_RC  77
+
+typedef struct {
+    int udp;             // 设备端 socket
+    int pty_master;      // 设备写 UART
+    int pty_slave;       // 电机板读 UART
+    uint32_t count;
+    atomic_bool device_done;
+
+    uint64_t *sent_ns;   // 按序号记录发送时间
+    uint32_t *lat_us;    // 电机板侧每帧的延迟
+    atomic_uint received;
+    int64_t last_index;  // 电机板上一次解析出的包序号
+    uint64_t last_rx_ns; // 电机板解析出最后一帧的时间
+
+    // 设备线程的统计
+    atomic_uint accepted;
+    uint32_t stale;
+    uint32_t bad;
+    uint32_t uart_frames;
+    uint64_t uart_bytes;
+    uart_frame_parser_stats_t parser;
+} loop_t;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(test_now_ns() / 1000000u);
+}
+
+// ================= 设备 =================
+
+static void device_emit(loop_t *L, uart_sched_t *sched, const UiDataStruct *d, uint8_t *seq)
+{
+    uart_sched_action_t a = uart_sched_decide(sched, d, 1, now_ms());
+    if (a == UART_SCHED_NONE)
+        return;
+    uint8_t frame[UART_FRAME_MAX_LEN];
+    size_t n = uart_frame_encode_binary(d, (*seq)++, frame, sizeof(frame));
+    for (size_t off = 0; off < n;)
+    {
+        ssize_t w = write(L->pty_master, frame + off, n - off);
+        if (w < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return;
+        }
+        off += (size_t)w;
+    }
+    uart_sched_sent(sched, a, d, n, now_ms());
+    L->uart_frames++;
+    L->uart_bytes += n;
+}
+
+static void *device_thread(void *arg)
+{
+    loop_t *L = arg;
+    rc_session_t session;
+    rc_session_init(&session);
+    uart_sched_t sched;
+    uart_sched_init(&sched, UART_KEEPALIVE_MS);
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    rc_shape_state_t shape[RC_SHAPE_AXIS_COUNT];
+    for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+        rc_shape_default(&params[i]);
+    memset(shape, 0, sizeof(shape));
+    uint8_t uart_seq = 0;
+    uint32_t last_us = 0;
+
+    char buf[256];
+    for (;;)
+    {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(L->udp, &rfds);
+        struct timeval tv = {.tv_sec = 2};
+        if (select(L->udp + 1, &rfds, NULL, NULL, &tv) <= 0)
+            break;
+
+        struct sockaddr_in from;
+        socklen_t fl = sizeof(from);
+        ssize_t len = recvfrom(L->udp, buf, sizeof(buf) - 1, 0, (struct sockaddr *)&from, &fl);
+        if (len <= 0)
+            continue;
+        uint32_t rx_us = (uint32_t)(test_now_ns() / 1000u);
+        rc_peer_t peer = {.addr = from.sin_addr.s_addr, .port = from.sin_port};
+
+        UiDataStruct d;
+        bool has_seq = false;
+        uint16_t seq = 0;
+        if (rc_packet_is_binary((const uint8_t *)buf, (size_t)len))
+        {
+            if (!rc_session_is_client(&session, &peer))
+                continue;
+            if (rc_packet_decode((const uint8_t *)buf, (size_t)len, &d, &seq) != RC_PKT_OK)
+            {
+                L->bad++;
+                continue;
+            }
+            has_seq = true;
+        }
+        else
+        {
+            rc_json_msg_t msg;
+            if (!rc_json_parse(buf, (size_t)len, &msg))
+            {
+                L->bad++;
+                continue;
+            }
+            if (msg.cmd == RC_CMD_CONNECT)
+            {
+                int slot;
+                rc_session_connect(&session, &peer, false, now_ms(), &slot);
+                continue;
+            }
+            if (msg.cmd == RC_CMD_DISCONNECT)
+                break;
+            if (msg.cmd != RC_CMD_CTRL || !rc_session_is_client(&session, &peer))
+                continue;
+            rc_json_to_ctrl(&msg, &d);
+            has_seq = (msg.present & RC_JSON_HAS_SEQ) != 0;
+            seq = msg.seq;
+        }
+
+        bool fresh = true;
+        if (has_seq)
+            fresh = rc_link_accept(&session.link, seq, rx_us);
+        else
+            rc_link_note_unsequenced(&session.link, rx_us);
+        rc_session_touch(&session, now_ms());
+        if (!fresh)
+        {
+            L->stale++;
+            continue;
+        }
+        L->accepted++;
+
+        uint32_t dt = last_us ? rx_us - last_us : 0;
+        last_us = rx_us;
+        d.x1 = rc_shape_axis(&params[0], &shape[0], d.x1, dt);
+        d.y1 = rc_shape_axis(&params[1], &shape[1], d.y1, dt);
+        d.x2 = rc_shape_axis(&params[2], &shape[2], d.x2, dt);
+        d.y2 = rc_shape_axis(&params[3], &shape[3], d.y2, dt);
+        device_emit(L, &sched, &d, &uart_seq);
+    }
+    atomic_store(&L->device_done, true);
+    return NULL;
+}
+
+// ================= 电机板 =================
+
+static void on_uart_frame(uint8_t type, const uint8_t *payload, size_t len, void *ctx)
+{
+    loop_t *L = ctx;
+    uint64_t t = test_now_ns();
+    if (type != UART_MSG_CTRL || len != UART_CTRL_PAYLOAD_LEN)
+        return;
+    int16_t x1 = (int16_t)(payload[2] | (payload[3] << 8));
+    if (x1 < 0 || x1 >= SEQ_SPAN)
+        return;
+    // 帧按发送顺序到达 (中间可能丢包): 取上一帧之后第一个 x1 相同的序号
+    uint32_t r = atomic_load(&L->received);
+    int64_t i = x1;
+    while (i <= L->last_index)
+        i += SEQ_SPAN;
+    if (r >= L->count || i >= L->count)
+        return;
+    L->last_index = i;
+    L->lat_us[r] = (uint32_t)((t - L->sent_ns[i]) / 1000u);
+    L->last_rx_ns = t;
+    atomic_store(&L->received, r + 1);
+}
+
+static void *board_thread(void *arg)
+{
+    loop_t *L = arg;
+    uart_frame_parser_t p;
+    uart_frame_parser_init(&p, on_uart_frame, L);
+    uint8_t buf[1024];
+    for (;;)
+    {
+        struct pollfd pfd = {.fd = L->pty_slave, .events = POLLIN};
+        int n = poll(&pfd, 1, 200);
+        if (n <= 0)
+        {
+            if (atomic_load(&L->device_done))
+                break;
+            continue;
+        }
+        ssize_t r = read(L->pty_slave, buf, sizeof(buf));
+        if (r <= 0)
+            break;
+        uart_frame_parser_feed(&p, buf, (size_t)r);
+    }
+    L->parser = p.stats;
+    return NULL;
+}
+
+// ================= 主机环境 =================
+
+static int open_pty(int *master, int *slave)
+{
+    int m = posix_openpt(O_RDWR | O_NOCTTY);
+    if (m < 0 || grantpt(m) != 0 || unlockpt(m) != 0)
+        return -1;
+    int s = open(ptsname(m), O_RDWR | O_NOCTTY);
+    if (s < 0)
+        return -1;
+    // 原始模式: 不做行缓冲，不转换 0x00 / '\n'
+    struct termios tio;
+    tcgetattr(s, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(s, TCSANOW, &tio);
+    tcgetattr(m, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(m, TCSANOW, &tio);
+    *master = m;
+    *slave = s;
+    return 0;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 5000;
+    uint32_t rate = 0;
+    bool json = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:j")) != -1)
+    {
+        if (opt == 'n')
+            count = (uint32_t)strtoul(optarg, NULL, 10);
+        else if (opt == 'r')
+            rate = (uint32_t)strtoul(optarg, NULL, 10);
+        else if (opt == 'j')
+            json = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [-n count] [-r pkts_per_s] [-j]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (count == 0)
+        count = 1;
+
+    loop_t L;
+    memset(&L, 0, sizeof(L));
+    L.count = count;
+    L.last_index = -1;
+    L.sent_ns = calloc(count, sizeof(uint64_t));
+    L.lat_us = calloc(count, sizeof(uint32_t));
+    if (open_pty(&L.pty_master, &L.pty_slave) != 0)
+    {
+        printf("no pty available, skipped\n");
+        return SKIP_RC;
+    }
+
+    struct sockaddr_in dev = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    L.udp = socket(AF_INET, SOCK_DGRAM, 0);
+    socklen_t dl = sizeof(dev);
+    int rcvbuf = 1 << 20;
+    setsockopt(L.udp, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (L.udp < 0 || bind(L.udp, (struct sockaddr *)&dev, sizeof(dev)) != 0 ||
+        getsockname(L.udp, (struct sockaddr *)&dev, &dl) != 0)
+    {
+        printf("no loopback UDP, skipped\n");
+        return SKIP_RC;
+    }
+    int phone = socket(AF_INET, SOCK_DGRAM, 0);
+
+    pthread_t dev_th, board_th;
+    pthread_create(&dev_th, NULL, device_thread, &L);
+    pthread_create(&board_th, NULL, board_thread, &L);
+
+    const char *connect = "{\"cmd\":\"connect\"}";
+    sendto(phone, connect, strlen(connect), 0, (struct sockaddr *)&dev, sizeof(dev));
+    usleep(10000);
+
+    uint64_t period_ns = rate ? 1000000000ull / rate : 0;
+    uint64_t t0 = test_now_ns();
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (period_ns)
+            while (test_now_ns() < t0 + i * period_ns)
+                ;
+        UiDataStruct d;
+        memset(&d, 0, sizeof(d));
+        d.x1 = (int16_t)(i % SEQ_SPAN);
+        d.btn_g1 = (uint16_t)(i & 1);
+        char pkt[256];
+        size_t n;
+        if (json)
+            n = (size_t)snprintf(pkt, sizeof(pkt),
+                                 "{\"cmd\":\"ctrl\",\"seq\":%u,\"x1\":%.6f,\"y1\":0,\"x2\":0,\"y2\":0,"
+                                 "\"sc_h1\":0,\"sc_v1\":0,\"btn_g1\":[%d,0,0,0,0,0,0,0,0,0]}",
+                                 (unsigned)(i & 0xFFFF), d.x1 / (double)UI_AXIS_SCALE, (int)(i & 1));
+        else
+            n = rc_packet_encode(&d, (uint16_t)i, (uint8_t *)pkt, sizeof(pkt));
+        L.sent_ns[i] = test_now_ns();
+        sendto(phone, pkt, n, 0, (struct sockaddr *)&dev, sizeof(dev));
+        bytes += n;
+        // 尽快发送时偶尔让一下，免得把接收缓冲区灌满
+        if (!period_ns && (i & 63) == 63)
+            usleep(200);
+    }
+    uint64_t t_send = test_now_ns() - t0;
+
+    // 等电机板收完 (最多 2 秒)
+    uint64_t wait_end = test_now_ns() + 2000000000ull;
+    while (atomic_load(&L.received) < atomic_load(&L.accepted) && test_now_ns() < wait_end)
+        usleep(1000);
+    uint32_t got = atomic_load(&L.received);
+    const char *bye = "{\"cmd\":\"disconnect\"}";
+    sendto(phone, bye, strlen(bye), 0, (struct sockaddr *)&dev, sizeof(dev));
+    pthread_join(dev_th, NULL);
+    pthread_join(board_th, NULL);
+    got = atomic_load(&L.received);
+    uint64_t t_total = (got ? L.last_rx_ns : test_now_ns()) - t0;
+
+    qsort(L.lat_us, got, sizeof(uint32_t), cmp_u32);
+    printf("mode %s: sent %u pkts (%zu B UDP), accepted %u, stale %u, bad %u\n", json ? "json" : "binary",
+           count, bytes, atomic_load(&L.accepted), L.stale, L.bad);
+    printf("uart: %u frames, %llu B, parsed %u, crc err %u, framing err %u\n", L.uart_frames,
+           (unsigned long long)L.uart_bytes, got, L.parser.crc_errors, L.parser.framing_errors);
+    printf("throughput: %.0f pkts/s (send %.1f ms, last frame parsed at %.1f ms)\n", got * 1e9 / (double)t_total,
+           t_send / 1e6, t_total / 1e6);
+    if (got)
+        printf("latency udp->uart parsed: p50 %u us, p99 %u us, max %u us\n", L.lat_us[got / 2],
+               L.lat_us[(uint64_t)got * 99 / 100], L.lat_us[got - 1]);
+
+    // 每个通过检查的控制包都必须变成一帧完好的 UART 帧
+    CHECK(L.accepted > 0);
+    CHECK_EQ(L.bad, 0);
+    CHECK_EQ(L.uart_frames, L.accepted);
+    CHECK_EQ(got, L.uart_frames);
+    CHECK_EQ(L.parser.crc_errors, 0);
+    CHECK_EQ(L.parser.framing_errors, 0);
+    free(L.sent_ns);
+    free(L.lat_us);
+    return TEST_RESULT();
+}
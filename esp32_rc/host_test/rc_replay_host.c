@@ -0,0 +1,176 @@
+/*
+ * 在电脑上回放设备录下的控制会话 (GET /api/rec/data 下载的 rc_rec.bin，格式见 rc_replay.h)
+ *
+ * 和设备上的回放任务 (rc_record.c) 用同一个 rc_replay 流水线:
+ *   只用当前会话手机发来的控制包 (RC_REC_FLAG_CLIENT)，经过 rc_link 的序号检查，
+ *   依次 解析 (rc_packet / rc_json) -> 整形 (默认参数，即不整形) -> UART 编码，
+ *   报告每一级每包的平均 / 最大耗时 (ns)。
+ *
+ * 用法: rc_replay_host [-r] [-b] [-n 遍数] rc_rec.bin
+ *   -r  按录制时的时间间隔回放 (默认尽快)
+ *   -b  编码成二进制 UART 帧 (默认文本帧，和 UART_FRAME_MODE 的默认值一样)
+ *   -n  尽快回放时重复整个文件多少遍，让计时更稳定
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "rc_replay.h"
+
+static uint32_t ns_clock(void)
+{
+    return (uint32_t)test_now_ns();
+}
+
+static uint8_t *load(const char *path, size_t *len)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *buf = size > 0 ? malloc((size_t)size) : NULL;
+    if (buf && fread(buf, 1, (size_t)size, fp) != (size_t)size)
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(fp);
+    *len = buf ? (size_t)size : 0;
+    return buf;
+}
+
+static void sleep_until(uint64_t due_ns)
+{
+    uint64_t now = test_now_ns();
+    if (due_ns > now)
+    {
+        struct timespec ts = {.tv_sec = (time_t)((due_ns - now) / 1000000000ull),
+                              .tv_nsec = (long)((due_ns - now) % 1000000000ull)};
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 整形没有统计最大值，max 传 0
+static void report(const char *name, uint64_t total, uint32_t max, uint32_t n)
+{
+    printf("%-7s %9.1f ns avg", name, n ? (double)total / n : 0.0);
+    if (max)
+        printf("  %8lu ns max", (unsigned long)max);
+    printf("  (%lu)\n", (unsigned long)n);
+}
+
+int main(int argc, char **argv)
+{
+    bool realtime = false;
+    bool binary = false;
+    int passes = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "rbn:")) != -1)
+    {
+        if (opt == 'r')
+            realtime = true;
+        else if (opt == 'b')
+            binary = true;
+        else if (opt == 'n')
+            passes = atoi(optarg);
+        else
+        {
+            fprintf(stderr, "usage: %s [-r] [-b] [-n passes] rc_rec.bin\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-r] [-b] [-n passes] rc_rec.bin\n", argv[0]);
+        return 2;
+    }
+    if (realtime || passes < 1)
+        passes = 1;
+
+    size_t len;
+    uint8_t *data = load(argv[optind], &len);
+    if (!data)
+    {
+        fprintf(stderr, "cannot read %s\n", argv[optind]);
+        return 1;
+    }
+
+    rc_rec_header_t h;
+    if (len < sizeof(h))
+    {
+        fprintf(stderr, "file too short\n");
+        free(data);
+        return 1;
+    }
+    memcpy(&h, data, sizeof(h));
+    if (memcmp(h.magic, RC_REC_MAGIC, 4) != 0 || h.version != RC_REC_VERSION || h.header_size != RC_REC_HEADER_SIZE)
+    {
+        fprintf(stderr, "not a recording (bad magic / version, recording not stopped?)\n");
+        free(data);
+        return 1;
+    }
+    size_t end = RC_REC_HEADER_SIZE + (size_t)h.data_bytes;
+    if (end > len)
+        end = len;
+
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+        rc_shape_default(&params[i]);
+    static rc_replay_t r;
+    rc_replay_stats_t total = {0};
+
+    uint64_t start_ns = test_now_ns();
+    for (int pass = 0; pass < passes; pass++)
+    {
+        // 每一遍都是新的会话 (序号检查和整形状态重新开始)
+        rc_replay_init(&r, params, binary, ns_clock);
+        size_t off = RC_REC_HEADER_SIZE;
+        while (off + sizeof(rc_rec_entry_t) <= end)
+        {
+            rc_rec_entry_t e;
+            memcpy(&e, data + off, sizeof(e));
+            if (e.len > RC_REC_MAX_PAYLOAD || off + sizeof(e) + e.len > end)
+            {
+                fprintf(stderr, "corrupt record at 0x%zx, stopping\n", off);
+                break;
+            }
+            if (realtime)
+                sleep_until(start_ns + (uint64_t)e.t_us * 1000);
+            rc_replay_packet(&r, &e, data + off + sizeof(e));
+            off += RC_REC_ALIGN4(sizeof(e) + e.len);
+        }
+
+        const rc_replay_stats_t *s = &r.stats;
+        total.packets += s->packets;
+        total.parse_ok += s->parse_ok;
+        total.ctrl += s->ctrl;
+        total.not_client += s->not_client;
+        total.stale += s->stale;
+        total.parse_ticks += s->parse_ticks;
+        total.shape_ticks += s->shape_ticks;
+        total.encode_ticks += s->encode_ticks;
+        if (s->parse_max_ticks > total.parse_max_ticks)
+            total.parse_max_ticks = s->parse_max_ticks;
+        if (s->encode_max_ticks > total.encode_max_ticks)
+            total.encode_max_ticks = s->encode_max_ticks;
+    }
+    uint64_t wall_ns = test_now_ns() - start_ns;
+
+    printf("# %u records (header says %u), %u dropped while recording, %.1f s recorded\n",
+           total.packets / (uint32_t)passes, h.records, h.dropped, h.duration_us / 1e6);
+    printf("# %s, %s frames, %d pass(es), wall %.1f ms\n", realtime ? "realtime" : "max speed",
+           binary ? "binary" : "text", passes, wall_ns / 1e6);
+    printf("packets %u  parse_ok %u  ctrl %u  not_client %u  stale %u\n", total.packets, total.parse_ok,
+           total.ctrl, total.not_client, total.stale);
+    report("parse", total.parse_ticks, total.parse_max_ticks, total.packets);
+    report("shape", total.shape_ticks, 0, total.ctrl);
+    report("encode", total.encode_ticks, total.encode_max_ticks, total.ctrl);
+
+    free(data);
+    CHECK(total.packets > 0);
+    return TEST_RESULT();
+}
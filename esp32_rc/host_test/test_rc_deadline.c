@@ -0,0 +1,47 @@
+// rc_deadline: UDP 任务的截止时间队列
+#include "test_util.h"
+#include "rc_deadline.h"
+
+int main(void)
+{
+    rc_deadline_queue_t q = {0};
+    uint32_t wait;
+
+    CHECK(!rc_deadline_next(&q, 0, &wait));
+    CHECK_EQ(rc_deadline_pop(&q, 0), -1);
+
+    rc_deadline_set(&q, 0, 300);
+    rc_deadline_set(&q, 2, 100);
+    rc_deadline_set(&q, 1, 200);
+    CHECK(rc_deadline_next(&q, 50, &wait));
+    CHECK_EQ(wait, 50);
+
+    // 重新设置覆盖旧值
+    rc_deadline_set(&q, 2, 250);
+    CHECK(rc_deadline_next(&q, 50, &wait));
+    CHECK_EQ(wait, 150);
+
+    CHECK_EQ(rc_deadline_pop(&q, 199), -1);
+    CHECK_EQ(rc_deadline_pop(&q, 260), 1);
+    CHECK_EQ(rc_deadline_pop(&q, 260), 2);
+    CHECK_EQ(rc_deadline_pop(&q, 260), -1);
+    CHECK(rc_deadline_is_armed(&q, 0));
+    rc_deadline_cancel(&q, 0);
+    CHECK(!rc_deadline_next(&q, 260, &wait));
+
+    // 已经过期的返回 0
+    rc_deadline_set(&q, 3, 10);
+    CHECK(rc_deadline_next(&q, 20, &wait));
+    CHECK_EQ(wait, 0);
+    rc_deadline_cancel(&q, 3);
+
+    // 跨 32 位回绕比较
+    rc_deadline_set(&q, 0, 0x10);
+    rc_deadline_set(&q, 1, 0xFFFFFFF0u);
+    CHECK(rc_deadline_next(&q, 0xFFFFFFE0u, &wait));
+    CHECK_EQ(wait, 0x10);
+    CHECK_EQ(rc_deadline_pop(&q, 0xFFFFFFF8u), 1);
+    CHECK_EQ(rc_deadline_pop(&q, 0xFFFFFFF8u), -1);
+    CHECK_EQ(rc_deadline_pop(&q, 0x10), 0);
+    return TEST_RESULT();
+}
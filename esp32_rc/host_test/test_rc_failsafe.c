@@ -0,0 +1,68 @@
+// rc_failsafe: 失控保护的武装 / 到期判断，用假时钟模拟 esp_timer 的各种时序
+#include "test_util.h"
+#include "rc_failsafe.h"
+#include "rc_link.h"
+
+#define FAILSAFE_MIN_MS 500   // 和 udp_task.h 的 MOTOR_FAILSAFE_MS / MOTOR_FAILSAFE_MAX_MS 一致
+#define FAILSAFE_MAX_MS 1000
+
+static uint64_t fake_now_us;
+
+int main(void)
+{
+    rc_failsafe_t fs = {0};
+
+    // 未武装时到期什么都不做
+    CHECK(!rc_failsafe_expire(&fs, 0));
+
+    // 正常到期: 只触发一次，记录迟到时间
+    fake_now_us = 1000000;
+    rc_failsafe_arm(&fs, fake_now_us, 500000);
+    CHECK(!rc_failsafe_expire(&fs, fake_now_us + 499999));
+    fake_now_us += 500000 + 1200;
+    CHECK(rc_failsafe_expire(&fs, fake_now_us));
+    CHECK_EQ(fs.trips, 1);
+    CHECK_EQ(fs.max_late_us, 1200);
+    CHECK(!rc_failsafe_expire(&fs, fake_now_us + 1));
+    CHECK_EQ(fs.trips, 1);
+
+    // 回调已经排队，但期间又收到指令重新武装了: 不能停车
+    fake_now_us = 5000000;
+    rc_failsafe_arm(&fs, fake_now_us, 500000);
+    fake_now_us += 499000;
+    rc_failsafe_arm(&fs, fake_now_us, 500000);       // 喂狗
+    CHECK(!rc_failsafe_expire(&fs, fake_now_us + 1000)); // 旧定时器的回调迟到执行
+    CHECK(rc_failsafe_expire(&fs, fake_now_us + 500000));
+    CHECK_EQ(fs.trips, 2);
+
+    // 主动断开后不再触发
+    rc_failsafe_arm(&fs, fake_now_us, 500000);
+    rc_failsafe_disarm(&fs);
+    CHECK(!rc_failsafe_expire(&fs, fake_now_us + 10000000));
+    CHECK_EQ(fs.trips, 2);
+
+    // 期限正好是 0 时也算武装 (0 保留给 "未武装")
+    rc_failsafe_arm(&fs, 0, 0);
+    CHECK(fs.deadline_us != 0);
+    CHECK(rc_failsafe_expire(&fs, 1));
+
+    // 用 50 Hz 的假时钟驱动 rc_link: 稳定链路用下限，断流后恰好在下限处停车
+    rc_link_stats_t link;
+    rc_link_reset(&link);
+    rc_failsafe_t fs2 = {0};
+    fake_now_us = 0;
+    for (uint16_t seq = 0; seq < 100; seq++)
+    {
+        fake_now_us += 20000;
+        rc_link_accept(&link, seq, (uint32_t)fake_now_us);
+        uint32_t ms = rc_link_failsafe_ms(&link, FAILSAFE_MIN_MS, FAILSAFE_MAX_MS);
+        CHECK(ms >= FAILSAFE_MIN_MS && ms <= FAILSAFE_MAX_MS);
+        rc_failsafe_arm(&fs2, fake_now_us, ms * 1000);
+        CHECK(!rc_failsafe_expire(&fs2, fake_now_us + 20000));
+    }
+    uint64_t last = fake_now_us;
+    for (fake_now_us = last; !rc_failsafe_expire(&fs2, fake_now_us); fake_now_us += 1000)
+        ;
+    CHECK_EQ(fake_now_us - last, FAILSAFE_MIN_MS * 1000);
+    return TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+// rc_json: UDP JSON 指令解析
+#include <string.h>
+#include "test_util.h"
+#include "rc_json.h"
+
+static bool parse(const char *s, rc_json_msg_t *m)
+{
+    return rc_json_parse(s, strlen(s), m);
+}
+
+static void test_ctrl(void)
+{
+    rc_json_msg_t m;
+    CHECK(parse("{\"cmd\":\"ctrl\",\"seq\":42,\"x1\":0.5,\"y1\":-1,\"x2\":0,\"y2\":0.25,"
+                "\"sc_h1\":12.34,\"sc_v1\":-5,\"btn_g1\":[0,1,0,1]}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_CTRL);
+    CHECK(m.present & RC_JSON_HAS_SEQ);
+    CHECK_EQ(m.seq, 42);
+    CHECK_EQ(m.btn_g1_count, 4);
+
+    UiDataStruct d;
+    rc_json_to_ctrl(&m, &d);
+    CHECK_EQ(d.x1, 16384);
+    CHECK_EQ(d.y1, -32767);
+    CHECK_EQ(d.y2, 8192);
+    CHECK_EQ(d.sc_h1, 1234);
+    CHECK_EQ(d.sc_v1, -500);
+    CHECK_EQ(d.btn_g1, 0x000A);
+}
+
+static void test_commands(void)
+{
+    rc_json_msg_t m;
+    CHECK(parse("{\"cmd\":\"connect\",\"device\":\"pixel\"}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_CONNECT);
+    CHECK(m.present & RC_JSON_HAS_DEVICE);
+    CHECK_EQ(m.device_len, 5);
+
+    CHECK(parse("{\"cmd\":\"disconnect\"}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_DISCONNECT);
+
+    CHECK(parse("{\"cmd\":\"takeover\",\"auth\":\"abcd\",\"prio\":2}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_TAKEOVER);
+    CHECK(m.present & RC_JSON_HAS_AUTH);
+    CHECK(m.present & RC_JSON_HAS_PRIO);
+    CHECK_EQ(m.prio, 2);
+
+    CHECK(parse("{\"cmd\":\"connect\",\"role\":\"spectator\"}", &m));
+    CHECK(m.present & RC_JSON_SPECTATE);
+
+    CHECK(parse("{\"cmd\":\"fly\"}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_UNKNOWN);
+    CHECK(parse("{\"cmd\":7}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_NONE);
+    CHECK(parse("{}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_NONE);
+}
+
+static void test_unknown_keys_skipped(void)
+{
+    rc_json_msg_t m;
+    CHECK(parse("{\"extra\":{\"a\":[1,2,{\"b\":null}],\"c\":\"x\\\"y\"},\"cmd\":\"ctrl\",\"x1\":1,\"y1\":1}", &m));
+    CHECK_EQ(m.cmd, RC_CMD_CTRL);
+    CHECK(m.present & RC_JSON_HAS_X1);
+}
+
+static void test_out_of_range(void)
+{
+    rc_json_msg_t m;
+    CHECK(parse("{\"cmd\":\"ctrl\",\"seq\":-1,\"prio\":300}", &m));
+    CHECK(!(m.present & RC_JSON_HAS_SEQ));
+    CHECK(!(m.present & RC_JSON_HAS_PRIO));
+
+    // 超出范围的值限幅
+    UiDataStruct d;
+    CHECK(parse("{\"cmd\":\"ctrl\",\"x1\":5,\"y1\":-5,\"sc_h1\":1000}", &m));
+    rc_json_to_ctrl(&m, &d);
+    CHECK_EQ(d.x1, 32767);
+    CHECK_EQ(d.y1, -32767);
+    CHECK_EQ(d.sc_h1, 32767);
+
+    // 按钮值很大 / 为负也只当作按下，不能溢出成负数
+    CHECK(parse("{\"cmd\":\"ctrl\",\"btn_g1\":[1e18,3e9,-4e9,0,0.0]}", &m));
+    CHECK_EQ(m.btn_g1_count, 5);
+    CHECK_EQ(m.btn_g1[0], 1);
+    CHECK_EQ(m.btn_g1[1], 1);
+    CHECK_EQ(m.btn_g1[2], 1);
+    CHECK_EQ(m.btn_g1[3], 0);
+    CHECK_EQ(m.btn_g1[4], 0);
+    rc_json_to_ctrl(&m, &d);
+    CHECK_EQ(d.btn_g1, 0x0007);
+}
+
+static void test_rejects(void)
+{
+    static const char *bad[] = {
+        "",
+        "{",
+        "}",
+        "[]",
+        "{\"cmd\":\"ctrl\"",
+        "{\"cmd\":\"ctrl\",}",
+        "{\"cmd\" \"ctrl\"}",
+        "{\"cmd\":\"ctr",
+        "{\"x1\":1.}",
+        "{\"x1\":-}",
+        "{\"x1\":1e}",
+        "{\"x1\":tru}",
+        "{\"a\":[1,2}",
+        "{\"a\":\"\\q\"}",
+        "{} x",
+        "{\"cmd\":\"ctrl\"}}",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        rc_json_msg_t m;
+        if (parse(bad[i], &m))
+        {
+            fprintf(stderr, "accepted: %s\n", bad[i]);
+            test_failures++;
+        }
+    }
+}
+
+static void test_trailing_nul_and_truncation(void)
+{
+    // rx_buffer 末尾补的 '\0' 允许
+    const char ok[] = "{\"cmd\":\"ctrl\"}\0\0";
+    rc_json_msg_t m;
+    CHECK(rc_json_parse(ok, sizeof(ok) - 1, &m));
+
+    // 任何前缀截断都必须被拒绝，且不能越界读
+    const char *full = "{\"cmd\":\"ctrl\",\"seq\":7,\"x1\":0.1,\"y1\":0.2,\"btn_g1\":[1,0,1]}";
+    for (size_t n = 0; n < strlen(full); n++)
+        CHECK(!rc_json_parse(full, n, &m));
+}
+
+static void test_copy_string(void)
+{
+    char out[16];
+    rc_json_copy_string(out, sizeof(out), "a\\\"b\\n\\u00e9c", 13);
+    CHECK(strcmp(out, "a\"b\n?c") == 0);
+    rc_json_copy_string(out, 4, "abcdef", 6);
+    CHECK(strcmp(out, "abc") == 0);
+}
+
+int main(void)
+{
+    test_ctrl();
+    test_commands();
+    test_unknown_keys_skipped();
+    test_out_of_range();
+    test_rejects();
+    test_trailing_nul_and_truncation();
+    test_copy_string();
+    return TEST_RESULT();
+}
@@ -0,0 +1,68 @@
+// rc_link: 序号检查、丢包 / 乱序统计和自适应超时
+#include "test_util.h"
+#include "rc_link.h"
+
+static void test_sequence(void)
+{
+    rc_link_stats_t s;
+    rc_link_reset(&s);
+    uint32_t t = 0;
+
+    CHECK(rc_link_accept(&s, 100, t += 20000));
+    CHECK(rc_link_accept(&s, 101, t += 20000));
+    CHECK(!rc_link_accept(&s, 101, t += 1000));   // 重复
+    CHECK_EQ(s.duplicates, 1);
+    CHECK(rc_link_accept(&s, 104, t += 20000));   // 丢了 102 103
+    CHECK_EQ(s.lost, 2);
+    CHECK(!rc_link_accept(&s, 103, t += 1000));   // 迟到
+    CHECK_EQ(s.reordered, 1);
+
+    // 16 位回绕
+    rc_link_reset(&s);
+    CHECK(rc_link_accept(&s, 65535, 0));
+    CHECK(rc_link_accept(&s, 0, 20000));
+    CHECK_EQ(s.lost, 0);
+
+    // 大跳变 (App 重启) 重新同步，不计丢包
+    CHECK(rc_link_accept(&s, 5000, 40000));
+    CHECK_EQ(s.resyncs, 1);
+    CHECK_EQ(s.lost, 0);
+    CHECK(rc_link_accept(&s, 3, 60000));
+    CHECK_EQ(s.resyncs, 2);
+}
+
+static void test_failsafe_bounds(void)
+{
+    rc_link_stats_t s;
+    rc_link_reset(&s);
+
+    // 统计不足时用下限
+    CHECK_EQ(rc_link_failsafe_ms(&s, 500, 1000), 500);
+    CHECK_EQ(rc_link_session_timeout_ms(&s, 3000), 3000);
+
+    // 50 Hz 稳定链路: 推算值很小，但不能低于下限
+    uint32_t t = 0;
+    for (uint16_t seq = 0; seq < 50; seq++)
+        rc_link_accept(&s, seq, t += 20000);
+    CHECK_EQ(s.mean_gap_us, 20000);
+    CHECK_EQ(rc_link_failsafe_ms(&s, 500, 1000), 500);
+    CHECK_EQ(rc_link_failsafe_ms(&s, 0, 1000), 60);
+    CHECK_EQ(rc_link_session_timeout_ms(&s, 3000), RC_LINK_SESSION_MIN_MS);
+
+    // 5 Hz 抖动的链路: 放宽，但不超过上限
+    rc_link_reset(&s);
+    t = 0;
+    for (uint16_t seq = 0; seq < 50; seq++)
+        rc_link_accept(&s, (uint16_t)(seq * 2), t += (seq & 1) ? 150000 : 250000);
+    uint32_t ms = rc_link_failsafe_ms(&s, 500, 1000);
+    CHECK(ms > 500 && ms <= 1000);
+    CHECK_EQ(rc_link_failsafe_ms(&s, 500, 700), 700);
+    CHECK_EQ(rc_link_session_timeout_ms(&s, 3000), 3000);
+}
+
+int main(void)
+{
+    test_sequence();
+    test_failsafe_bounds();
+    return TEST_RESULT();
+}
@@ -0,0 +1,59 @@
+// rc_packet: 二进制控制帧编解码和 CRC
+#include <string.h>
+#include "test_util.h"
+#include "rc_packet.h"
+
+static UiDataStruct sample(void)
+{
+    UiDataStruct d;
+    memset(&d, 0, sizeof(d));
+    d.x1 = 12345;
+    d.y1 = -32767;
+    d.x2 = 1;
+    d.y2 = -1;
+    d.sc_h1 = 32767;
+    d.sc_v1 = -250;
+    d.btn_g1 = 0x0155;
+    d.btn_g2 = 0x02AA;
+    return d;
+}
+
+int main(void)
+{
+    // CRC-16/CCITT-FALSE 的标准校验值
+    CHECK_EQ(rc_crc16_ccitt((const uint8_t *)"123456789", 9), 0x29B1);
+
+    UiDataStruct in = sample(), out;
+    uint8_t buf[RC_PKT_SIZE];
+    CHECK_EQ(rc_packet_encode(&in, 0xBEEF, buf, sizeof(buf)), RC_PKT_SIZE);
+    CHECK_EQ(rc_packet_encode(&in, 0, buf, sizeof(buf) - 1), 0);
+    CHECK(rc_packet_is_binary(buf, sizeof(buf)));
+    CHECK(!rc_packet_is_binary((const uint8_t *)"{\"", 2));
+
+    uint16_t seq = 0;
+    CHECK_EQ(rc_packet_decode(buf, sizeof(buf), &out, &seq), RC_PKT_OK);
+    CHECK_EQ(seq, 0xBEEF);
+    CHECK(memcmp(&in, &out, offsetof(UiDataStruct, rx_us)) == 0);
+
+    CHECK_EQ(rc_packet_decode(buf, sizeof(buf) - 1, &out, NULL), RC_PKT_ERR_LEN);
+
+    uint8_t bad[RC_PKT_SIZE];
+    memcpy(bad, buf, sizeof(bad));
+    bad[0] = '{';
+    CHECK_EQ(rc_packet_decode(bad, sizeof(bad), &out, NULL), RC_PKT_ERR_MAGIC);
+    memcpy(bad, buf, sizeof(bad));
+    bad[2] = RC_PKT_VERSION + 1;
+    CHECK_EQ(rc_packet_decode(bad, sizeof(bad), &out, NULL), RC_PKT_ERR_VERSION);
+
+    // 任何一位翻转都要被 CRC 发现
+    for (size_t i = 4; i < RC_PKT_SIZE; i++)
+    {
+        for (int b = 0; b < 8; b++)
+        {
+            memcpy(bad, buf, sizeof(bad));
+            bad[i] ^= (uint8_t)(1u << b);
+            CHECK_EQ(rc_packet_decode(bad, sizeof(bad), &out, NULL), RC_PKT_ERR_CRC);
+        }
+    }
+    return TEST_RESULT();
+}
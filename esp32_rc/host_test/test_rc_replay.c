@@ -0,0 +1,152 @@
+// rc_replay: 录制回放的过滤规则 (会话、序号) 和流水线输出
+//
+// 带 -o 文件名 时把这里构造的录制写成和 GET /api/rec/data 一样的文件，给 rc_replay_host 的 ctest 用。
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "rc_replay.h"
+#include "rc_packet.h"
+
+typedef struct {
+    uint8_t buf[16384];
+    size_t len;
+    uint32_t records;
+} rec_file_t;
+
+static void add(rec_file_t *f, uint32_t t_us, bool client, const void *payload, size_t len)
+{
+    rc_rec_entry_t e = {.t_us = t_us, .len = (uint16_t)len, .flags = client ? RC_REC_FLAG_CLIENT : 0};
+    size_t total = RC_REC_ALIGN4(sizeof(e) + len);
+    if (f->len + total > sizeof(f->buf))
+        return;
+    memset(f->buf + f->len, 0, total);
+    memcpy(f->buf + f->len, &e, sizeof(e));
+    memcpy(f->buf + f->len + sizeof(e), payload, len);
+    f->len += total;
+    f->records++;
+}
+
+static void add_bin(rec_file_t *f, uint32_t t_us, bool client, uint16_t seq, int16_t x1)
+{
+    UiDataStruct d;
+    memset(&d, 0, sizeof(d));
+    d.x1 = x1;
+    uint8_t pkt[RC_PKT_SIZE];
+    rc_packet_encode(&d, seq, pkt, sizeof(pkt));
+    add(f, t_us, client, pkt, sizeof(pkt));
+}
+
+static void add_text(rec_file_t *f, uint32_t t_us, bool client, const char *s)
+{
+    add(f, t_us, client, s, strlen(s));
+}
+
+// 2 秒 50 Hz 的会话，中间夹着各种应当被过滤掉的包
+static void build(rec_file_t *f)
+{
+    memset(f, 0, sizeof(*f));
+    f->len = RC_REC_HEADER_SIZE;
+    add_text(f, 0, true, "{\"cmd\":\"connect\",\"device\":\"test\"}");
+    for (uint16_t seq = 0; seq < 100; seq++)
+    {
+        uint32_t t = 20000u * (seq + 1);
+        add_bin(f, t, true, seq, (int16_t)(seq * 100));
+        if (seq == 10)
+            add_bin(f, t + 100, true, seq, 0);          // 重复
+        if (seq == 20)
+            add_bin(f, t + 200, true, seq - 5, 0);      // 迟到
+        if (seq % 10 == 5)
+            add_bin(f, t + 300, false, seq + 1000, 0);  // 旁观者的二进制帧
+    }
+    add_text(f, 2010000, false, "{\"cmd\":\"ctrl\",\"seq\":5000,\"x1\":1,\"y1\":0}"); // 旁观者的 JSON
+    add_text(f, 2020000, true, "{\"cmd\":\"ctrl\",\"seq\":100,\"x1\":0.5,\"y1\":0}");  // 控制者的 JSON
+    add_text(f, 2030000, true, "{\"cmd\":\"ctrl\",\"x1\":-0.5,\"y1\":0}");           // 不带序号
+    add_text(f, 2040000, true, "not json");
+
+    rc_rec_header_t h = {
+        .magic = RC_REC_MAGIC,
+        .version = RC_REC_VERSION,
+        .header_size = RC_REC_HEADER_SIZE,
+        .records = f->records,
+        .data_bytes = (uint32_t)(f->len - RC_REC_HEADER_SIZE),
+        .duration_us = 2040000,
+    };
+    memcpy(f->buf, &h, sizeof(h));
+}
+
+static uint32_t s_fake_ticks;
+static uint32_t fake_clock(void)
+{
+    return s_fake_ticks += 3;
+}
+
+static void test_filters(const rec_file_t *f, bool binary)
+{
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+        rc_shape_default(&params[i]);
+    rc_replay_t r;
+    rc_replay_init(&r, params, binary, fake_clock);
+
+    int frames = 0;
+    int16_t last_x1 = 0;
+    for (size_t off = RC_REC_HEADER_SIZE; off + sizeof(rc_rec_entry_t) <= f->len;)
+    {
+        rc_rec_entry_t e;
+        memcpy(&e, f->buf + off, sizeof(e));
+        if (rc_replay_packet(&r, &e, f->buf + off + sizeof(e)))
+        {
+            frames++;
+            last_x1 = r.data.x1;
+            CHECK(r.frame_len > 0);
+            if (binary)
+            {
+                UiDataStruct d;
+                CHECK(uart_frame_decode_binary(r.frame, r.frame_len - 1, &d, NULL));
+                CHECK_EQ(d.x1, r.data.x1);
+            }
+            else
+            {
+                CHECK(memcmp(r.frame, "BEGIN,", 6) == 0);
+            }
+        }
+        off += RC_REC_ALIGN4(sizeof(e) + e.len);
+    }
+
+    const rc_replay_stats_t *s = &r.stats;
+    CHECK_EQ(s->packets, f->records);
+    CHECK_EQ(s->ctrl, 102);         // 100 个二进制 + 2 个 JSON
+    CHECK_EQ(frames, 102);
+    CHECK_EQ(s->stale, 2);          // 重复 + 迟到
+    CHECK_EQ(s->not_client, 11);    // 10 个旁观者二进制帧 + 1 个 JSON
+    CHECK_EQ(s->parse_ok, f->records - 10 - 1); // 旁观者二进制帧不解码，"not json" 解析失败
+    CHECK_EQ(r.link.duplicates, 1);
+    CHECK_EQ(r.link.reordered, 1);
+    CHECK_EQ(last_x1, -UI_AXIS_SCALE / 2 - 1); // 四舍五入远离 0
+    CHECK(s->parse_ticks > 0 && s->shape_ticks > 0 && s->encode_ticks > 0);
+}
+
+int main(int argc, char **argv)
+{
+    static rec_file_t f;
+    build(&f);
+    test_filters(&f, true);
+    test_filters(&f, false);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:")) != -1)
+    {
+        if (opt == 'o')
+        {
+            FILE *fp = fopen(optarg, "wb");
+            CHECK(fp != NULL);
+            if (fp)
+            {
+                CHECK_EQ(fwrite(f.buf, 1, f.len, fp), f.len);
+                fclose(fp);
+            }
+        }
+    }
+    return TEST_RESULT();
+}
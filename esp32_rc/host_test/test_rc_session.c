@@ -0,0 +1,166 @@
+// rc_session: 控制者 / 旁观者、接管和优先级、超时
+#include <string.h>
+#include "test_util.h"
+#include "rc_session.h"
+
+#define TIMEOUT_MS 3000
+
+static rc_peer_t peer(int i)
+{
+    rc_peer_t p = {.addr = 0x0A000000u + (uint32_t)i, .port = (uint16_t)(40000 + i)};
+    return p;
+}
+
+static const uint8_t nonce[RC_SESSION_NONCE_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+static rc_takeover_result_t takeover(rc_session_t *s, const rc_peer_t *p, bool auth, uint8_t prio, uint32_t now,
+                                     int *old)
+{
+    CHECK(rc_session_challenge(s, p, nonce, now));
+    CHECK(rc_session_pending_nonce(s, p, now) != NULL);
+    return rc_session_takeover(s, p, auth, prio, now, old);
+}
+
+static void test_connect(void)
+{
+    rc_session_t s;
+    rc_session_init(&s);
+    rc_peer_t a = peer(1), b = peer(2);
+    int slot;
+
+    CHECK_EQ(rc_session_connect(&s, &a, false, 0, &slot), RC_SESSION_OPENED);
+    CHECK(rc_session_is_client(&s, &a));
+    CHECK_EQ(rc_session_connect(&s, &a, false, 10, &slot), RC_SESSION_REFRESHED);
+    CHECK_EQ(rc_session_connect(&s, &b, false, 10, &slot), RC_SESSION_SPECTATING);
+    CHECK(!rc_session_is_client(&s, &b));
+
+    // 表满了回 busy
+    for (int i = 3; i <= RC_SESSION_MAX_PEERS; i++)
+    {
+        rc_peer_t p = peer(i);
+        CHECK_EQ(rc_session_connect(&s, &p, false, 10, &slot), RC_SESSION_SPECTATING);
+    }
+    rc_peer_t extra = peer(99);
+    CHECK_EQ(rc_session_connect(&s, &extra, false, 10, &slot), RC_SESSION_BUSY);
+    CHECK_EQ(slot, -1);
+
+    // 控制者断开后旁观者保留，下一个 connect 的成为控制者
+    CHECK(rc_session_disconnect(&s, &a));
+    CHECK_EQ(s.owner, -1);
+    CHECK(rc_session_find(&s, &b) >= 0);
+    CHECK_EQ(rc_session_connect(&s, &b, false, 20, &slot), RC_SESSION_OPENED);
+
+    // 只想旁观的不接管
+    rc_session_init(&s);
+    CHECK_EQ(rc_session_connect(&s, &a, true, 0, &slot), RC_SESSION_SPECTATING);
+    CHECK_EQ(s.owner, -1);
+}
+
+static void test_hash_remove(void)
+{
+    // 反复加入 / 删除，开放寻址的删除不能弄丢还在表里的人
+    rc_session_t s;
+    rc_session_init(&s);
+    uint32_t rng = 12345;
+    rc_peer_t in_table[RC_SESSION_MAX_PEERS];
+    int n = 0;
+    for (int round = 0; round < 2000; round++)
+    {
+        int slot;
+        if (n < RC_SESSION_MAX_PEERS && (test_rand(&rng) & 1))
+        {
+            rc_peer_t p = peer((int)(test_rand(&rng) % 1000) + 100);
+            if (rc_session_find(&s, &p) >= 0)
+                continue;
+            CHECK(rc_session_connect(&s, &p, true, 0, &slot) == RC_SESSION_SPECTATING);
+            in_table[n++] = p;
+        }
+        else if (n > 0)
+        {
+            int k = (int)(test_rand(&rng) % (uint32_t)n);
+            rc_session_disconnect(&s, &in_table[k]);
+            in_table[k] = in_table[--n];
+        }
+        for (int i = 0; i < n; i++)
+            CHECK(rc_session_find(&s, &in_table[i]) >= 0);
+    }
+}
+
+static void test_takeover(void)
+{
+    rc_session_t s;
+    rc_session_init(&s);
+    rc_peer_t a = peer(1), b = peer(2), c = peer(3);
+    int slot, old;
+    rc_session_connect(&s, &a, false, 0, &slot);
+    int a_slot = slot;
+
+    // 认证失败，随机数作废
+    CHECK_EQ(takeover(&s, &b, false, 0, 100, &old), RC_TAKEOVER_DENIED);
+    CHECK(rc_session_pending_nonce(&s, &b, 100) == NULL);
+    CHECK_EQ(rc_session_takeover(&s, &b, true, 0, 100, &old), RC_TAKEOVER_DENIED);
+
+    // 过期的随机数
+    CHECK(rc_session_challenge(&s, &b, nonce, 100));
+    CHECK(rc_session_pending_nonce(&s, &b, 100 + RC_SESSION_CHALLENGE_MS + 1) == NULL);
+    CHECK_EQ(rc_session_takeover(&s, &b, true, 0, 100 + RC_SESSION_CHALLENGE_MS + 1, &old), RC_TAKEOVER_DENIED);
+
+    // 以优先级 2 接管，原控制者降为旁观者
+    CHECK_EQ(takeover(&s, &b, true, 2, 200, &old), RC_TAKEOVER_OK);
+    CHECK_EQ(old, a_slot);
+    CHECK(rc_session_is_client(&s, &b));
+    CHECK_EQ(s.slots[a_slot].role, RC_ROLE_SPECTATOR);
+    CHECK_EQ(s.slots[a_slot].prio, 0);
+
+    // 优先级低的接管不了，同级可以
+    CHECK_EQ(takeover(&s, &c, true, 1, 300, &old), RC_TAKEOVER_OUTRANKED);
+    CHECK(rc_session_is_client(&s, &b));
+    CHECK_EQ(takeover(&s, &c, true, 2, 400, &old), RC_TAKEOVER_OK);
+    CHECK(rc_session_is_client(&s, &c));
+
+    // 优先级按上限截断，控制者自己可以改优先级
+    CHECK_EQ(takeover(&s, &c, true, 200, 500, &old), RC_TAKEOVER_OK);
+    CHECK_EQ(old, -1);
+    CHECK_EQ(s.slots[s.owner].prio, RC_SESSION_PRIO_MAX);
+}
+
+static void test_expire(void)
+{
+    rc_session_t s;
+    rc_session_init(&s);
+    rc_peer_t a = peer(1), b = peer(2);
+    int slot;
+    uint32_t due;
+
+    CHECK(!rc_session_deadline(&s, TIMEOUT_MS, &due));
+    rc_session_connect(&s, &a, false, 1000, &slot);
+    rc_session_connect(&s, &b, false, 1500, &slot);
+    CHECK(rc_session_deadline(&s, TIMEOUT_MS, &due));
+    CHECK_EQ(due, 1000 + TIMEOUT_MS + 1);
+
+    // 旁观者保活
+    rc_session_touch_peer(&s, &b, 3000);
+    CHECK(!rc_session_expire(&s, 1000 + TIMEOUT_MS, TIMEOUT_MS));
+    CHECK(rc_session_expire(&s, 1000 + TIMEOUT_MS + 1, TIMEOUT_MS));
+    CHECK_EQ(s.owner, -1);
+    CHECK(rc_session_find(&s, &b) >= 0);
+    CHECK(!rc_session_expire(&s, 3000 + TIMEOUT_MS, TIMEOUT_MS));
+    rc_session_expire(&s, 3000 + TIMEOUT_MS + 1, TIMEOUT_MS);
+    CHECK(rc_session_find(&s, &b) < 0);
+    CHECK(!rc_session_deadline(&s, TIMEOUT_MS, &due));
+
+    // 32 位毫秒回绕
+    rc_session_init(&s);
+    rc_session_connect(&s, &a, false, 0xFFFFFF00u, &slot);
+    CHECK(!rc_session_expire(&s, 0x100, TIMEOUT_MS));
+    CHECK(rc_session_expire(&s, 0xFFFFFF00u + TIMEOUT_MS + 1, TIMEOUT_MS));
+}
+
+int main(void)
+{
+    test_connect();
+    test_hash_remove();
+    test_takeover();
+    test_expire();
+    return TEST_RESULT();
+}
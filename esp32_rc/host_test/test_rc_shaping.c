@@ -0,0 +1,66 @@
+// rc_shaping: 死区 / expo / 低通 / 变化率限制
+#include <string.h>
+#include "test_util.h"
+#include "rc_shaping.h"
+
+static int16_t shape1(const rc_shape_axis_t *p, int16_t in)
+{
+    rc_shape_state_t st;
+    memset(&st, 0, sizeof(st));
+    return rc_shape_axis(p, &st, in, 0);
+}
+
+int main(void)
+{
+    rc_shape_axis_t p;
+    rc_shape_default(&p);
+
+    // 默认参数是恒等变换
+    for (int32_t v = -RC_SHAPE_ONE; v <= RC_SHAPE_ONE; v += 7)
+        CHECK_EQ(shape1(&p, (int16_t)v), v);
+    CHECK_EQ(shape1(&p, -32768), -RC_SHAPE_ONE);
+
+    // 死区内为 0，死区外拉伸到满量程，保持对称
+    p.deadband = RC_SHAPE_ONE / 10;
+    CHECK_EQ(shape1(&p, RC_SHAPE_ONE / 10), 0);
+    CHECK_EQ(shape1(&p, -RC_SHAPE_ONE / 20), 0);
+    CHECK_EQ(shape1(&p, RC_SHAPE_ONE), RC_SHAPE_ONE);
+    CHECK_EQ(shape1(&p, -RC_SHAPE_ONE), -RC_SHAPE_ONE);
+    CHECK_EQ(shape1(&p, 20000), -shape1(&p, -20000));
+
+    // expo: 满舵不变，中间变小，单调
+    rc_shape_default(&p);
+    p.expo = RC_SHAPE_ONE / 2;
+    CHECK_EQ(shape1(&p, RC_SHAPE_ONE), RC_SHAPE_ONE);
+    CHECK(shape1(&p, RC_SHAPE_ONE / 2) < RC_SHAPE_ONE / 2);
+    int16_t prev = 0;
+    for (int32_t v = 0; v <= RC_SHAPE_ONE; v += 13)
+    {
+        int16_t o = shape1(&p, (int16_t)v);
+        CHECK(o >= prev);
+        prev = o;
+    }
+
+    // 低通: 逐步逼近，最终精确到达并能精确回到 0
+    rc_shape_default(&p);
+    p.lowpass = 64;
+    rc_shape_state_t st;
+    memset(&st, 0, sizeof(st));
+    int16_t o = rc_shape_axis(&p, &st, RC_SHAPE_ONE, 20000);
+    CHECK(o > 0 && o < RC_SHAPE_ONE);
+    for (int i = 0; i < 200; i++)
+        o = rc_shape_axis(&p, &st, RC_SHAPE_ONE, 20000);
+    CHECK_EQ(o, RC_SHAPE_ONE);
+    for (int i = 0; i < 200; i++)
+        o = rc_shape_axis(&p, &st, 0, 20000);
+    CHECK_EQ(o, 0);
+
+    // 变化率: 每毫秒最多 100，dt 超过上限按上限算，dt=0 不允许变化
+    rc_shape_default(&p);
+    p.slew = 100;
+    memset(&st, 0, sizeof(st));
+    CHECK_EQ(rc_shape_axis(&p, &st, RC_SHAPE_ONE, 0), 0);
+    CHECK_EQ(rc_shape_axis(&p, &st, RC_SHAPE_ONE, 20000), 2000);
+    CHECK_EQ(rc_shape_axis(&p, &st, -RC_SHAPE_ONE, 1000000), 2000 - 100 * (RC_SHAPE_MAX_DT_US / 1000));
+    return TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+// uart_frame: COBS、UART 文本帧 / 二进制帧编码和接收方向的流式解析
+#include <stdlib.h>
+#include <string.h>
+#include "test_util.h"
+#include "uart_frame.h"
+#include "rc_packet.h"
+
+static UiDataStruct sample(void)
+{
+    UiDataStruct d;
+    memset(&d, 0, sizeof(d));
+    d.x1 = UI_AXIS_SCALE / 2;
+    d.y1 = -UI_AXIS_SCALE;
+    d.sc_h1 = 150;
+    d.sc_v1 = -3;
+    d.btn_g1 = 0x0201;
+    d.btn_g2 = 0x0100;
+    return d;
+}
+
+// 编码后不能有 0x00，长度不超过 UART_COBS_MAX_LEN - 1，并且能原样解回来
+static void cobs_roundtrip(const uint8_t *in, size_t len)
+{
+    static uint8_t enc[UART_COBS_MAX_LEN(1024)];
+    static uint8_t dec[1024];
+    size_t n = uart_cobs_encode(in, len, enc, UART_COBS_MAX_LEN(len) - 1);
+    CHECK(n >= 1 && n <= UART_COBS_MAX_LEN(len) - 1);
+    for (size_t i = 0; i < n; i++)
+        CHECK(enc[i] != 0);
+    CHECK_EQ(uart_cobs_decode(enc, n, dec, len), len);
+    CHECK(memcmp(in, dec, len) == 0);
+}
+
+static void test_cobs(void)
+{
+    uint8_t in[1024] = {0}, enc[16];
+
+    // 空输入编码成一个 0x01
+    CHECK_EQ(uart_cobs_encode(in, 0, enc, sizeof(enc)), 1);
+    CHECK_EQ(enc[0], 0x01);
+    cobs_roundtrip(in, 0);
+
+    // 全 0: 每个 0 变成一个 0x01
+    CHECK_EQ(uart_cobs_encode(in, 4, enc, sizeof(enc)), 5);
+    for (int i = 0; i < 5; i++)
+        CHECK_EQ(enc[i], 0x01);
+    cobs_roundtrip(in, 300);
+
+    // 253 / 254 / 255 个非零字节: 正好卡在 0xFF 分组的边界上
+    memset(in, 0xAB, sizeof(in));
+    uint8_t big[UART_COBS_MAX_LEN(1024)];
+    CHECK_EQ(uart_cobs_encode(in, 253, big, sizeof(big)), 254);
+    CHECK_EQ(big[0], 254);
+    CHECK_EQ(uart_cobs_encode(in, 254, big, sizeof(big)), 256);
+    CHECK_EQ(big[0], 0xFF);
+    CHECK_EQ(big[255], 0x01);
+    CHECK_EQ(uart_cobs_encode(in, 255, big, sizeof(big)), 257);
+    CHECK_EQ(big[255], 0x02);
+    for (size_t len = 250; len <= 512; len++)
+        cobs_roundtrip(in, len);
+
+    // 输出缓冲区按最坏情况检查，少一个字节就拒绝
+    CHECK_EQ(uart_cobs_encode(in, 254, big, UART_COBS_MAX_LEN(254) - 2), 0);
+
+    // 随机数据 (偏向多 0) 往返
+    uint32_t rng = 0xA5A5A5u;
+    for (int iter = 0; iter < 2000; iter++)
+    {
+        size_t len = test_rand(&rng) % sizeof(in);
+        uint32_t zero_odds = 1 + test_rand(&rng) % 16;
+        for (size_t i = 0; i < len; i++)
+            in[i] = test_rand(&rng) % zero_odds == 0 ? 0 : (uint8_t)(1 + test_rand(&rng) % 255);
+        cobs_roundtrip(in, len);
+    }
+
+    // 格式错误: 数据里有 0、分组长度越过结尾、输出放不下
+    uint8_t out[8];
+    CHECK_EQ(uart_cobs_decode((const uint8_t[]){0x03, 0x11, 0x00, 0x22}, 4, out, sizeof(out)), 0);
+    CHECK_EQ(uart_cobs_decode((const uint8_t[]){0x00}, 1, out, sizeof(out)), 0);
+    CHECK_EQ(uart_cobs_decode((const uint8_t[]){0x05, 0x11, 0x22}, 3, out, sizeof(out)), 0);
+    CHECK_EQ(uart_cobs_decode((const uint8_t[]){0x03, 0x11, 0x22, 0x02, 0x33}, 5, out, 3), 0);
+    CHECK_EQ(uart_cobs_decode((const uint8_t[]){0x03, 0x11, 0x22, 0x02, 0x33}, 5, out, 4), 4);
+
+    // 随机垃圾解码不能越界 (配合 RC_HOST_SANITIZE)
+    for (int iter = 0; iter < 2000; iter++)
+    {
+        size_t len = 1 + test_rand(&rng) % 32;
+        uint8_t *junk = malloc(len);
+        for (size_t i = 0; i < len; i++)
+            junk[i] = (uint8_t)test_rand(&rng);
+        CHECK(uart_cobs_decode(junk, len, out, sizeof(out)) <= sizeof(out));
+        free(junk);
+    }
+}
+
+static void test_text(void)
+{
+    UiDataStruct d = sample();
+    char buf[UART_FRAME_MAX_LEN];
+    size_t n = uart_frame_encode_text(&d, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(strcmp(buf, "BEGIN,0.49998,-1.00000,0.00000,0.00000,1.50,-0.03,1,0,0,0,0,0,0,0,0,1,END") == 0);
+    CHECK_EQ(uart_frame_encode_text(&d, buf, 10), 0);
+}
+
+static void test_binary_roundtrip(void)
+{
+    UiDataStruct d = sample(), out;
+    uint8_t buf[UART_FRAME_MAX_LEN];
+    size_t n = uart_frame_encode_binary(&d, 0x5A, buf, sizeof(buf));
+    CHECK_EQ(n, UART_COBS_MAX_LEN(UART_CTRL_RAW_LEN));
+    CHECK_EQ(buf[n - 1], UART_FRAME_DELIM);
+    for (size_t i = 0; i + 1 < n; i++)
+        CHECK(buf[i] != 0);
+
+    uint8_t seq = 0;
+    CHECK(uart_frame_decode_binary(buf, n - 1, &out, &seq));
+    CHECK_EQ(seq, 0x5A);
+    CHECK(memcmp(&d, &out, offsetof(UiDataStruct, rx_us)) == 0);
+
+    buf[5] ^= 0x01;
+    CHECK(!uart_frame_decode_binary(buf, n - 1, &out, &seq));
+}
+
+typedef struct {
+    int frames;
+    uint8_t last_type;
+    size_t last_len;
+} sink_t;
+
+static void on_frame(uint8_t type, const uint8_t *payload, size_t len, void *ctx)
+{
+    (void)payload;
+    sink_t *s = ctx;
+    s->frames++;
+    s->last_type = type;
+    s->last_len = len;
+}
+
+static void test_parser(void)
+{
+    uart_frame_parser_t p;
+    sink_t sink = {0};
+    uart_frame_parser_init(&p, on_frame, &sink);
+
+    UiDataStruct d = sample();
+    uint8_t frame[UART_FRAME_MAX_LEN];
+    size_t n = uart_frame_encode_binary(&d, 1, frame, sizeof(frame));
+
+    // 开头是半帧垃圾，到第一个 0x00 重新同步
+    const uint8_t junk[] = {0x11, 0x22, 0x33, 0x00};
+    uart_frame_parser_feed(&p, junk, sizeof(junk));
+    // 一个字节一个字节地喂
+    for (size_t i = 0; i < n; i++)
+        uart_frame_parser_feed(&p, &frame[i], 1);
+    CHECK_EQ(sink.frames, 1);
+    CHECK_EQ(sink.last_type, UART_MSG_CTRL);
+    CHECK_EQ(sink.last_len, UART_CTRL_PAYLOAD_LEN);
+    CHECK_EQ(p.stats.framing_errors + p.stats.crc_errors, 1);
+
+    // 连续两帧一次喂入
+    uint8_t two[2 * UART_FRAME_MAX_LEN];
+    memcpy(two, frame, n);
+    memcpy(two + n, frame, n);
+    uart_frame_parser_feed(&p, two, 2 * n);
+    CHECK_EQ(sink.frames, 3);
+
+    // 超长帧被丢弃，之后照常解析
+    uint8_t longf[sizeof(p.buf) + 8];
+    memset(longf, 0x55, sizeof(longf));
+    uart_frame_parser_feed(&p, longf, sizeof(longf));
+    uart_frame_parser_feed(&p, (const uint8_t[]){0}, 1);
+    uint32_t framing = p.stats.framing_errors;
+    uart_frame_parser_feed(&p, frame, n);
+    CHECK_EQ(sink.frames, 4);
+    CHECK(framing >= 1);
+
+    // CRC 错误计数
+    frame[3] ^= 0x40;
+    if (frame[3] == 0)
+        frame[3] = 0x01;
+    uint32_t crc = p.stats.crc_errors + p.stats.framing_errors;
+    uart_frame_parser_feed(&p, frame, n);
+    CHECK_EQ(sink.frames, 4);
+    CHECK_EQ(p.stats.crc_errors + p.stats.framing_errors, crc + 1);
+}
+
+int main(void)
+{
+    test_cobs();
+    test_text();
+    test_binary_roundtrip();
+    test_parser();
+    return TEST_RESULT();
+}
@@ -0,0 +1,44 @@
+// uart_sched: UART 控制帧的变化检测、合并和保活
+#include <string.h>
+#include "test_util.h"
+#include "uart_sched.h"
+
+int main(void)
+{
+    uart_sched_t s;
+    uart_sched_init(&s, 0);
+    CHECK_EQ(s.keepalive_ms, UART_KEEPALIVE_MS);
+
+    UiDataStruct d;
+    memset(&d, 0, sizeof(d));
+
+    // 第一次总是发送
+    CHECK_EQ(uart_sched_wait_ms(&s, 0), 0);
+    CHECK_EQ(uart_sched_decide(&s, &d, 1, 0), UART_SCHED_CHANGED);
+    uart_sched_sent(&s, UART_SCHED_CHANGED, &d, 90, 0);
+
+    // 内容相同的发布被去重，时间戳不算控制值
+    d.rx_us = 1234;
+    CHECK_EQ(uart_sched_decide(&s, &d, 1, 10), UART_SCHED_NONE);
+    CHECK_EQ(s.stats.suppressed, 1);
+    CHECK_EQ(s.stats.bytes_saved, 90);
+    CHECK_EQ(uart_sched_wait_ms(&s, 10), UART_KEEPALIVE_MS - 10);
+
+    // 保活
+    CHECK_EQ(uart_sched_decide(&s, &d, 0, UART_KEEPALIVE_MS - 1), UART_SCHED_NONE);
+    CHECK_EQ(uart_sched_decide(&s, &d, 0, UART_KEEPALIVE_MS), UART_SCHED_KEEPALIVE);
+    uart_sched_sent(&s, UART_SCHED_KEEPALIVE, &d, 90, UART_KEEPALIVE_MS);
+    CHECK_EQ(s.stats.sent_keepalive, 1);
+
+    // 三次发布合并成一次
+    d.x1 = 100;
+    CHECK_EQ(uart_sched_decide(&s, &d, 3, UART_KEEPALIVE_MS + 5), UART_SCHED_CHANGED);
+    CHECK_EQ(s.stats.coalesced, 2);
+    uart_sched_sent(&s, UART_SCHED_CHANGED, &d, 90, UART_KEEPALIVE_MS + 5);
+    CHECK_EQ(s.stats.sent_changed, 2);
+
+    // 32 位时间回绕
+    uart_sched_sent(&s, UART_SCHED_CHANGED, &d, 90, 0xFFFFFFF0u);
+    CHECK_EQ(uart_sched_wait_ms(&s, 0x10), UART_KEEPALIVE_MS - 0x20);
+    return TEST_RESULT();
+}
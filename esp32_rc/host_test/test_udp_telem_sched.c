@@ -0,0 +1,68 @@
+// udp_telem_sched: UDP 遥测的周期、故障加急和发送失败后的退避
+#include "test_util.h"
+#include "udp_telem_sched.h"
+
+#define PERIOD 100
+#define URGENT 20
+
+// 模拟 UDP 任务的截止时间循环: 每次都睡到 next_due，sendto 一直失败
+static int spin_count(udp_telem_sched_t *s, bool urgent, uint32_t start, uint32_t span)
+{
+    int wakeups = 0;
+    uint32_t now = start;
+    while (now - start < span && wakeups < 100000)
+    {
+        if (udp_telem_sched_due(s, urgent, now))
+            udp_telem_sched_done(s, now); // 发送全部失败也要调用
+        uint32_t due = udp_telem_sched_next_due(s, now);
+        CHECK((int32_t)(due - now) >= 0);
+        // 到期时间等于现在就是 0 超时的 select()，每轮至少算 1 ms 防止死循环
+        now = due == now ? now + 1 : due;
+        wakeups++;
+    }
+    return wakeups;
+}
+
+int main(void)
+{
+    udp_telem_sched_t s;
+    udp_telem_sched_init(&s, PERIOD, URGENT);
+
+    // 常规周期
+    CHECK(udp_telem_sched_due(&s, false, 1000));
+    udp_telem_sched_done(&s, 1000);
+    CHECK_EQ(udp_telem_sched_next_due(&s, 1000), 1000 + PERIOD);
+    CHECK(!udp_telem_sched_due(&s, false, 1000 + PERIOD - 1));
+    CHECK(udp_telem_sched_due(&s, false, 1000 + PERIOD));
+    udp_telem_sched_done(&s, 1000 + PERIOD);
+
+    // 故障变化: 没到最小间隔先挂起，到期时间缩短到 URGENT
+    CHECK(!udp_telem_sched_due(&s, true, 1100 + URGENT - 5));
+    CHECK(s.urgent_pending);
+    CHECK_EQ(udp_telem_sched_next_due(&s, 1100 + URGENT - 5), 1100 + URGENT);
+    CHECK(udp_telem_sched_due(&s, true, 1100 + URGENT));
+
+    // 发送失败: 从现在起退避一个常规周期，挂起的故障也不按 URGENT 重试
+    udp_telem_sched_done(&s, 1100 + URGENT);
+    CHECK(!s.urgent_pending);
+    CHECK_EQ(udp_telem_sched_next_due(&s, 1100 + URGENT), 1100 + URGENT + PERIOD);
+    CHECK_EQ(udp_telem_sched_next_due(&s, 1100 + URGENT + 1), 1100 + URGENT + PERIOD);
+
+    // WiFi 断开 3 秒 (会话超时) 期间一直失败: 醒来次数按周期算，不会空转
+    udp_telem_sched_init(&s, PERIOD, URGENT);
+    int n = spin_count(&s, false, 5000, 3000);
+    CHECK(n <= 3000 / PERIOD + 2);
+    // 故障一直没发出去 (每次都算加急) 也按常规周期重试
+    n = spin_count(&s, true, 9000, 3000);
+    CHECK(n <= 3000 / PERIOD + 2);
+
+    // 时间回绕
+    udp_telem_sched_init(&s, PERIOD, URGENT);
+    CHECK(udp_telem_sched_due(&s, false, 0xFFFFFFF0u));
+    udp_telem_sched_done(&s, 0xFFFFFFF0u);
+    CHECK_EQ(udp_telem_sched_next_due(&s, 5), (uint32_t)(0xFFFFFFF0u + PERIOD));
+    CHECK(!udp_telem_sched_due(&s, false, 5));
+    CHECK(udp_telem_sched_due(&s, false, 0xFFFFFFF0u + PERIOD));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,57 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*
+ * 主机测试用的最小断言宏，不依赖任何测试框架
+ *
+ * CHECK 失败时打印位置并计数，不中断，一次运行能看到所有失败；
+ * main 最后 return TEST_RESULT() 交给 ctest 判断。
+ */
+static int test_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                           \
+    do {                                                                         \
+        long long _a = (long long)(a), _b = (long long)(b);                      \
+        if (_a != _b) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",    \
+                    __FILE__, __LINE__, #a, #b, _a, _b);                         \
+            test_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+#define TEST_RESULT()                                                            \
+    (test_failures ? (fprintf(stderr, "%d check(s) failed\n", test_failures), 1) \
+                   : (printf("ok\n"), 0))
+
+// 单调时钟，纳秒 (基准测试用)
+static inline uint64_t test_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 固定种子的伪随机数 (xorshift32)，结果可复现
+static inline uint32_t test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "esp_err.h"
 #include "lcd/lcd_init.h"
 #include "wifi/ap/ap_connect.h"
+#include "rc_log.h"
 
 
 
@@ -56,7 +57,8 @@ void print_system_info(void)
 }
 void app_main(void)
 {
-
+    // 最先初始化: 接上复位前留下的 trace，并记下这次启动
+    rc_blog_init();
 
     led_init_all();
     wifi_app_init();
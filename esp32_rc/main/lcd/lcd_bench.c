@@ -0,0 +1,275 @@
+#include "lcd_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "lvgl.h"
+#include "lcd_flush.h"
+#include "lvgl_task.h"
+#include "lcd_init.h"
+#include "rc_ctrl_state.h"
+#include "ui/screens/ui_mainScr.h"
+#include "ui/screens/ui_DataScreen.h"
+#include "ap_connect.h"
+
+static const char *TAG = "LCD_BENCH";
+
+#define BENCH_FULL_FRAMES 20
+#define BENCH_DATA_FRAMES 50
+#define BENCH_ANIM_MS 500
+#define BENCH_ANIM_TIMEOUT_MS 3000
+
+static const char *const s_phase_names[LCD_BENCH_PHASE_COUNT] = {"full", "anim", "data"};
+
+static TaskHandle_t s_lvgl_task;
+static atomic_bool s_requested;
+static atomic_bool s_running;
+static lcd_bench_result_t s_result;     // 只在 LVGL 任务里写，running 为 false 时才给别人读
+
+void lcd_bench_attach(TaskHandle_t lvgl_task)
+{
+    s_lvgl_task = lvgl_task;
+}
+
+bool lcd_bench_pending(void)
+{
+    return atomic_load(&s_requested);
+}
+
+esp_err_t lcd_bench_request(void)
+{
+    if (s_lvgl_task == NULL || atomic_load(&s_running) || atomic_exchange(&s_requested, true))
+        return ESP_ERR_INVALID_STATE;
+    xTaskNotifyGive(s_lvgl_task);
+    return ESP_OK;
+}
+
+// 一段开始前: 结束上一帧的发送窗口，清零峰值，记下累计量
+static void phase_begin(lcd_flush_stats_t *before)
+{
+    lcd_flush_close_span();
+    lcd_flush_get_stats(before);
+    lcd_flush_reset_peaks();
+}
+
+// 一段结束: 等最后一块异步发送完成，再按累计量的差算平均
+static void phase_end(const lcd_flush_stats_t *before, lcd_bench_phase_result_t *r)
+{
+    vTaskDelay(pdMS_TO_TICKS(20));
+    lcd_flush_close_span();
+    lcd_flush_stats_t after;
+    lcd_flush_get_stats(&after);
+
+    uint32_t frames = after.frames - before->frames;
+    uint32_t spans = after.spans - before->spans;
+    memset(r, 0, sizeof(*r));
+    r->frames = frames;
+    r->frame_max_us = after.frame_us_max;
+    r->span_max_us = after.span_us_max;
+    if (frames > 0)
+    {
+        r->frame_avg_us = (uint32_t)((after.frame_us_total - before->frame_us_total) / frames);
+        r->txn_per_frame_x10 = (after.transactions - before->transactions) * 10 / frames;
+        r->bytes_per_frame = (uint32_t)((after.bytes - before->bytes) / frames);
+    }
+    if (spans > 0)
+        r->span_avg_us = (uint32_t)((after.span_us_total - before->span_us_total) / spans);
+}
+
+void lcd_bench_run(void)
+{
+    if (!atomic_exchange(&s_requested, false))
+        return;
+    atomic_store(&s_running, true);
+    ESP_LOGI(TAG, "display bench start (%s)", LCD_DIRECT_MODE ? "direct_psram" : "partial");
+
+    lv_disp_t *disp = lv_disp_get_default();
+    lv_obj_t *orig = lv_scr_act();
+    lcd_flush_stats_t before;
+
+    // full: 整屏重画
+    phase_begin(&before);
+    for (int i = 0; i < BENCH_FULL_FRAMES; i++)
+    {
+        lv_obj_invalidate(lv_scr_act());
+        lcd_flush_refresh_now(disp);
+    }
+    phase_end(&before, &s_result.phase[LCD_BENCH_FULL]);
+
+    // anim: 和短按切屏一样的左移动画
+    lv_obj_t *target = orig == ui_mainScr ? ui_DataScreen : ui_mainScr;
+    phase_begin(&before);
+    lv_scr_load_anim(target, LV_SCR_LOAD_ANIM_MOVE_LEFT, BENCH_ANIM_MS, 0, false);
+    int64_t deadline = esp_timer_get_time() + BENCH_ANIM_TIMEOUT_MS * 1000LL;
+    while (lv_anim_count_running() > 0 && esp_timer_get_time() < deadline)
+    {
+        lvgl_tick_sync();
+        lcd_flush_idle_update(disp);
+        lv_timer_handler();
+        vTaskDelay(1);
+    }
+    phase_end(&before, &s_result.phase[LCD_BENCH_ANIM]);
+
+    // data: 数据屏上摇杆扫一圈、按钮逐个翻转
+    lv_scr_load(ui_DataScreen);
+    lcd_flush_refresh_now(disp);
+    phase_begin(&before);
+    for (int i = 0; i < BENCH_DATA_FRAMES; i++)
+    {
+        UiDataStruct d = {0};
+        d.x1 = (int16_t)(i * (UI_AXIS_SCALE / BENCH_DATA_FRAMES));
+        d.y1 = (int16_t)(-d.x1 / 2);
+        d.sc_h1 = (int16_t)i;
+        ui_set_button(&d.btn_g1, i % UI_BUTTON_COUNT, 1);
+        ui_update_data_screen(&d);
+        lcd_flush_refresh_now(disp);
+    }
+    phase_end(&before, &s_result.phase[LCD_BENCH_DATA]);
+
+    // 恢复: 数据屏换回真实数据，回到原来的屏幕
+    UiDataStruct cur;
+    ctrl_state_read(&cur);
+    ui_update_data_screen(&cur);
+    lv_scr_load(orig);
+    lcd_flush_refresh_now(disp);
+
+    lcd_flush_stats_t st;
+    lcd_flush_get_stats(&st);
+    s_result.buf_internal_bytes = st.buf_internal_bytes;
+    s_result.buf_psram_bytes = st.buf_psram_bytes;
+    s_result.internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    s_result.internal_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    s_result.valid = true;
+    atomic_store(&s_running, false);
+
+    const lcd_bench_phase_result_t *f = &s_result.phase[LCD_BENCH_FULL];
+    ESP_LOGI(TAG, "display bench done: full frame avg %luus span %luus, internal buf %luB",
+             (unsigned long)f->frame_avg_us, (unsigned long)f->span_avg_us, (unsigned long)s_result.buf_internal_bytes);
+}
+
+void lcd_bench_get_result(lcd_bench_result_t *out)
+{
+    if (atomic_load(&s_running))
+    {
+        memset(out, 0, sizeof(*out));
+        out->running = true;
+        return;
+    }
+    *out = s_result;
+}
+
+// GET /api/display/bench
+static esp_err_t bench_get_handler(httpd_req_t *req)
+{
+    lcd_bench_result_t r;
+    lcd_bench_get_result(&r);
+
+    char buf[768];
+    int n = snprintf(buf, sizeof(buf),
+                     "{\"mode\":\"%s\",\"running\":%s,\"valid\":%s,\"buf_internal\":%lu,\"buf_psram\":%lu,"
+                     "\"internal_free\":%lu,\"internal_min_free\":%lu",
+                     LCD_DIRECT_MODE ? "direct_psram" : "partial",
+                     r.running ? "true" : "false", r.valid ? "true" : "false",
+                     (unsigned long)r.buf_internal_bytes, (unsigned long)r.buf_psram_bytes,
+                     (unsigned long)r.internal_free, (unsigned long)r.internal_min_free);
+    for (int i = 0; r.valid && i < LCD_BENCH_PHASE_COUNT; i++)
+    {
+        const lcd_bench_phase_result_t *p = &r.phase[i];
+        n += snprintf(buf + n, sizeof(buf) - n,
+                      ",\"%s\":{\"frames\":%lu,\"frame_avg_us\":%lu,\"frame_max_us\":%lu,\"txn_per_frame_x10\":%lu,"
+                      "\"bytes_per_frame\":%lu,\"span_avg_us\":%lu,\"span_max_us\":%lu}",
+                      s_phase_names[i], (unsigned long)p->frames, (unsigned long)p->frame_avg_us,
+                      (unsigned long)p->frame_max_us, (unsigned long)p->txn_per_frame_x10,
+                      (unsigned long)p->bytes_per_frame, (unsigned long)p->span_avg_us, (unsigned long)p->span_max_us);
+    }
+    snprintf(buf + n, sizeof(buf) - n, "}");
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+// GET /api/display: 显示相关的运行统计 (DataScreen 增量刷新、帧调度、屏幕 SPI)
+static esp_err_t display_get_handler(httpd_req_t *req)
+{
+    char buf[768];
+    int n = snprintf(buf, sizeof(buf), "{");
+
+    // DataScreen 增量刷新: 跳过了多少次 label 标脏、省了多少刷屏像素
+    ui_data_stats_t ui;
+    ui_get_data_stats(&ui);
+    n += snprintf(buf + n, sizeof(buf) - n,
+                  "\"ui\":{\"updates\":%lu,\"labels_set\":%lu,\"labels_skipped\":%lu,\"px_invalidated\":%llu,\"px_saved\":%llu}",
+                  (unsigned long)ui.updates, (unsigned long)ui.labels_set, (unsigned long)ui.labels_skipped,
+                  (unsigned long long)ui.px_invalidated, (unsigned long long)ui.px_saved);
+
+    // 显示帧调度: 帧率、单帧 CPU 时间和占空比，确认屏幕没有挤占网络 / 串口
+    lvgl_frame_stats_t fr;
+    lvgl_get_frame_stats(&fr);
+    n += snprintf(buf + n, sizeof(buf) - n,
+                  ",\"frame\":{\"frames\":%lu,\"fps_x10\":%lu,\"cpu_permille\":%lu,\"last_us\":%lu,\"max_us\":%lu,"
+                  "\"over_budget\":%lu,\"late\":%lu,\"data_updates\":%lu}",
+                  (unsigned long)fr.frames, (unsigned long)fr.fps_x10, (unsigned long)fr.cpu_permille,
+                  (unsigned long)fr.last_busy_us, (unsigned long)fr.max_busy_us,
+                  (unsigned long)fr.over_budget, (unsigned long)fr.late, (unsigned long)fr.data_updates);
+
+    // 屏幕 SPI: 脏区合并效果、事务数和字节率，以及当前拟合的代价系数
+    lcd_flush_stats_t sp;
+    lcd_flush_get_stats(&sp);
+    n += snprintf(buf + n, sizeof(buf) - n,
+                  ",\"spi\":{\"transactions\":%lu,\"txn_per_s\":%lu,\"bytes\":%llu,\"bytes_per_s\":%lu,"
+                  "\"areas_in\":%lu,\"areas_out\":%lu,\"strips\":%lu,\"txn_ns\":%lu,\"px_ns\":%lu}",
+                  (unsigned long)sp.transactions, (unsigned long)sp.txn_per_s, (unsigned long long)sp.bytes,
+                  (unsigned long)sp.bytes_per_s, (unsigned long)sp.areas_in, (unsigned long)sp.areas_out,
+                  (unsigned long)sp.strips, (unsigned long)sp.cost.txn_ns, (unsigned long)sp.cost.px_ns);
+    snprintf(buf + n, sizeof(buf) - n, "}");
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+// POST /api/display/bench，测试在 LVGL 任务里异步跑，几秒后再 GET 结果
+static esp_err_t bench_post_handler(httpd_req_t *req)
+{
+    if (!http_check_pair_key(req))
+        return ESP_FAIL;
+    if (lcd_bench_request() != ESP_OK)
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    httpd_resp_set_status(req, "202 Accepted");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static const httpd_uri_t display_get_uri = {
+    .uri = "/api/display",
+    .method = HTTP_GET,
+    .handler = display_get_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t bench_get_uri = {
+    .uri = "/api/display/bench",
+    .method = HTTP_GET,
+    .handler = bench_get_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t bench_post_uri = {
+    .uri = "/api/display/bench",
+    .method = HTTP_POST,
+    .handler = bench_post_handler,
+    .user_ctx = NULL};
+
+void register_display_handler(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web Server 句柄为空，无法注册显示接口");
+        return;
+    }
+    ESP_LOGI(TAG, "注册显示接口: /api/display, /api/display/bench");
+    httpd_register_uri_handler(server, &display_get_uri);
+    httpd_register_uri_handler(server, &bench_get_uri);
+    httpd_register_uri_handler(server, &bench_post_uri);
+}
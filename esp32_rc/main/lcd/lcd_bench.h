@@ -0,0 +1,82 @@
+#ifndef LCD_BENCH_H
+#define LCD_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+/*
+ * 显示模式基准测试
+ *
+ * 显示模式是编译期选的 (LCD_DIRECT_MODE，见 lcd_flush.h)，两种模式各编一次固件、各跑一次，
+ * 对比结果里的 mode 字段即可。测试在 LVGL 任务里持锁跑，分三段:
+ *   full: 整屏失效重画 20 帧
+ *   anim: 一次 500ms 的 lv_scr_load_anim 切屏动画
+ *   data: 数据屏上 50 帧摇杆 / 按钮变化 (小块 label 更新)
+ * 每段给出帧数、渲染 + 刷屏时间 (平均 / 最大)、每帧 SPI 事务数和字节数、发送窗口 (平均 / 最大)。
+ * 这块屏没有接 TE 脚，发送窗口就是撕裂可见的时间: 面板上新旧两帧内容并存的时长。
+ * 另外给出显示缓冲占用的内部 RAM / PSRAM 和当前内部 RAM 余量。
+ *
+ * POST /api/display/bench 开始 (要带配对密钥，见 ap_connect.h)，GET /api/display/bench 取结果。
+ * GET /api/display 随时可读运行统计 (DataScreen 增量刷新、帧调度、屏幕 SPI)。
+ */
+typedef enum {
+    LCD_BENCH_FULL = 0,
+    LCD_BENCH_ANIM,
+    LCD_BENCH_DATA,
+    LCD_BENCH_PHASE_COUNT,
+} lcd_bench_phase_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t frame_avg_us;
+    uint32_t frame_max_us;
+    uint32_t txn_per_frame_x10;
+    uint32_t bytes_per_frame;
+    uint32_t span_avg_us;
+    uint32_t span_max_us;
+} lcd_bench_phase_result_t;
+
+typedef struct {
+    bool valid;                 // 跑完过至少一次
+    bool running;
+    uint32_t buf_internal_bytes;
+    uint32_t buf_psram_bytes;
+    uint32_t internal_free;     // 跑完时的内部 RAM 余量
+    uint32_t internal_min_free; // 开机以来内部 RAM 的最低余量
+    lcd_bench_phase_result_t phase[LCD_BENCH_PHASE_COUNT];
+} lcd_bench_result_t;
+
+/**
+ * @brief LVGL 任务启动时登记自己，请求测试时用任务通知唤醒它
+ */
+void lcd_bench_attach(TaskHandle_t lvgl_task);
+
+/**
+ * @brief 有没有待跑的测试 (LVGL 任务每帧查一次)
+ */
+bool lcd_bench_pending(void);
+
+/**
+ * @brief 跑一次测试，只能在 LVGL 任务里、持有 LVGL 锁时调用
+ */
+void lcd_bench_run(void);
+
+/**
+ * @brief 请求跑一次测试
+ *
+ * @return ESP_ERR_INVALID_STATE 已经在跑了
+ */
+esp_err_t lcd_bench_request(void);
+
+void lcd_bench_get_result(lcd_bench_result_t *out);
+
+/**
+ * @brief 注册 GET /api/display 和 GET / POST /api/display/bench
+ */
+void register_display_handler(httpd_handle_t server);
+
+#endif
@@ -0,0 +1,439 @@
+#include "lcd_flush.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_ops.h"
+
+static const char *TAG = "LCD_FLUSH";
+
+// 拟合出来之前的默认值: 80MHz SPI 下 16bit 像素 200ns，三条命令大约 25us
+#define DEFAULT_TXN_NS 25000
+#define DEFAULT_PX_NS  200
+
+// 拟合结果的合理范围，超出说明样本有问题 (比如被别的 SPI 设备插队)
+#define TXN_NS_MIN 2000
+#define TXN_NS_MAX 500000
+#define PX_NS_MIN  50
+#define PX_NS_MAX  2000
+
+uint32_t lcd_flush_area_cost(const lcd_flush_cost_t *cost, const lv_area_t *area, uint32_t buf_px)
+{
+    uint32_t w = (uint32_t)lv_area_get_width(area);
+    uint32_t h = (uint32_t)lv_area_get_height(area);
+    uint32_t rows = w ? buf_px / w : 1;
+    if (rows == 0)
+        rows = 1;
+    uint32_t chunks = (h + rows - 1) / rows;
+    return chunks * cost->txn_ns + w * h * cost->px_ns;
+}
+
+static inline void area_union(lv_area_t *out, const lv_area_t *a, const lv_area_t *b)
+{
+    out->x1 = LV_MIN(a->x1, b->x1);
+    out->y1 = LV_MIN(a->y1, b->y1);
+    out->x2 = LV_MAX(a->x2, b->x2);
+    out->y2 = LV_MAX(a->y2, b->y2);
+}
+
+// 从上到下、从左到右排序 (插入排序，最多几十项)
+static void sort_areas(lv_area_t *areas, int m)
+{
+    for (int i = 1; i < m; i++)
+    {
+        lv_area_t a = areas[i];
+        int j = i - 1;
+        while (j >= 0 && (areas[j].y1 > a.y1 || (areas[j].y1 == a.y1 && areas[j].x1 > a.x1)))
+        {
+            areas[j + 1] = areas[j];
+            j--;
+        }
+        areas[j + 1] = a;
+    }
+}
+
+int lcd_flush_plan(lv_area_t *areas, uint8_t *joined, int n, lv_coord_t hor_res, uint32_t buf_px,
+                   const lcd_flush_cost_t *cost, bool *strip)
+{
+    // 先把没被 LVGL 合并掉的项挪到前面
+    int m = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (joined[i])
+            continue;
+        areas[m++] = areas[i];
+    }
+    memset(joined, 0, (size_t)n);
+    *strip = false;
+    if (m <= 1)
+        return m;
+
+    // 块太多时先按位置排序，只试着合并相邻的，把数量降到能两两比较的范围
+    if (m > LCD_FLUSH_MERGE_MAX)
+    {
+        sort_areas(areas, m);
+        int k = 0;
+        for (int i = 1; i < m; i++)
+        {
+            lv_area_t u;
+            area_union(&u, &areas[k], &areas[i]);
+            if (lcd_flush_area_cost(cost, &u, buf_px) <
+                lcd_flush_area_cost(cost, &areas[k], buf_px) + lcd_flush_area_cost(cost, &areas[i], buf_px))
+                areas[k] = u;
+            else
+                areas[++k] = areas[i];
+        }
+        m = k + 1;
+    }
+
+    // 两两合并: 每轮挑省得最多的一对，直到没有能省的
+    if (m <= LCD_FLUSH_MERGE_MAX)
+    {
+        uint32_t c[LCD_FLUSH_MERGE_MAX];
+        for (int i = 0; i < m; i++)
+            c[i] = lcd_flush_area_cost(cost, &areas[i], buf_px);
+
+        while (m > 1)
+        {
+            int bi = -1, bj = -1;
+            uint32_t best_gain = 0, best_cost = 0;
+            lv_area_t best_u;
+            for (int i = 0; i < m; i++)
+            {
+                for (int j = i + 1; j < m; j++)
+                {
+                    lv_area_t u;
+                    area_union(&u, &areas[i], &areas[j]);
+                    uint32_t cu = lcd_flush_area_cost(cost, &u, buf_px);
+                    uint32_t sum = c[i] + c[j];
+                    if (cu < sum && sum - cu > best_gain)
+                    {
+                        best_gain = sum - cu;
+                        best_cost = cu;
+                        best_u = u;
+                        bi = i;
+                        bj = j;
+                    }
+                }
+            }
+            if (bi < 0)
+                break;
+            areas[bi] = best_u;
+            c[bi] = best_cost;
+            areas[bj] = areas[m - 1];
+            c[bj] = c[m - 1];
+            m--;
+        }
+    }
+
+    // 剩下的块和一条覆盖它们全部行的满宽条带比
+    if (m > 1)
+    {
+        lv_area_t band = {.x1 = 0, .y1 = areas[0].y1, .x2 = hor_res - 1, .y2 = areas[0].y2};
+        uint64_t sum = 0;
+        for (int i = 0; i < m; i++)
+        {
+            band.y1 = LV_MIN(band.y1, areas[i].y1);
+            band.y2 = LV_MAX(band.y2, areas[i].y2);
+            sum += lcd_flush_area_cost(cost, &areas[i], buf_px);
+        }
+        if (lcd_flush_area_cost(cost, &band, buf_px) < sum)
+        {
+            areas[0] = band;
+            *strip = true;
+            return 1;
+        }
+    }
+
+    sort_areas(areas, m);
+    return m;
+}
+
+// ================= 设备部分 =================
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static lcd_flush_stats_t s_stats = {.cost = {DEFAULT_TXN_NS, DEFAULT_PX_NS}};
+static int64_t s_since_us;
+
+// 正在进行的事务 (LVGL 等上一块刷完才会调下一次 flush_cb，所以同一时间最多一个；
+// 直接模式下两块弹跳缓冲可能同时在队列里，只拿第一块做拟合样本)
+static int64_t s_txn_start_us;
+static uint32_t s_txn_px;
+static bool s_txn_busy;
+
+// 当前帧第一个事务开始 / 最后一个事务完成的时间，算发送窗口
+static int64_t s_span_first_us;
+static int64_t s_span_last_us;
+
+// 最小二乘拟合 t = txn + px * p 的累加量 (t 单位 us)
+static struct {
+    uint32_t n;
+    uint64_t sp, st, spp, spt;
+} s_fit;
+
+void lcd_flush_txn_begin(uint32_t px)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_lock);
+    if (!s_txn_busy)
+    {
+        s_txn_start_us = now;
+        s_txn_px = px;
+        s_txn_busy = true;
+    }
+    if (s_span_first_us == 0)
+        s_span_first_us = now;
+    s_stats.transactions++;
+    s_stats.bytes += (uint64_t)px * sizeof(lv_color_t);
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void lcd_flush_txn_done_isr(void)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL_ISR(&s_lock);
+    s_span_last_us = now;
+    if (s_txn_busy)
+    {
+        s_txn_busy = false;
+        uint64_t t = (uint64_t)(now - s_txn_start_us);
+        uint64_t p = s_txn_px;
+        s_fit.n++;
+        s_fit.sp += p;
+        s_fit.st += t;
+        s_fit.spp += p * p;
+        s_fit.spt += p * t;
+    }
+    taskEXIT_CRITICAL_ISR(&s_lock);
+}
+
+// 样本够了就重新拟合两个系数；像素数都差不多时斜率不可信，只更新截距
+static void refit(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    if (s_fit.n < LCD_FLUSH_FIT_SAMPLES)
+    {
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    int64_t n = s_fit.n, sp = (int64_t)s_fit.sp, st = (int64_t)s_fit.st;
+    int64_t spp = (int64_t)s_fit.spp, spt = (int64_t)s_fit.spt;
+    memset(&s_fit, 0, sizeof(s_fit));
+    lcd_flush_cost_t cost = s_stats.cost;
+    taskEXIT_CRITICAL(&s_lock);
+
+    int64_t den = n * spp - sp * sp;
+    if (den > n * n * 100) // 像素数的标准差至少 10 px
+    {
+        int64_t px_ns = (n * spt - sp * st) * 1000 / den;
+        cost.px_ns = (uint32_t)LV_CLAMP(PX_NS_MIN, px_ns, PX_NS_MAX);
+    }
+    int64_t txn_ns = (st * 1000 - (int64_t)cost.px_ns * sp) / n;
+    cost.txn_ns = (uint32_t)LV_CLAMP(TXN_NS_MIN, txn_ns, TXN_NS_MAX);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.cost = cost;
+    taskEXIT_CRITICAL(&s_lock);
+    ESP_LOGD(TAG, "cost model: txn %luns px %luns", (unsigned long)cost.txn_ns, (unsigned long)cost.px_ns);
+}
+
+#if LCD_DIRECT_MODE
+// 直接模式: LVGL 在整帧缓冲里原地画，flush_cb 拿到的永远是整屏区域，
+// 所以这一帧真正画了哪些区域要在渲染前从脏区列表里抄一份 (规划只影响发送，不改 LVGL 的列表)
+static lv_area_t s_direct_areas[LV_INV_BUF_SIZE];
+static int s_direct_n;
+static lv_color_t *s_bounce[2];
+static SemaphoreHandle_t s_bounce_free;    // 空闲的弹跳缓冲数
+
+static void direct_snapshot(lv_disp_t *disp, const lcd_flush_cost_t *cost)
+{
+    uint8_t joined[LV_INV_BUF_SIZE];
+    int n = disp->inv_p;
+    memcpy(s_direct_areas, disp->inv_areas, n * sizeof(lv_area_t));
+    memcpy(joined, disp->inv_area_joined, n);
+
+    bool strip;
+    int in = 0;
+    for (int i = 0; i < n; i++)
+        in += joined[i] == 0;
+    s_direct_n = lcd_flush_plan(s_direct_areas, joined, n, disp->driver->hor_res,
+                                (uint32_t)disp->driver->hor_res * LCD_BOUNCE_LINES, cost, &strip);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.areas_in += in;
+    s_stats.areas_out += s_direct_n;
+    s_stats.strips += strip;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t lcd_flush_direct_init(lv_coord_t hor_res)
+{
+    size_t bytes = (size_t)LCD_BOUNCE_LINES * hor_res * sizeof(lv_color_t);
+    for (int i = 0; i < 2; i++)
+    {
+        s_bounce[i] = heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (s_bounce[i] == NULL)
+            return ESP_ERR_NO_MEM;
+    }
+    s_bounce_free = xSemaphoreCreateCounting(2, 2);
+    return s_bounce_free ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void lcd_flush_direct_send(esp_lcd_panel_handle_t panel, const lv_color_t *fb, lv_coord_t hor_res)
+{
+    int b = 0;
+    for (int i = 0; i < s_direct_n; i++)
+    {
+        const lv_area_t *a = &s_direct_areas[i];
+        lv_coord_t w = lv_area_get_width(a);
+        for (lv_coord_t y = a->y1; y <= a->y2; y += LCD_BOUNCE_LINES)
+        {
+            lv_coord_t rows = LV_MIN(LCD_BOUNCE_LINES, a->y2 - y + 1);
+            // 两块缓冲轮流用；传输按顺序完成，拿到名额时 s_bounce[b] 一定已经发完
+            xSemaphoreTake(s_bounce_free, portMAX_DELAY);
+            lv_color_t *dst = s_bounce[b];
+            for (lv_coord_t r = 0; r < rows; r++)
+                memcpy(dst + r * w, fb + (y + r) * hor_res + a->x1, w * sizeof(lv_color_t));
+            lcd_flush_txn_begin((uint32_t)w * rows);
+            esp_lcd_panel_draw_bitmap(panel, a->x1, y, a->x2 + 1, y + rows, dst);
+            b ^= 1;
+        }
+    }
+    // 等两块都发完再还给 LVGL，下一帧才能安全地往这个帧缓冲里画
+    xSemaphoreTake(s_bounce_free, portMAX_DELAY);
+    xSemaphoreTake(s_bounce_free, portMAX_DELAY);
+    xSemaphoreGive(s_bounce_free);
+    xSemaphoreGive(s_bounce_free);
+}
+
+bool lcd_flush_bounce_done_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    lcd_flush_txn_done_isr();
+    xSemaphoreGiveFromISR(s_bounce_free, &woken);
+    return woken == pdTRUE;
+}
+#endif
+
+// 上一帧的发送窗口: 面板上新旧两帧内容混在一起的时间 (这块屏没接 TE 脚，窗口越短撕裂越不明显)
+static void frame_span_close(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    if (s_span_first_us != 0 && s_span_last_us > s_span_first_us)
+    {
+        uint32_t span = (uint32_t)(s_span_last_us - s_span_first_us);
+        s_stats.spans++;
+        s_stats.span_us_total += span;
+        if (span > s_stats.span_us_max)
+            s_stats.span_us_max = span;
+    }
+    s_span_first_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// 接在 LVGL 刷新定时器前面: 规划脏区，然后照常渲染
+static void refr_timer_cb(lv_timer_t *timer)
+{
+    lv_disp_t *disp = timer->user_data;
+
+    if (disp->inv_p == 0)
+    {
+        _lv_disp_refr_timer(timer);
+        return;
+    }
+
+    frame_span_close();
+    refit();
+    lcd_flush_cost_t cost = s_stats.cost;
+#if LCD_DIRECT_MODE
+    direct_snapshot(disp, &cost);
+#else
+    lv_disp_drv_t *drv = disp->driver;
+    if (!drv->full_refresh)
+    {
+        int in = 0;
+        for (int i = 0; i < disp->inv_p; i++)
+            in += disp->inv_area_joined[i] == 0;
+
+        bool strip;
+        int out = lcd_flush_plan(disp->inv_areas, disp->inv_area_joined, disp->inv_p, drv->hor_res,
+                                 drv->draw_buf->size, &cost, &strip);
+        disp->inv_p = out;
+
+        taskENTER_CRITICAL(&s_lock);
+        s_stats.areas_in += in;
+        s_stats.areas_out += out;
+        s_stats.strips += strip;
+        taskEXIT_CRITICAL(&s_lock);
+    }
+#endif
+
+    // 渲染 + 刷屏的时间 (部分刷新模式下最后一块还在异步发送，不算在内)
+    int64_t t0 = esp_timer_get_time();
+    _lv_disp_refr_timer(timer);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.frames++;
+    s_stats.frame_us_total += us;
+    if (us > s_stats.frame_us_max)
+        s_stats.frame_us_max = us;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void lcd_flush_install(lv_disp_t *disp)
+{
+    s_since_us = esp_timer_get_time();
+    lv_timer_set_cb(disp->refr_timer, refr_timer_cb);
+}
+
+bool lcd_flush_idle_update(lv_disp_t *disp)
+{
+    if (disp->inv_p > 0)
+    {
+        lv_timer_resume(disp->refr_timer);
+        return true;
+    }
+    lv_timer_pause(disp->refr_timer);
+    return false;
+}
+
+void lcd_flush_refresh_now(lv_disp_t *disp)
+{
+    refr_timer_cb(disp->refr_timer);
+}
+
+void lcd_flush_set_buffers(uint32_t internal_bytes, uint32_t psram_bytes)
+{
+    s_stats.buf_internal_bytes = internal_bytes;
+    s_stats.buf_psram_bytes = psram_bytes;
+}
+
+void lcd_flush_close_span(void)
+{
+    frame_span_close();
+}
+
+void lcd_flush_reset_peaks(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_stats.frame_us_max = 0;
+    s_stats.span_us_max = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void lcd_flush_get_stats(lcd_flush_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    taskEXIT_CRITICAL(&s_lock);
+
+    int64_t elapsed = esp_timer_get_time() - s_since_us;
+    if (elapsed > 0)
+    {
+        out->bytes_per_s = (uint32_t)(out->bytes * 1000000ull / (uint64_t)elapsed);
+        out->txn_per_s = (uint32_t)((uint64_t)out->transactions * 1000000ull / (uint64_t)elapsed);
+    }
+}
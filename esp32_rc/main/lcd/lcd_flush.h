@@ -0,0 +1,157 @@
+#ifndef LCD_FLUSH_H
+#define LCD_FLUSH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_lcd_panel_ops.h"
+
+/*
+ * 显示模式 (编译期选择)
+ *   0: 部分刷新 (默认)。两块 240x50 的内部 DMA 绘图缓冲，大区域分块渲染、边渲染边发。
+ *   1: 直接模式。两块 240x240 整帧缓冲放在 PSRAM，LVGL 原地渲染 (direct_mode)，
+ *      一帧画完后把脏区经两块内部 DMA 弹跳缓冲 (LCD_BOUNCE_LINES 行) 轮流发给面板。
+ *      内部 RAM 占用更少，整帧动画不再分块渲染；需要打开 CONFIG_SPIRAM。
+ * 两种模式的帧时间、内部 RAM 和撕裂窗口用 POST /api/display/bench 在板子上对比 (lcd_bench.h)。
+ */
+#ifndef LCD_DIRECT_MODE
+#define LCD_DIRECT_MODE 0
+#endif
+
+#if LCD_DIRECT_MODE && !CONFIG_SPIRAM
+#error "LCD_DIRECT_MODE needs CONFIG_SPIRAM"
+#endif
+
+#define LCD_BOUNCE_LINES 20
+
+/*
+ * 刷屏前的脏区规划
+ *
+ * 每次 esp_lcd_panel_draw_bitmap 都要先发 CASET / RASET / RAMWR 三条命令 (各自一次 SPI 事务)，
+ * 数据屏上十几个小 label 各刷一块时，命令开销比像素本身还贵。
+ * 这里在 LVGL 刷新定时器开始渲染之前接管它的脏区列表:
+ *   - 按代价模型两两合并 (合并后多刷的像素比省下的事务便宜就合)
+ *   - 脏区很多时和一整条满宽条带比较，条带便宜就只刷条带
+ *   - 按 y 从上到下排序，跟面板扫描方向一致
+ * 代价 = 事务数 * 单次事务开销 + 像素数 * 每像素时间，两个系数由实际刷屏时间在线拟合。
+ * 一个脏区宽 w 时，LVGL 每次最多渲染 draw_buf 能装下的 buf_px / w 行，所以事务数按这个分块算。
+ */
+#define LCD_FLUSH_MERGE_MAX     12      // 超过这么多块先只合并相邻的，再两两比较
+#define LCD_FLUSH_FIT_SAMPLES   64      // 攒够这么多次事务重新拟合一次代价系数
+
+typedef struct {
+    uint32_t txn_ns;        // 每次 draw_bitmap 的固定开销 (命令 + 片选 + DMA 启动)
+    uint32_t px_ns;         // 每像素的传输时间
+} lcd_flush_cost_t;
+
+typedef struct {
+    uint32_t frames;            // 真正渲染过的帧数 (有脏区的刷新)
+    uint32_t areas_in;          // LVGL 给的脏区数
+    uint32_t areas_out;         // 规划后实际要刷的块数
+    uint32_t strips;            // 选了满宽条带的次数
+    uint32_t transactions;      // draw_bitmap 次数
+    uint64_t bytes;             // 发给面板的像素字节数
+    uint32_t bytes_per_s;       // 开机以来的平均字节率 (取统计时算出)
+    uint32_t txn_per_s;         // 开机以来的平均事务率
+    lcd_flush_cost_t cost;      // 当前使用的代价系数
+    uint64_t frame_us_total;    // 渲染 + 刷屏时间累计
+    uint32_t frame_us_max;
+    uint32_t spans;             // 统计过发送窗口的帧数
+    uint64_t span_us_total;     // 一帧第一个事务开始到最后一个事务完成
+    uint32_t span_us_max;
+    uint32_t buf_internal_bytes;    // 显示缓冲占的内部 RAM
+    uint32_t buf_psram_bytes;       // 显示缓冲占的 PSRAM
+} lcd_flush_stats_t;
+
+/**
+ * @brief 一块区域的刷屏代价 (ns)
+ *
+ * @param buf_px LVGL 绘图缓冲能装的像素数，决定一块区域要分几次刷
+ */
+uint32_t lcd_flush_area_cost(const lcd_flush_cost_t *cost, const lv_area_t *area, uint32_t buf_px);
+
+/**
+ * @brief 规划一帧要刷的区域: 合并、选条带、排序
+ *
+ * 纯逻辑，不碰 LVGL 的全局状态
+ * @param areas   输入输出，LVGL 的 inv_areas
+ * @param joined  对应的 inv_area_joined，非 0 的项跳过
+ * @param n       项数
+ * @param hor_res 屏幕宽度 (条带宽度)
+ * @param strip   返回 true 表示选了满宽条带
+ * @return 规划后的块数 (写在 areas 前面，joined 全部清零)
+ */
+int lcd_flush_plan(lv_area_t *areas, uint8_t *joined, int n, lv_coord_t hor_res, uint32_t buf_px,
+                   const lcd_flush_cost_t *cost, bool *strip);
+
+/**
+ * @brief 在 LVGL 的刷新定时器前挂上规划步骤 (lv_disp_drv_register 之后调用)
+ */
+void lcd_flush_install(lv_disp_t *disp);
+
+/**
+ * @brief flush_cb 里每次 draw_bitmap 之前调用，记录事务开始
+ */
+void lcd_flush_txn_begin(uint32_t px);
+
+/**
+ * @brief 面板 IO 传输完成回调 (中断里) 调用，记录事务耗时用于拟合
+ */
+void lcd_flush_txn_done_isr(void);
+
+/**
+ * @brief 取刷屏统计
+ */
+void lcd_flush_get_stats(lcd_flush_stats_t *out);
+
+/**
+ * @brief 有脏区就恢复 LVGL 的刷新定时器，没有就暂停它
+ *
+ * 刷新定时器默认 30ms 一次一直在跑，暂停后 lv_timer_handler 返回的才是真正的下一个截止时间，
+ * 屏幕静止时 LVGL 任务可以一直睡。lv_timer_handler 前后各调一次。
+ * @return true 有脏区
+ */
+bool lcd_flush_idle_update(lv_disp_t *disp);
+
+/**
+ * @brief 立刻刷新一帧 (经过规划和计时，代替 lv_refr_now)，需要持有 LVGL 锁
+ */
+void lcd_flush_refresh_now(lv_disp_t *disp);
+
+/**
+ * @brief 记录显示缓冲的内存占用 (lvgl_init 分配完调用)
+ */
+void lcd_flush_set_buffers(uint32_t internal_bytes, uint32_t psram_bytes);
+
+/**
+ * @brief 清零帧时间和发送窗口的最大值 (基准测试分段用)
+ */
+void lcd_flush_reset_peaks(void);
+
+/**
+ * @brief 结束当前帧的发送窗口统计 (平时在下一帧开始时自动结束)
+ */
+void lcd_flush_close_span(void);
+
+#if LCD_DIRECT_MODE
+/**
+ * @brief 分配两块弹跳缓冲 (内部 DMA 内存)
+ */
+esp_err_t lcd_flush_direct_init(lv_coord_t hor_res);
+
+/**
+ * @brief 直接模式的 flush: 把这一帧的脏区从整帧缓冲经弹跳缓冲发出去，发完才返回
+ */
+void lcd_flush_direct_send(esp_lcd_panel_handle_t panel, const lv_color_t *fb, lv_coord_t hor_res);
+
+/**
+ * @brief 直接模式下面板 IO 传输完成回调 (中断里) 调用
+ *
+ * @return 是否唤醒了更高优先级的任务
+ */
+bool lcd_flush_bounce_done_isr(void);
+#endif
+
+#endif
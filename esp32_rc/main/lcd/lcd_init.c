@@ -27,6 +27,8 @@
 #include "ui/screens/ui_mainScr.h"
 #include "ui/screens/ui_wifiINFOScreen.h"
 #include "nvs_manager.h"
+#include "rc_log.h"
+#include "lcd_flush.h"
 
 #include "lvgl_task.h"
 // 屏幕分辨率
@@ -41,12 +43,8 @@
 #define EXAMPLE_PIN_NUM_DATA0 47
 #define EXAMPLE_PIN_NUM_LCD_RST 45
 
-#define EXAMPLE_LVGL_TICK_PERIOD_MS 2
-
 #define EXAMPLE_LVGL_BUFF_SIZE EXAMPLE_LCD_H_RES * 50
 
-#define EXAMPLE_LVGL_TICK_PERIOD_MS 2
-
 #define EXAMPLE_LVGL_TASK_STACK_SIZE (5 * 1024)
 #define EXAMPLE_LVGL_TASK_PRIORITY 2
 
@@ -77,12 +75,18 @@ led_strip_handle_t led_strip;
 // esp_lcd面板io 写完成回调函数
 static bool example_notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
+#if LCD_DIRECT_MODE
+    // 直接模式下一帧分好几块弹跳缓冲发送，flush_cb 自己等全部发完再通知 LVGL
+    return lcd_flush_bounce_done_isr();
+#else
     lv_disp_drv_t *disp_driver = (lv_disp_drv_t *)user_ctx;
+    lcd_flush_txn_done_isr();
 
     /* 告诉 LVGL：一次 flush（显示刷新）已经完成，LVGL 可以继续内部处理。
        lv_disp_flush_ready 的实现会通知 LVGL 的调度器该显示缓冲已被显示设备使用完毕。*/
     lv_disp_flush_ready(disp_driver);
     return false;
+#endif
 }
 
 void spi_init()
@@ -157,15 +161,47 @@ static void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_
     const int offsety1 = area->y1;
     const int offsety2 = area->y2;
 
+#if LCD_DIRECT_MODE
+    // 直接模式: area 总是整屏、color_map 是整帧缓冲，LVGL 每个脏区调一次；画完最后一块才发
+    if (lv_disp_flush_is_last(drv))
+        lcd_flush_direct_send(panel_handle, color_map, drv->hor_res);
+    lv_disp_flush_ready(drv);
+    return;
+#endif
+
     // copy a buffer's content to a specific area of the display
+    lcd_flush_txn_begin((uint32_t)(offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1));
     esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
+
+    // 一帧可能分好几块刷，最后一块时记一条 trace
+    static uint16_t frame_chunks = 0;
+    static uint32_t frame_pixels = 0;
+    frame_chunks++;
+    frame_pixels += (uint32_t)(offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1);
+    if (lv_disp_flush_is_last(drv))
+    {
+        rc_blog(RC_EV_LVGL_FLUSH, frame_chunks, frame_pixels);
+        frame_chunks = 0;
+        frame_pixels = 0;
+    }
 }
 
 SemaphoreHandle_t lvgl_mux = NULL;
-static void example_increase_lvgl_tick(void *arg)
+// LVGL 的 tick 不再用 2ms 周期定时器推，而是每次要用之前按 esp_timer_get_time() 的差值补上；
+// 屏幕静止时没有任何周期中断，不到毫秒的零头留到下次
+void lvgl_tick_sync(void)
 {
-    /* Tell LVGL how many milliseconds has elapsed */
-    lv_tick_inc(EXAMPLE_LVGL_TICK_PERIOD_MS);
+    static int64_t last_us = 0;
+    int64_t now = esp_timer_get_time();
+    if (last_us == 0)
+        last_us = now;
+    uint32_t ms = (uint32_t)((now - last_us) / 1000);
+    if (ms > 0)
+    {
+        /* Tell LVGL how many milliseconds has elapsed */
+        lv_tick_inc(ms);
+        last_us += (int64_t)ms * 1000;
+    }
 }
 void lvgl_init()
 {
@@ -177,12 +213,26 @@ void lvgl_init()
     heap_caps_malloc(EXAMPLE_LVGL_BUFFER_SIZE, MALLOC_CAP_DMA) 在 ESP32 中分配具有 DMA 能力的内存区域。
     buf1/buf2 是两个绘图缓冲区，LVGL 可以在它们之间切换以减少闪烁。
     如果内存不足，可以只分配一个缓冲区或减小 EXAMPLE_LVGL_BUFFER_SIZE。 */
+#if LCD_DIRECT_MODE
+    // 两块整帧缓冲放 PSRAM，内部 RAM 只留两块弹跳缓冲
+    const size_t fb_px = EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES;
+    lv_color_t *buf1 = heap_caps_malloc(fb_px * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    assert(buf1);
+    lv_color_t *buf2 = heap_caps_malloc(fb_px * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    assert(buf2);
+    ESP_ERROR_CHECK(lcd_flush_direct_init(EXAMPLE_LCD_H_RES));
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, fb_px);
+    lcd_flush_set_buffers(2 * LCD_BOUNCE_LINES * EXAMPLE_LCD_H_RES * sizeof(lv_color_t),
+                          2 * fb_px * sizeof(lv_color_t));
+#else
     lv_color_t *buf1 = heap_caps_malloc(EXAMPLE_LVGL_BUFF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
     assert(buf1);
     lv_color_t *buf2 = heap_caps_malloc(EXAMPLE_LVGL_BUFF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
     assert(buf2);
     // initialize LVGL draw buffers
     lv_disp_draw_buf_init(&disp_buf, buf1, buf2, EXAMPLE_LVGL_BUFF_SIZE);
+    lcd_flush_set_buffers(2 * EXAMPLE_LVGL_BUFF_SIZE * sizeof(lv_color_t), 0);
+#endif
 
     /* =============== 注册显示驱动到 LVGL =============== */
     ESP_LOGI(TAG, "Register display driver to LVGL");
@@ -190,21 +240,19 @@ void lvgl_init()
     disp_drv.hor_res = EXAMPLE_LCD_H_RES;
     disp_drv.ver_res = EXAMPLE_LCD_V_RES;
     disp_drv.flush_cb = example_lvgl_flush_cb; // 回调函数！！！！！
+#if LCD_DIRECT_MODE
+    disp_drv.direct_mode = 1;
+#endif
 
     // 驱动更新回调
     disp_drv.draw_buf = &disp_buf;
     disp_drv.user_data = panel_handle;
     lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    // 渲染前先合并 / 排序脏区，减少小块 SPI 事务 (见 lcd_flush.h)
+    lcd_flush_install(disp);
 
-    /* =============== 注册 LVGL tick 定时器（用 esp_timer） =============== */
-    ESP_LOGI(TAG, "Install LVGL tick timer");
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &example_increase_lvgl_tick, // 回调函数！！！！！！！！！
-        .name = "lvgl_tick"};
-    esp_timer_handle_t lvgl_tick_timer = NULL;
-    ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, EXAMPLE_LVGL_TICK_PERIOD_MS * 1000));
+    // LVGL tick 由 LVGL 任务调用 lvgl_tick_sync() 补齐，不装周期定时器
+    lvgl_tick_sync();
 
     lvgl_mux = xSemaphoreCreateMutex();
     assert(lvgl_mux);
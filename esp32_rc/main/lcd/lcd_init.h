@@ -14,6 +14,11 @@
 extern SemaphoreHandle_t lvgl_mux;
 void led_init_all();
 
+/**
+ * @brief 按 esp_timer_get_time() 的差值推进 LVGL tick，调用 lv_timer_handler 之前调用 (需持有 LVGL 锁)
+ */
+void lvgl_tick_sync(void);
+
 
 
 
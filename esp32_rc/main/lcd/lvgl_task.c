@@ -8,6 +8,8 @@
 #include "freertos/semphr.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
 #include "ui.h"
 #include "button_gpio.h"
 #include "iot_button.h"
@@ -16,13 +18,50 @@
 #include "ui/screens/ui_wifiINFOScreen.h"
 #include "nvs_manager.h"
 #include "udp_task.h"
+#include "rc_ctrl_state.h"
+#include "rc_log.h"
+#include "lcd_bench.h"
 char *TAG = "LVGL_TASK";
 
 // lvgl任务
-#define EXAMPLE_LVGL_TASK_MAX_DELAY_MS 500
 #define EXAMPLE_LVGL_TASK_MIN_DELAY_MS 1
+#define LATENCY_SCREEN_REFRESH_MS 500
 
-static QueueHandle_t ReSetUiQueue = NULL;
+// 帧调度: 控制数据再快，屏幕也只按帧节拍刷新，两帧之间的数据合并成一次
+#define LVGL_TARGET_FPS 30                              // 目标帧率 (动画 / 切屏)
+#define LVGL_FRAME_PERIOD_US (1000000 / LVGL_TARGET_FPS)
+#define LVGL_FRAME_BUDGET_US 8000                       // 一帧的 CPU 时间预算，超了记一次 over_budget
+#define LVGL_MAX_CPU_PERCENT 30                         // 占空比上限: 一帧忙了 t，下一帧至少 t*100/30 之后才开始
+
+static QueueHandle_t ReSetUiQueue = NULL;   // 长按进度，只留最新一个
+
+// LVGL 任务只在一个任务通知上睡眠: 控制数据、按键、WiFi 信息、基准测试请求都用它唤醒，
+// 醒来后再看具体是什么事。按键要做的 LVGL 操作记成下面的位，由 LVGL 任务持锁执行
+#define UI_EV_SWITCH_SCREEN (1u << 0)
+#define UI_EV_RESET_SCREEN  (1u << 1)
+#define UI_EV_BACK_TO_MAIN  (1u << 2)
+static atomic_uint s_ui_events;
+static TaskHandle_t s_lvgl_task = NULL;
+
+void lvgl_task_wake(void)
+{
+    if (s_lvgl_task != NULL)
+        xTaskNotifyGive(s_lvgl_task);
+}
+
+// 除了控制数据以外，有没有要 LVGL 任务处理的事
+static bool ui_work_pending(void)
+{
+    return atomic_load(&s_ui_events) != 0 || lcd_bench_pending() ||
+           (ReSetUiQueue != NULL && uxQueueMessagesWaiting(ReSetUiQueue) > 0) ||
+           (wifi_info_semaphore != NULL && uxSemaphoreGetCount(wifi_info_semaphore) > 0);
+}
+
+static void ui_post_event(unsigned ev)
+{
+    atomic_fetch_or(&s_ui_events, ev);
+    lvgl_task_wake();
+}
 
 // 按键
 #define BUTTON_LONG_PRESS_TARGET_TIME 4000
@@ -41,18 +80,19 @@ static void button_event_cb(void *arg, void *data)
 {
 
     button_event_t event = iot_button_get_event(arg);
+    rc_blog(RC_EV_BUTTON, event, 0);
     ESP_LOGI(TAG, "%s", iot_button_get_event_str(event));
     if (event == BUTTON_SINGLE_CLICK) // 短按切换屏幕
     {
 
-        lv_async_call(switch_screen_safe, NULL);
+        ui_post_event(UI_EV_SWITCH_SCREEN);
     }
 
     // 长按足够久执行重置操作
     if (BUTTON_LONG_PRESS_START == event)
     {
         // 切换进度展示屏幕
-        lv_async_call(ui_load_reset_screen, NULL);
+        ui_post_event(UI_EV_RESET_SCREEN);
         g_operation_executed = false; // 重置标志
     }
 
@@ -64,9 +104,9 @@ static void button_event_cb(void *arg, void *data)
         // 在lcd中展示秒数
         uint8_t lcd_time = (time - BUTTON_LONG_PRESS_TIME) * 100 / BUTTON_LONG_PRESS_TARGET_TIME;
         // lv_async_call(ui_update_wrapper_async,(void *)(intptr_t)lcd_time);
-        if (xQueueSend(ReSetUiQueue, &lcd_time, portMAX_DELAY) == pdPASS)
-        {
-        }
+        if (ReSetUiQueue != NULL)
+            xQueueOverwrite(ReSetUiQueue, &lcd_time);
+        lvgl_task_wake();
 
         if (time >= BUTTON_LONG_PRESS_TARGET_TIME)
         {
@@ -94,12 +134,12 @@ static void button_event_cb(void *arg, void *data)
         {
             g_operation_executed = false;
             // 切换回屏幕
-            lv_async_call(back_to_main, NULL);
+            ui_post_event(UI_EV_BACK_TO_MAIN);
         }
     }
 }
 
-lv_obj_t *LVGL_Scr_List[3];
+lv_obj_t *LVGL_Scr_List[4];
 void button_init()
 {
     // create gpio button
@@ -159,6 +199,43 @@ static void example_lvgl_unlock(void)
     xSemaphoreGive(lvgl_mux);
 }
 
+static portMUX_TYPE s_frame_lock = portMUX_INITIALIZER_UNLOCKED;
+static lvgl_frame_stats_t s_frame_stats;
+static int64_t s_frame_stats_since_us;
+
+static void frame_stats_add(uint32_t busy_us, bool late, bool data_applied)
+{
+    taskENTER_CRITICAL(&s_frame_lock);
+    lvgl_frame_stats_t *st = &s_frame_stats;
+    st->frames++;
+    st->busy_us_total += busy_us;
+    st->last_busy_us = busy_us;
+    if (busy_us > st->max_busy_us)
+        st->max_busy_us = busy_us;
+    if (busy_us > LVGL_FRAME_BUDGET_US)
+        st->over_budget++;
+    if (late)
+        st->late++;
+    if (data_applied)
+        st->data_updates++;
+    taskEXIT_CRITICAL(&s_frame_lock);
+}
+
+void lvgl_get_frame_stats(lvgl_frame_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_frame_lock);
+    *out = s_frame_stats;
+    int64_t since = s_frame_stats_since_us;
+    taskEXIT_CRITICAL(&s_frame_lock);
+
+    int64_t elapsed = esp_timer_get_time() - since;
+    if (elapsed > 0)
+    {
+        out->fps_x10 = (uint32_t)((uint64_t)out->frames * 10000000ull / (uint64_t)elapsed);
+        out->cpu_permille = (uint32_t)(out->busy_us_total * 1000ull / (uint64_t)elapsed);
+    }
+}
+
 UiDataStruct lvgl_rc_value = {0};
 void example_lvgl_port_task(void *arg)
 {
@@ -170,59 +247,137 @@ void example_lvgl_port_task(void *arg)
     // lv_demo_benchmark();
     ui_init();
     ui_create_reset_screen_arc();
+    ui_create_latency_screen();
     LVGL_Scr_List[0] = ui_mainScr;
     LVGL_Scr_List[1] = ui_DataScreen;
     LVGL_Scr_List[2] = ui_wifiINFOScreen;
-    //LVGL_Scr_List[3] = ui_Screen1;
+    LVGL_Scr_List[3] = ui_LatencyScreen;
 
-    ReSetUiQueue = xQueueCreate(1, sizeof(int));
-    uint32_t task_delay_ms = EXAMPLE_LVGL_TASK_MAX_DELAY_MS;
+    ReSetUiQueue = xQueueCreate(1, sizeof(uint8_t));
+    uint32_t task_delay_ms = 0;
 
     uint8_t ReSetValue = 0;
+    unsigned rc_version = 0;        // 数据屏上显示的是哪个版本的控制数据
+    bool data_visible = false;
+    bool latency_visible = false;
+
+    // 控制数据变化时通知本任务；屏幕只显示两位小数，最多 10Hz 取一次就够了。
+    // 通知只唤醒，真正的 label 更新等到下一帧开始时按版本号判断
+    const ctrl_sub_filter_t rc_filter = {
+        .min_interval_ms = 100,
+        .axis_delta = UI_AXIS_SCALE / 200,
+        .scroller_delta = 0,
+    };
+    s_lvgl_task = xTaskGetCurrentTaskHandle();
+    ctrl_state_subscribe(s_lvgl_task, &rc_filter);
+    lcd_bench_attach(s_lvgl_task);
+    uint32_t latency_refresh_tick = 0;
+    lv_disp_t *disp = lv_disp_get_default();
+
+    // 帧节拍: 本任务在核 1、优先级 2，比 UDP (5) 和 UART (最高) 都低，本来就抢不过它们；
+    // 这里再保证两帧之间至少隔 LVGL_FRAME_PERIOD_US，并把整体占空比压在 LVGL_MAX_CPU_PERCENT 以内
+    s_frame_stats_since_us = esp_timer_get_time();
+    int64_t next_frame_us = s_frame_stats_since_us;
 
     while (1)
     {
-        if (wifi_info_semaphore != NULL)
+        int64_t frame_start = esp_timer_get_time();
+        bool late = frame_start - next_frame_us > LVGL_FRAME_PERIOD_US;  // 比节拍晚了一整帧以上
+        bool data_applied = false;
+
+        // Lock the mutex due to the LVGL APIs are not thread-safe
+        if (example_lvgl_lock(-1))
         {
-            if (xSemaphoreTake(wifi_info_semaphore, 0) == pdTRUE)
+            lvgl_tick_sync();
+
+            if (wifi_info_semaphore != NULL && xSemaphoreTake(wifi_info_semaphore, 0) == pdTRUE)
             {
                 setWifiInfoText(wifi_info_buf);
             }
-        }
 
-        if (ReSetUiQueue != NULL)
-        {
-            if (xQueueReceive(ReSetUiQueue, &ReSetValue, 0) == pdPASS)
+            unsigned ev = atomic_exchange(&s_ui_events, 0);
+            if (ev & UI_EV_SWITCH_SCREEN)
+                switch_screen_safe();
+            if (ev & UI_EV_RESET_SCREEN)
+                ui_load_reset_screen();
+
+            if (ReSetUiQueue != NULL && xQueueReceive(ReSetUiQueue, &ReSetValue, 0) == pdPASS)
             {
                 // ui_update_reset_progress_custom(ReSetValue);
                 ui_update_reset_progress_arc(ReSetValue);
                 ESP_LOGE(TAG, "复位进度:%d", ReSetValue);
             }
-        }
+            if (ev & UI_EV_BACK_TO_MAIN)
+                back_to_main();
 
-        if (lvgl_rc_queue != NULL)
-        {
-            if (xQueueReceive(lvgl_rc_queue, &lvgl_rc_value, 0) == pdPASS)
+            // 数据屏不在前台时不读，切回来的第一帧版本号对不上自然会画
+            data_visible = lv_scr_act() == ui_DataScreen;
+            if (data_visible)
             {
-                ui_update_data_screen(lvgl_rc_value);
+                unsigned v = ctrl_state_read(&lvgl_rc_value);
+                if (v != rc_version)
+                {
+                    rc_version = v;
+                    ui_update_data_screen(&lvgl_rc_value);
+                    data_applied = true;
+                }
             }
-        }
 
-        // Lock the mutex due to the LVGL APIs are not thread-safe
-        if (example_lvgl_lock(-1))
-        {
+            // 延迟调试屏在前台时每 500ms 刷新一次
+            latency_visible = lv_scr_act() == ui_LatencyScreen;
+            if (latency_visible && lv_tick_elaps(latency_refresh_tick) >= LATENCY_SCREEN_REFRESH_MS)
+            {
+                ui_update_latency_screen();
+                latency_refresh_tick = lv_tick_get();
+            }
+            // 显示基准测试 (POST /api/display/bench)，持锁跑几秒
+            if (lcd_bench_pending())
+                lcd_bench_run();
+
+            // 没有脏区时刷新定时器暂停，lv_timer_handler 才能报出真正的下一个截止时间
+            lcd_flush_idle_update(disp);
             task_delay_ms = lv_timer_handler();
+            if (lcd_flush_idle_update(disp))
+                task_delay_ms = 0;  // 定时器回调里又标脏了，下一帧就画
             // Release the mutex
             example_lvgl_unlock();
         }
-        if (task_delay_ms > EXAMPLE_LVGL_TASK_MAX_DELAY_MS)
+        if (task_delay_ms != LV_NO_TIMER_READY && task_delay_ms < EXAMPLE_LVGL_TASK_MIN_DELAY_MS)
         {
-            task_delay_ms = EXAMPLE_LVGL_TASK_MAX_DELAY_MS;
+            task_delay_ms = EXAMPLE_LVGL_TASK_MIN_DELAY_MS;
         }
-        else if (task_delay_ms < EXAMPLE_LVGL_TASK_MIN_DELAY_MS)
+        if (latency_visible && task_delay_ms > LATENCY_SCREEN_REFRESH_MS)
         {
-            task_delay_ms = EXAMPLE_LVGL_TASK_MIN_DELAY_MS;
+            task_delay_ms = LATENCY_SCREEN_REFRESH_MS;
+        }
+
+        int64_t frame_end = esp_timer_get_time();
+        uint32_t busy_us = (uint32_t)(frame_end - frame_start);
+        frame_stats_add(busy_us, late, data_applied);
+
+        // 下一帧最早的开始时间: 帧周期和占空比上限取大的
+        int64_t gap = (int64_t)busy_us * 100 / LVGL_MAX_CPU_PERCENT;
+        next_frame_us = frame_start + (gap > LVGL_FRAME_PERIOD_US ? gap : LVGL_FRAME_PERIOD_US);
+
+        // 睡到 LVGL 下一个定时器到期 (没有定时器就一直睡，等通知)，但不早于下一帧；
+        // 睡眠中被唤醒且确实有事 (数据屏在前台或有待处理的事件) 就改成睡到下一帧，
+        // 没事的通知 (数据屏不在前台时控制数据照样 10Hz 通知) 只是接着睡，不提前开始下一帧
+        bool forever = task_delay_ms == LV_NO_TIMER_READY;
+        int64_t wake_us = forever ? INT64_MAX : frame_end + (int64_t)task_delay_ms * 1000;
+        if (wake_us < next_frame_us)
+            wake_us = next_frame_us;
+        while (1)
+        {
+            int64_t now = esp_timer_get_time();
+            if (now >= wake_us)
+                break;
+            TickType_t ticks = wake_us == INT64_MAX
+                                   ? portMAX_DELAY
+                                   : (TickType_t)((wake_us - now + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+            if (ulTaskNotifyTake(pdTRUE, ticks) == 0)
+                break;  // 超时: 节拍向上取整到 tick，不再补等零头
+            if ((data_visible || ui_work_pending()) && wake_us > next_frame_us)
+                wake_us = next_frame_us;
         }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
     }
 }
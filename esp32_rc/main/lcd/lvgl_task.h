@@ -21,8 +21,51 @@ void ui_update_reset_progress_arc(int progress);
 // void ui_load_reset_screen(void);
 // void ui_update_wrapper_async1(void *arg);
 void example_lvgl_port_task(void *arg);
+
+/**
+ * @brief 唤醒 LVGL 任务 (给 wifi_info_semaphore 之类的数据之后调用)
+ */
+void lvgl_task_wake(void);
+
+// 帧调度统计 (lvgl_task.c)
+typedef struct {
+    uint32_t frames;            // 跑过的帧数
+    uint32_t data_updates;      // 其中刷新了数据屏的帧数
+    uint32_t over_budget;       // 单帧 CPU 时间超过 LVGL_FRAME_BUDGET_US 的次数
+    uint32_t late;              // 比节拍晚一整帧以上才开始的次数
+    uint32_t last_busy_us;      // 最近一帧的 CPU 时间
+    uint32_t max_busy_us;       // 单帧 CPU 时间最大值
+    uint64_t busy_us_total;     // 累计 CPU 时间
+    uint32_t fps_x10;           // 开机以来的平均帧率 x10 (取统计时算出)
+    uint32_t cpu_permille;      // 开机以来 LVGL 任务的占空比 (千分比)
+} lvgl_frame_stats_t;
+
+/**
+ * @brief 取帧调度统计
+ */
+void lvgl_get_frame_stats(lvgl_frame_stats_t *out);
 void button_init();
 
 void ui_DataScreen_screen_init(void);
-void ui_update_data_screen(UiDataStruct data) ;
+void ui_update_data_screen(const UiDataStruct *data);
+
+// DataScreen 增量刷新的统计 (reset_ui.c)
+typedef struct {
+    uint32_t updates;           // ui_update_data_screen 调用次数
+    uint32_t labels_set;        // 文本变了、真正设置的 label 数
+    uint32_t labels_skipped;    // 文本没变、跳过的 label 数 (= 省掉的标脏次数)
+    uint64_t px_invalidated;    // 设置的 label 面积之和 (像素)
+    uint64_t px_saved;          // 跳过的 label 面积之和，即省下的刷屏像素 (估算)
+} ui_data_stats_t;
+
+/**
+ * @brief 取 DataScreen 增量刷新的统计
+ */
+void ui_get_data_stats(ui_data_stats_t *out);
+
+// 控制链路延迟调试屏 (reset_ui.c)
+#include "lvgl.h"
+extern lv_obj_t *ui_LatencyScreen;
+void ui_create_latency_screen(void);
+void ui_update_latency_screen(void);
 #endif
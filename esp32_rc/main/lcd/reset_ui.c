@@ -169,6 +169,9 @@ void ui_update_reset_progress_arc(int progress) {
 }
 
 #include "udp_task.h"
+#include "lvgl_task.h"
+#include <math.h>
+#include <string.h>
 // This file was customized for LVGL 8.3 with SquareLine style
 // Variables and function names kept exactly the same as your project
 
@@ -509,49 +512,238 @@ void ui_DataScreen_screen_init(void)
     }
 }
 
-void ui_update_data_screen(UiDataStruct data)
+// ================= DataScreen 增量刷新 =================
+// 控制数据 50Hz 进来，但大部分时候只有一两个数在变。每个 label 缓存上次显示的文本，
+// 文本没变就不调 lv_label_set_text (它每次都会重新排版并把整个 label 标脏，触发一次刷屏)。
+// 数值用定点整数格式化，不走 printf 的 %f；整个更新过程不分配内存。
+
+#define UI_LABEL_TEXT_MAX 12    // "L:-1.41" 这类最长也就 8 个字符
+
+typedef struct {
+    lv_obj_t *obj;
+    char text[UI_LABEL_TEXT_MAX];   // 上次显示的文本，空串表示还没刷过
+} ui_label_cache_t;
+
+static ui_label_cache_t lc_j1_x, lc_j1_y, lc_j1_l, lc_j1_a;
+static ui_label_cache_t lc_j2_x, lc_j2_y, lc_j2_l, lc_j2_a;
+static ui_label_cache_t lc_h1, lc_v1;
+static uint16_t shown_btn_g1, shown_btn_g2;     // 按钮 label 上显示的位图
+static bool data_screen_shown;                  // false: 下次更新全部重画
+
+static ui_data_stats_t s_data_stats;
+
+static void label_cache_bind(ui_label_cache_t *c, lv_obj_t *obj)
 {
-    char buf[32];
+    c->obj = obj;
+    c->text[0] = '\0';
+}
 
-    // J1
-    sprintf(buf, "x:%.2f", data.joystick1.x);
-    lv_label_set_text(lbl_j1_x, buf);
+// 文本真的变了才设置；跳过时按 label 当前面积记一笔省下的刷屏像素
+static void label_cache_set(ui_label_cache_t *c, const char *text, size_t len)
+{
+    uint32_t px = (uint32_t)lv_obj_get_width(c->obj) * (uint32_t)lv_obj_get_height(c->obj);
+    if (memcmp(c->text, text, len + 1) == 0)
+    {
+        s_data_stats.labels_skipped++;
+        s_data_stats.px_saved += px;
+        return;
+    }
+    memcpy(c->text, text, len + 1);
+    lv_label_set_text(c->obj, c->text);
+    s_data_stats.labels_set++;
+    s_data_stats.px_invalidated += px;
+}
 
-    sprintf(buf, "y:%.2f", data.joystick1.y);
-    lv_label_set_text(lbl_j1_y, buf);
+/**
+ * @brief 定点数格式化: value 以 10^-decimals 为单位，例如 (-52, 2) -> "-0.52"
+ *
+ * @param prefix 前缀 ("x:" 之类)，可以为 NULL
+ * @return 写入的长度 (不含 '\0')，out 至少要 UI_LABEL_TEXT_MAX 字节
+ */
+static size_t fmt_fixed(char *out, const char *prefix, int32_t value, int decimals)
+{
+    size_t n = 0;
+    if (prefix)
+        while (*prefix && n < UI_LABEL_TEXT_MAX - 8)
+            out[n++] = *prefix++;
+
+    uint32_t v = (uint32_t)value;
+    if (value < 0)
+    {
+        out[n++] = '-';
+        v = 0u - v;
+    }
+
+    char digits[10];
+    int nd = 0;
+    do {
+        digits[nd++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v && nd < (int)sizeof(digits));
+    while (nd <= decimals)          // 至少留一位整数: 5 -> "0.05"
+        digits[nd++] = '0';
+
+    while (nd > 0 && n < UI_LABEL_TEXT_MAX - 1)
+    {
+        if (nd == decimals)
+            out[n++] = '.';
+        out[n++] = digits[--nd];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// Q15 -> 0.01 单位，四舍五入。除了一处都和 "%.2f" 显示一致:
+// q = -163..-1 舍入成 0，这里显示 "0.00"，而 "%.2f" 会显示 "-0.00"，有意不保留这个负号
+static inline int32_t q15_to_centi(int32_t q)
+{
+    return (q * 100 + (q >= 0 ? UI_AXIS_SCALE / 2 : -(UI_AXIS_SCALE / 2))) / UI_AXIS_SCALE;
+}
+
+// 摇杆的长度和角度 (度) 不再随控制数据传递，显示时由 x / y 算出
+static void stick_polar(int16_t qx, int16_t qy, int32_t *len_centi, int *angle)
+{
+    float x = ui_axis(qx);
+    float y = ui_axis(qy);
+    *len_centi = (int32_t)lroundf(sqrtf(x * x + y * y) * 100.0f);
+    *angle = (x == 0.0f && y == 0.0f) ? 0 : (int)lroundf(atan2f(y, x) * (180.0f / (float)M_PI));
+}
 
-    sprintf(buf, "L:%.2f", data.joystick1.long_value);
-    lv_label_set_text(lbl_j1_l, buf);
+static void update_stick(ui_label_cache_t *lx, ui_label_cache_t *ly, ui_label_cache_t *ll, ui_label_cache_t *la,
+                         int16_t qx, int16_t qy)
+{
+    char buf[UI_LABEL_TEXT_MAX];
+    int32_t len;
+    int angle;
 
-    sprintf(buf, "A:%d", data.joystick1.angle);
-    lv_label_set_text(lbl_j1_a, buf);
+    label_cache_set(lx, buf, fmt_fixed(buf, "x:", q15_to_centi(qx), 2));
+    label_cache_set(ly, buf, fmt_fixed(buf, "y:", q15_to_centi(qy), 2));
 
-    // J2
-    sprintf(buf, "x:%.2f", data.joystick2.x);
-    lv_label_set_text(lbl_j2_x, buf);
+    stick_polar(qx, qy, &len, &angle);
+    label_cache_set(ll, buf, fmt_fixed(buf, "L:", len, 2));
+    label_cache_set(la, buf, fmt_fixed(buf, "A:", angle, 0));
+}
 
-    sprintf(buf, "y:%.2f", data.joystick2.y);
-    lv_label_set_text(lbl_j2_y, buf);
+// 按钮 label 只有 "0" / "1" 两种文本，直接比较位图，只动翻转了的那几个
+static void update_buttons(lv_obj_t **labels, uint16_t *shown, uint16_t bits, bool force)
+{
+    uint16_t changed = force ? (uint16_t)((1u << UI_BUTTON_COUNT) - 1) : (uint16_t)(*shown ^ bits);
+    for (int i = 0; i < UI_BUTTON_COUNT; i++) {
+        uint32_t px = (uint32_t)lv_obj_get_width(labels[i]) * (uint32_t)lv_obj_get_height(labels[i]);
+        if (changed & (1u << i)) {
+            lv_label_set_text_static(labels[i], ui_button(bits, i) ? "1" : "0");
+            s_data_stats.labels_set++;
+            s_data_stats.px_invalidated += px;
+        } else {
+            s_data_stats.labels_skipped++;
+            s_data_stats.px_saved += px;
+        }
+    }
+    *shown = bits;
+}
 
-    sprintf(buf, "L:%.2f", data.joystick2.long_value);
-    lv_label_set_text(lbl_j2_l, buf);
+void ui_update_data_screen(const UiDataStruct *data)
+{
+    char buf[UI_LABEL_TEXT_MAX];
+    bool force = !data_screen_shown;
 
-    sprintf(buf, "A:%d", data.joystick2.angle);
-    lv_label_set_text(lbl_j2_a, buf);
+    if (force)
+    {
+        label_cache_bind(&lc_j1_x, lbl_j1_x);
+        label_cache_bind(&lc_j1_y, lbl_j1_y);
+        label_cache_bind(&lc_j1_l, lbl_j1_l);
+        label_cache_bind(&lc_j1_a, lbl_j1_a);
+        label_cache_bind(&lc_j2_x, lbl_j2_x);
+        label_cache_bind(&lc_j2_y, lbl_j2_y);
+        label_cache_bind(&lc_j2_l, lbl_j2_l);
+        label_cache_bind(&lc_j2_a, lbl_j2_a);
+        label_cache_bind(&lc_h1, lbl_h1);
+        label_cache_bind(&lc_v1, lbl_v1);
+        data_screen_shown = true;
+    }
+    s_data_stats.updates++;
 
-    // Scrollers
-    sprintf(buf, "%.2f", data.scroller_horiz1);
-    lv_label_set_text(lbl_h1, buf);
+    update_stick(&lc_j1_x, &lc_j1_y, &lc_j1_l, &lc_j1_a, data->x1, data->y1);
+    update_stick(&lc_j2_x, &lc_j2_y, &lc_j2_l, &lc_j2_a, data->x2, data->y2);
 
-    sprintf(buf, "%.2f", data.scroller_vertical1);
-    lv_label_set_text(lbl_v1, buf);
+    // Scrollers (已经是 0.01 单位)
+    label_cache_set(&lc_h1, buf, fmt_fixed(buf, NULL, data->sc_h1, 2));
+    label_cache_set(&lc_v1, buf, fmt_fixed(buf, NULL, data->sc_v1, 2));
 
     // Buttons
-    for (int i = 0; i < 10; i++) {
-        sprintf(buf, "%d",data.button_group1[i]);
-        lv_label_set_text(lbl_b1[i], buf);
+    update_buttons(lbl_b1, &shown_btn_g1, data->btn_g1, force);
+    update_buttons(lbl_b2, &shown_btn_g2, data->btn_g2, force);
+}
 
-        sprintf(buf, "%d",data.button_group2[i]);
-        lv_label_set_text(lbl_b2[i], buf);
+void ui_get_data_stats(ui_data_stats_t *out)
+{
+    *out = s_data_stats;
+}
+
+// ================= 控制链路延迟调试屏 =================
+#include "rc_latency.h"
+
+lv_obj_t * ui_LatencyScreen = NULL;
+
+static lv_obj_t * lbl_lat[RC_LAT_STAGE_COUNT];
+static lv_obj_t * lbl_ui_stats;
+static lv_obj_t * lbl_frame_stats;
+
+void ui_create_latency_screen(void)
+{
+    ui_LatencyScreen = lv_obj_create(NULL);
+    lv_obj_clear_flag(ui_LatencyScreen, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *title = lv_label_create(ui_LatencyScreen);
+    lv_label_set_text(title, "LATENCY (us)");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_14, 0);
+    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 4);
+
+    lv_obj_t *box = lv_obj_create(ui_LatencyScreen);
+    lv_obj_set_size(box, 220, 30 + RC_LAT_STAGE_COUNT * 24);
+    lv_obj_align(box, LV_ALIGN_TOP_MID, 0, 28);
+    lv_obj_set_style_radius(box, 6, 0);
+    lv_obj_set_style_pad_all(box, 4, 0);
+
+    add_label(box, 2, 0, "      p50   p99   max");
+    for (int i = 0; i < RC_LAT_STAGE_COUNT; i++) {
+        lbl_lat[i] = add_label(box, 2, 24 + i * 24, rc_lat_stage_name(i));
     }
+
+    // DataScreen 增量刷新: 跳过的 label 比例和省下的像素 (K)
+    lbl_ui_stats = add_label(ui_LatencyScreen, 10, 0, "ui");
+    lv_obj_align_to(lbl_ui_stats, box, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 6);
+
+    // 帧调度: 平均帧率、LVGL 占空比、单帧最长 CPU 时间
+    lbl_frame_stats = add_label(ui_LatencyScreen, 10, 0, "fps");
+    lv_obj_align_to(lbl_frame_stats, lbl_ui_stats, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 4);
+}
+
+// 只在延迟屏处于前台时由 LVGL 任务周期调用
+void ui_update_latency_screen(void)
+{
+    char buf[48];
+    for (int i = 0; i < RC_LAT_STAGE_COUNT; i++) {
+        rc_lat_summary_t s;
+        rc_lat_summary(i, &s);
+        snprintf(buf, sizeof(buf), "%-5s %5lu %5lu %5lu", rc_lat_stage_name(i),
+                 (unsigned long)s.p50_us, (unsigned long)s.p99_us, (unsigned long)s.max_us);
+        lv_label_set_text(lbl_lat[i], buf);
+    }
+
+    ui_data_stats_t ui;
+    ui_get_data_stats(&ui);
+    uint32_t total = ui.labels_set + ui.labels_skipped;
+    snprintf(buf, sizeof(buf), "ui skip %lu%%  saved %lluK px",
+             (unsigned long)(total ? (uint64_t)ui.labels_skipped * 100 / total : 0),
+             (unsigned long long)(ui.px_saved / 1000));
+    lv_label_set_text(lbl_ui_stats, buf);
+
+    lvgl_frame_stats_t fr;
+    lvgl_get_frame_stats(&fr);
+    snprintf(buf, sizeof(buf), "fps %lu.%lu cpu %lu.%lu%% max %luus",
+             (unsigned long)(fr.fps_x10 / 10), (unsigned long)(fr.fps_x10 % 10),
+             (unsigned long)(fr.cpu_permille / 10), (unsigned long)(fr.cpu_permille % 10),
+             (unsigned long)fr.max_busy_us);
+    lv_label_set_text(lbl_frame_stats, buf);
 }
@@ -23,6 +23,11 @@
 #include "dns_server.h"
 
 #include "my_ota.h"
+#include "rc_latency.h"
+#include "shaping.h"
+#include "rc_log.h"
+#include "rc_record.h"
+#include "lcd_bench.h"
 
 #include "nvs_manager.h"
 #include "esp_event_base.h"
@@ -113,7 +118,7 @@ static esp_err_t root_get_handler(httpd_req_t *req)
 
 static esp_err_t api_config_post_handler(httpd_req_t *req)
 {
-    char buf[200];
+    char buf[320]; // ssid + password + dev_name + pair_key
     
     int remaining =req->content_len;
     if (remaining>=sizeof(buf))
@@ -149,6 +154,7 @@ static esp_err_t api_config_post_handler(httpd_req_t *req)
     cJSON *ssid_item = cJSON_GetObjectItem(root, "ssid");
     cJSON *pass_item = cJSON_GetObjectItem(root, "password");
     cJSON *name_item = cJSON_GetObjectItem(root, "dev_name");
+    cJSON *key_item = cJSON_GetObjectItem(root, "pair_key");
 
 
     if (cJSON_IsString(ssid_item) && ssid_item->valuestring) {
@@ -173,6 +179,16 @@ static esp_err_t api_config_post_handler(httpd_req_t *req)
     }
     app_cfg.config_done=1;
     esp_err_t err=save_config_to_nvs(&app_cfg);
+
+    // 配对密钥可选: 没填就保留原来的 (没有密钥时不允许接管)
+    if (err == ESP_OK && cJSON_IsString(key_item) && key_item->valuestring && key_item->valuestring[0] != '\0') {
+        if (strlen(key_item->valuestring) > MAX_PAIR_KEY_LEN) {
+            cJSON_Delete(root);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "pair_key too long");
+            return ESP_FAIL;
+        }
+        err = save_pair_key_to_nvs(key_item->valuestring);
+    }
     cJSON_Delete(root);
 
     if (err == ESP_OK) {
@@ -253,12 +269,65 @@ static httpd_handle_t start_webserver(void)
         httpd_register_uri_handler(server, &api_config);//api接收接口
             // ★★★ 【新增】 2. 注册 OTA 处理接口 ★★★
         register_ota_handler(server); // 注册 OTA 处理函数
+        register_log_handler(server); // GET /api/log, /api/trace (复位前的 trace 也能在配网模式下导出)
         httpd_register_err_handler(server, HTTPD_404_NOT_FOUND, http_404_error_handler);//404处理
     }
     return server;
 
 }
 
+// STA 模式下改状态接口的配对密钥 (启动 STA Web 服务时从 NVS 读取)
+static char s_sta_pair_key[MAX_PAIR_KEY_LEN + 1];
+
+bool http_check_pair_key(httpd_req_t *req)
+{
+    size_t key_len = strlen(s_sta_pair_key);
+    if (key_len == 0) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "no pairing key set");
+        return false;
+    }
+
+    char got[MAX_PAIR_KEY_LEN + 1];
+    bool ok = httpd_req_get_hdr_value_str(req, "X-Pair-Key", got, sizeof(got)) == ESP_OK && strlen(got) == key_len;
+    // 比较时不提前退出
+    uint8_t diff = 0;
+    for (size_t i = 0; ok && i < key_len; i++) {
+        diff |= (uint8_t)(got[i] ^ s_sta_pair_key[i]);
+    }
+    if (!ok || diff != 0) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "bad pairing key");
+        return false;
+    }
+    return true;
+}
+
+// STA 模式下的 Web 服务: 暴露在路由器的局域网里，不带配网页面，也不提供 OTA (只在配网热点上提供)。
+// 只读接口 (GET) 直接开放；改状态的 POST / DELETE 要带配对密钥 (http_check_pair_key)。
+void start_sta_webserver(void)
+{
+    static httpd_handle_t server = NULL;
+    if (server != NULL)
+        return; // 重新拿到 IP 时不重复启动
+
+    if (load_pair_key_from_nvs(s_sta_pair_key, sizeof(s_sta_pair_key)) != ESP_OK || s_sta_pair_key[0] == '\0')
+        ESP_LOGW(TAG, "No pairing key set, STA POST endpoints disabled");
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.lru_purge_enable = true;
+    config.max_uri_handlers = 16; // 默认 8 个不够
+
+    ESP_LOGI(TAG, "Starting STA server on port: '%d'", config.server_port);
+    if (httpd_start(&server, &config) == ESP_OK) {
+        register_latency_handler(server); // GET /api/latency
+        register_log_handler(server);     // GET /api/log, /api/trace, DELETE 需要配对密钥
+        register_shaping_handler(server); // GET /api/shaping, POST 需要配对密钥
+        register_rec_handler(server);     // GET /api/rec, /api/rec/data, POST 需要配对密钥
+        register_display_handler(server); // GET /api/display, /api/display/bench, POST 需要配对密钥
+    } else {
+        server = NULL;
+    }
+}
+
 void wifi_ap_init(void)
 {
 
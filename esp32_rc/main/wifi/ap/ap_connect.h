@@ -2,12 +2,23 @@
 #define AP_CONNECT_H
 
 
+#include <stdbool.h>
 #include "cJSON.h"
+#include "esp_http_server.h"
 #include "nvs_manager.h"
 
 
 
 void wifi_app_init();
+void start_sta_webserver(void);
+
+/**
+ * @brief STA 模式下改状态的接口 (POST) 先调用它检查配对密钥
+ *
+ * 请求头 X-Pair-Key 要和配网时设置的配对密钥一致；没有设置配对密钥时一律拒绝。
+ * 返回 false 时已经回了 403，处理函数直接返回 ESP_FAIL。
+ */
+bool http_check_pair_key(httpd_req_t *req);
 extern app_config_t my_wifi_config;
 
 
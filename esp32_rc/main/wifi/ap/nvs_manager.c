@@ -70,6 +70,85 @@ esp_err_t load_config_from_nvs(app_config_t *config)
     return ESP_OK;
 }
 
+// 辅助函数：保存一个二进制块到 NVS
+esp_err_t save_blob_to_nvs(const char *key, const void *data, size_t len)
+{
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("storage", NVS_READWRITE, &my_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_NVS, "Error (%s) opening NVS handle!", esp_err_to_name(err));
+        return err;
+    }
+
+    err = nvs_set_blob(my_handle, key, data, len);
+    if (err == ESP_OK) {
+        err = nvs_commit(my_handle);
+    }
+    nvs_close(my_handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_NVS, "Error (%s) saving blob '%s'", esp_err_to_name(err), key);
+    }
+    return err;
+}
+
+// 辅助函数：从 NVS 读取一个二进制块，长度必须和保存时一致
+esp_err_t load_blob_from_nvs(const char *key, void *data, size_t len)
+{
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("storage", NVS_READONLY, &my_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    size_t stored = 0;
+    err = nvs_get_blob(my_handle, key, NULL, &stored);
+    if (err == ESP_OK && stored != len) {
+        err = ESP_ERR_INVALID_SIZE; // 结构体改过，旧数据作废
+    }
+    if (err == ESP_OK) {
+        err = nvs_get_blob(my_handle, key, data, &stored);
+    }
+    nvs_close(my_handle);
+    return err;
+}
+
+// 辅助函数：保存配对密钥
+esp_err_t save_pair_key_to_nvs(const char *key)
+{
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("storage", NVS_READWRITE, &my_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG_NVS, "Error (%s) opening NVS handle!", esp_err_to_name(err));
+        return err;
+    }
+
+    err = nvs_set_str(my_handle, "pair_key", key);
+    if (err == ESP_OK) {
+        err = nvs_commit(my_handle);
+    }
+    nvs_close(my_handle);
+    return err;
+}
+
+// 辅助函数：读取配对密钥，没有设置过返回空字符串
+esp_err_t load_pair_key_from_nvs(char *key, size_t len)
+{
+    key[0] = '\0';
+    nvs_handle_t my_handle;
+    esp_err_t err = nvs_open("storage", NVS_READONLY, &my_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    size_t required_size = len;
+    err = nvs_get_str(my_handle, "pair_key", key, &required_size);
+    if (err != ESP_OK) {
+        key[0] = '\0';
+    }
+    nvs_close(my_handle);
+    return err;
+}
 
 esp_err_t reset_wifi_config_from_nvs()
 {
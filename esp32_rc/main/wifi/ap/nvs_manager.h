@@ -10,6 +10,7 @@
 #define MAX_SSID_LEN 32
 #define MAX_PASS_LEN 64
 #define MAX_NAME_LEN 32
+#define MAX_PAIR_KEY_LEN 64
 
 
 // 定义我们要存储的配置结构体
@@ -25,6 +26,15 @@ esp_err_t save_config_to_nvs(app_config_t *config);
 esp_err_t load_config_from_nvs(app_config_t *config);
 esp_err_t reset_wifi_config_from_nvs();
 
+// 任意定长配置 (二进制块) 的读写，同样放在 "storage" 命名空间
+esp_err_t save_blob_to_nvs(const char *key, const void *data, size_t len);
+esp_err_t load_blob_from_nvs(const char *key, void *data, size_t len);
+
+// 配对密钥 (接管控制权用的共享密钥，见 rc_session.h)，和 Wi-Fi 密码分开保存
+// 没有设置过时读出空字符串
+esp_err_t save_pair_key_to_nvs(const char *key);
+esp_err_t load_pair_key_from_nvs(char *key, size_t len);
+
 
 
 #endif
\ No newline at end of file
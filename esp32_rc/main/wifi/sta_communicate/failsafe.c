@@ -0,0 +1,116 @@
+#include "failsafe.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "udp_task.h"
+#include "uart_frame.h"
+#include "uart_tx.h"
+#include "rc_ctrl_state.h"
+#include "shaping.h"
+#include "rc_log.h"
+
+static const char *TAG = "FAILSAFE";
+
+static esp_timer_handle_t s_timer = NULL;
+static rc_failsafe_t s_fs = {0};
+static uint32_t s_max_emit_us = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// esp_timer 任务的栈很小 (默认 3.5 KB)，回调里不能调 snprintf("%f")。
+// 文本停车帧内容固定，在 failsafe_init 里预先编码好；二进制帧只有整数运算，回调里现编 (序号要递增)
+static uint8_t s_stop_text[UART_FRAME_MAX_LEN];
+static size_t s_stop_text_len = 0;
+
+static size_t encode_stop_frame(const UiDataStruct *stop, uint8_t *frame, size_t cap)
+{
+    if (UART_FRAME_MODE == UART_FRAME_MODE_BINARY)
+        return uart_frame_encode(stop, frame, cap);
+    memcpy(frame, s_stop_text, s_stop_text_len);
+    return s_stop_text_len;
+}
+
+// 在 esp_timer 任务中执行 (优先级高于 UDP 任务)
+static void failsafe_timer_cb(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&s_lock);
+    bool trip = rc_failsafe_expire(&s_fs, (uint64_t)now);
+    taskEXIT_CRITICAL(&s_lock);
+    if (!trip)
+        return;
+
+    // 直接提交给 UART 发送管线，不排队等 uart_send_task
+    UiDataStruct stop = {0};
+    uint8_t frame[UART_FRAME_MAX_LEN];
+    size_t len = encode_stop_frame(&stop, frame, sizeof(frame));
+    if (len > 0)
+        uart_tx_submit(frame, len);
+
+    // 最新控制状态也改成停车，免得还没被取走的旧指令在停车后又被发出去
+    ctrl_state_publish(&stop);
+    // 电机已经停了，恢复通信后整形 (变化率限制) 要从 0 开始
+    shaping_reset();
+
+    uint32_t emit = (uint32_t)(esp_timer_get_time() - now);
+    taskENTER_CRITICAL(&s_lock);
+    if (emit > s_max_emit_us)
+        s_max_emit_us = emit;
+    taskEXIT_CRITICAL(&s_lock);
+
+    // 在 esp_timer 任务里，控制台打印会拖慢其他定时器，限速
+    rc_blog(RC_EV_FAILSAFE, len, emit);
+    RC_LOG_RL(FAILSAFE, ESP_LOG_WARN, TAG, RC_LOG_RATE_DEFAULT, "No ctrl, motor stop (%d bytes, %luus)", (int)len, (unsigned long)emit);
+}
+
+esp_err_t failsafe_init(void)
+{
+    if (s_timer != NULL)
+        return ESP_OK;
+
+    UiDataStruct stop = {0};
+    s_stop_text_len = uart_frame_encode_text(&stop, (char *)s_stop_text, sizeof(s_stop_text));
+
+    const esp_timer_create_args_t args = {
+        .callback = &failsafe_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "rc_failsafe"};
+    return esp_timer_create(&args, &s_timer);
+}
+
+void failsafe_feed(uint32_t timeout_ms)
+{
+    if (s_timer == NULL)
+        return;
+
+    uint32_t timeout_us = timeout_ms * 1000;
+    taskENTER_CRITICAL(&s_lock);
+    rc_failsafe_arm(&s_fs, (uint64_t)esp_timer_get_time(), timeout_us);
+    taskEXIT_CRITICAL(&s_lock);
+
+    // 定时器没在运行时 restart 会返回 ESP_ERR_INVALID_STATE
+    if (esp_timer_restart(s_timer, timeout_us) != ESP_OK)
+        esp_timer_start_once(s_timer, timeout_us);
+}
+
+void failsafe_disarm(void)
+{
+    if (s_timer == NULL)
+        return;
+
+    taskENTER_CRITICAL(&s_lock);
+    rc_failsafe_disarm(&s_fs);
+    taskEXIT_CRITICAL(&s_lock);
+    esp_timer_stop(s_timer);
+}
+
+void failsafe_get_stats(failsafe_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_lock);
+    out->trips = s_fs.trips;
+    out->max_late_us = s_fs.max_late_us;
+    out->max_emit_us = s_max_emit_us;
+    taskEXIT_CRITICAL(&s_lock);
+}
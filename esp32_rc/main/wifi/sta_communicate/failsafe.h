@@ -0,0 +1,38 @@
+#ifndef FAILSAFE_H
+#define FAILSAFE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "rc_failsafe.h"
+
+/*
+ * 电机失控保护的设备端封装: esp_timer 单次定时器 + 停车帧 (判断逻辑见 rc_failsafe.h)
+ */
+
+typedef struct {
+    uint32_t trips;         // 触发次数
+    uint32_t max_late_us;   // 最大触发延迟 (定时器到期 -> 回调执行)
+    uint32_t max_emit_us;   // 最大停车帧处理时间 (回调执行 -> 提交给 uart_tx)
+} failsafe_stats_t;
+
+/**
+ * @brief 创建失控保护定时器
+ */
+esp_err_t failsafe_init(void);
+
+/**
+ * @brief 收到有效控制指令后调用，timeout_ms 之后没有再次调用就发送停车帧
+ */
+void failsafe_feed(uint32_t timeout_ms);
+
+/**
+ * @brief 停止失控保护 (会话正常结束)
+ */
+void failsafe_disarm(void);
+
+/**
+ * @brief 获取统计
+ */
+void failsafe_get_stats(failsafe_stats_t *out);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RC_CTRL_DATA_H
+#define RC_CTRL_DATA_H
+
+#include <stdint.h>
+
+/*
+ * 控制数据 (UDP -> 电机 / LVGL) 的定义
+ *
+ * 只依赖 C 标准库: 解析 (rc_packet / rc_json)、整形、UART 编码 (uart_frame / uart_sched)
+ * 这些纯逻辑模块只包含这个头文件，不再经过 udp_task.h 拉进 lwIP / Wi-Fi / FreeRTOS，
+ * 可以直接用主机上的编译器编译。
+ */
+
+// 控制数据在任务间按值传递 (队列拷贝)，所以用定点数和位图，整个结构 24 字节
+// 和原来的 double 相比有两处可见的差别:
+//   - 摇杆量化步长约 3.05e-5，UART 文本帧里 %.5f 的第 5 位小数可能和旧固件差 1~3;
+//   - 滑条是 int16，单位 0.01，只能表示 -327.67..327.67，超出的值会被限幅 (ui_quantize)。
+#define UI_AXIS_SCALE     32767 // 摇杆 Q15: 32767 对应 1.0
+#define UI_SCROLLER_SCALE 100   // 滑条 0.01 为单位
+#define UI_BUTTON_COUNT   10
+
+typedef struct UiDataStruct
+{
+    int16_t x1;          // 摇杆 1，UI_AXIS_SCALE
+    int16_t y1;
+    int16_t x2;          // 摇杆 2
+    int16_t y2;
+
+    int16_t sc_h1;       // 水平滑条，UI_SCROLLER_SCALE
+    int16_t sc_v1;       // 竖直滑条
+
+    uint16_t btn_g1;     // 按钮组 1，第 i 位对应按钮 i
+    uint16_t btn_g2;     // 按钮组 2
+
+    // 延迟统计用的时间戳 (rc_lat_now())，0 表示不统计
+    uint32_t rx_us;      // recvfrom 返回
+    uint32_t queued_us;  // 发布到 ctrl_state 完成
+}UiDataStruct;
+
+_Static_assert(sizeof(UiDataStruct) == 24, "UiDataStruct should stay compact");
+
+// 浮点 -> 定点 (四舍五入并限幅，NaN 当作 0)
+static inline int16_t ui_quantize(double v, double scale)
+{
+    double q = v * scale;
+    if (q != q)
+        return 0;
+    if (q > 32767.0)
+        q = 32767.0;
+    if (q < -32767.0)
+        q = -32767.0;
+    return (int16_t)(q >= 0 ? q + 0.5 : q - 0.5);
+}
+
+// 摇杆值，[-1, 1]
+static inline float ui_axis(int16_t v)
+{
+    return v * (1.0f / UI_AXIS_SCALE);
+}
+
+// 滑条值
+static inline float ui_scroller(int16_t v)
+{
+    return v * (1.0f / UI_SCROLLER_SCALE);
+}
+
+static inline int ui_button(uint16_t group, int i)
+{
+    return (group >> i) & 1;
+}
+
+static inline void ui_set_button(uint16_t *group, int i, int pressed)
+{
+    if (pressed)
+        *group |= (uint16_t)(1u << i);
+    else
+        *group &= (uint16_t)~(1u << i);
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "rc_ctrl_state.h"
+#include <stdlib.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "rc_seqlock.h"
+
+static const char *TAG = "CTRL_STATE";
+
+static UiDataStruct s_state;
+static rc_seqlock_t s_seq = RC_SEQLOCK_INIT;
+static portMUX_TYPE s_write_lock = portMUX_INITIALIZER_UNLOCKED;
+
+typedef struct {
+    TaskHandle_t task;
+    ctrl_sub_filter_t filter;
+    UiDataStruct last;      // 上次通知时的值
+    uint32_t last_ms;       // 上次通知的时间
+    bool pending;           // 有因为限频被推迟的变化
+} ctrl_sub_t;
+
+static ctrl_sub_t s_subs[CTRL_STATE_MAX_SUBSCRIBERS];
+static int s_sub_count = 0;
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static bool is_stop(const UiDataStruct *d)
+{
+    return d->x1 == 0 && d->y1 == 0 && d->x2 == 0 && d->y2 == 0 &&
+           d->sc_h1 == 0 && d->sc_v1 == 0 && d->btn_g1 == 0 && d->btn_g2 == 0;
+}
+
+// 和上次通知的值相比变化是否足够大
+static bool significant(const ctrl_sub_t *s, const UiDataStruct *d)
+{
+    const UiDataStruct *o = &s->last;
+    if (d->btn_g1 != o->btn_g1 || d->btn_g2 != o->btn_g2)
+        return true;
+    if (is_stop(d))
+        return !is_stop(o);
+
+    int a = s->filter.axis_delta;
+    if (abs(d->x1 - o->x1) > a || abs(d->y1 - o->y1) > a ||
+        abs(d->x2 - o->x2) > a || abs(d->y2 - o->y2) > a)
+        return true;
+    int sc = s->filter.scroller_delta;
+    return abs(d->sc_h1 - o->sc_h1) > sc || abs(d->sc_v1 - o->sc_v1) > sc;
+}
+
+// 记下这次通知的值和时间 (调用者持有 s_write_lock，通知本身在锁外发)
+static void mark_sent(ctrl_sub_t *s, uint32_t now)
+{
+    s->last = s_state;
+    s->last_ms = now;
+    s->pending = false;
+}
+
+static void notify_mask(uint32_t mask)
+{
+    for (int i = 0; mask; i++, mask >>= 1)
+    {
+        if (mask & 1u)
+            xTaskNotifyGive(s_subs[i].task);
+    }
+}
+
+void ctrl_state_publish(const UiDataStruct *data)
+{
+    uint32_t now = now_ms();
+    uint32_t mask = 0;
+
+    taskENTER_CRITICAL(&s_write_lock);
+    rc_seqlock_store(&s_seq, &s_state, data, sizeof(s_state));
+    for (int i = 0; i < s_sub_count; i++)
+    {
+        ctrl_sub_t *s = &s_subs[i];
+        if (!significant(s, &s_state))
+            continue;
+        // 停车不限频: 失控保护在定时器任务里发布，不能指望之后还有人来 flush
+        if (s->filter.min_interval_ms && now - s->last_ms < s->filter.min_interval_ms &&
+            !is_stop(&s_state))
+        {
+            s->pending = true;
+            continue;
+        }
+        mark_sent(s, now);
+        mask |= 1u << i;
+    }
+    taskEXIT_CRITICAL(&s_write_lock);
+
+    notify_mask(mask);
+}
+
+void ctrl_state_flush(uint32_t now)
+{
+    uint32_t mask = 0;
+
+    taskENTER_CRITICAL(&s_write_lock);
+    for (int i = 0; i < s_sub_count; i++)
+    {
+        ctrl_sub_t *s = &s_subs[i];
+        if (s->pending && now - s->last_ms >= s->filter.min_interval_ms)
+        {
+            mark_sent(s, now);
+            mask |= 1u << i;
+        }
+    }
+    taskEXIT_CRITICAL(&s_write_lock);
+
+    notify_mask(mask);
+}
+
+bool ctrl_state_next_flush(uint32_t *due_ms)
+{
+    bool found = false;
+    uint32_t now = now_ms();
+    uint32_t best_wait = 0;
+
+    taskENTER_CRITICAL(&s_write_lock);
+    for (int i = 0; i < s_sub_count; i++)
+    {
+        const ctrl_sub_t *s = &s_subs[i];
+        if (!s->pending)
+            continue;
+        uint32_t elapsed = now - s->last_ms;
+        uint32_t wait = elapsed >= s->filter.min_interval_ms ? 0 : s->filter.min_interval_ms - elapsed;
+        if (!found || wait < best_wait)
+            best_wait = wait;
+        found = true;
+    }
+    taskEXIT_CRITICAL(&s_write_lock);
+
+    if (found)
+        *due_ms = now + best_wait;
+    return found;
+}
+
+unsigned ctrl_state_read(UiDataStruct *out)
+{
+    return rc_seqlock_load(&s_seq, out, &s_state, sizeof(*out));
+}
+
+bool ctrl_state_subscribe(TaskHandle_t task, const ctrl_sub_filter_t *filter)
+{
+    bool ok = false;
+    taskENTER_CRITICAL(&s_write_lock);
+    if (s_sub_count < CTRL_STATE_MAX_SUBSCRIBERS)
+    {
+        ctrl_sub_t *s = &s_subs[s_sub_count];
+        s->task = task;
+        if (filter)
+            s->filter = *filter;
+        else
+            s->filter = (ctrl_sub_filter_t){0};
+        s->last = s_state;
+        s->last_ms = now_ms() - s->filter.min_interval_ms;
+        s->pending = false;
+        s_sub_count++;
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&s_write_lock);
+
+    if (!ok)
+        ESP_LOGE(TAG, "Too many subscribers");
+    return ok;
+}
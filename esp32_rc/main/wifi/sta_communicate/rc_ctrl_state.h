@@ -0,0 +1,67 @@
+#ifndef RC_CTRL_STATE_H
+#define RC_CTRL_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "rc_ctrl_data.h"
+
+/*
+ * 控制总线: 最新控制状态 + 按订阅者过滤的通知
+ *
+ * 只保存 "最新的一份" UiDataStruct，用 rc_seqlock 保护:
+ *   - 发布者 (UDP 任务、失控保护定时器) 写入后，按每个订阅者的过滤条件决定是否发任务通知;
+ *   - 读者 (UART 发送、LVGL、遥测、日志...) 不加锁、不阻塞发布者，
+ *     被通知后用 ctrl_state_read() 取最新值。
+ * 发布时在一个很短的自旋锁里拷贝 24 字节并更新订阅者状态: 既让两个发布者互斥，
+ * 也保证同核的读者不会在写到一半时被调度到而一直自旋。
+ *
+ * 过滤条件 (每个订阅者一份):
+ *   - 变化阈值: 和上次通知时的值相比，摇杆 / 滑条变化不超过阈值、按钮也没变，就不通知；
+ *     变成全 0 (停车) 总是算变化，并且不受限频约束;
+ *   - 最大频率: 离上次通知不足 min_interval_ms 的变化先记下，
+ *     到点后由 ctrl_state_flush() 补发一次 (UDP 任务的截止时间队列负责调用)。
+ * 新增消费者 (录制、遥测镜像、第二个执行器...) 只需要订阅，不用改 UDP 任务。
+ */
+#define CTRL_STATE_MAX_SUBSCRIBERS 4
+
+typedef struct {
+    uint32_t min_interval_ms;  // 两次通知的最小间隔，0 = 不限
+    uint16_t axis_delta;       // 摇杆变化阈值 (UI_AXIS_SCALE 单位)，0 = 任何变化
+    uint16_t scroller_delta;   // 滑条变化阈值 (UI_SCROLLER_SCALE 单位)
+} ctrl_sub_filter_t;
+
+/**
+ * @brief 发布一份新的控制状态，并按过滤条件通知订阅者
+ */
+void ctrl_state_publish(const UiDataStruct *data);
+
+/**
+ * @brief 读出最新的控制状态
+ *
+ * @return 版本号，每次发布都会变化；0 表示还没有发布过 (out 为全 0)
+ */
+unsigned ctrl_state_read(UiDataStruct *out);
+
+/**
+ * @brief 订阅: 满足过滤条件的发布会对 task 调用 xTaskNotifyGive
+ *
+ * 订阅者用 ulTaskNotifyTake() 等待，醒来后用 ctrl_state_read() 取最新值。
+ * @param filter NULL 表示每次变化都通知
+ * @return false 订阅者已满
+ */
+bool ctrl_state_subscribe(TaskHandle_t task, const ctrl_sub_filter_t *filter);
+
+/**
+ * @brief 补发因为限频被推迟的通知
+ */
+void ctrl_state_flush(uint32_t now_ms);
+
+/**
+ * @brief 最早一个被推迟的通知什么时候到期
+ * @return false 没有被推迟的通知
+ */
+bool ctrl_state_next_flush(uint32_t *due_ms);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef RC_DEADLINE_H
+#define RC_DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * 截止时间队列 (单任务内使用，不加锁)
+ *
+ * 一个任务里有几个 "到点要做的事" (会话超时、遥测发送...) 时，
+ * 用它算出最近的截止时间，作为 select() 的超时，所有定时工作都在同一个等待点处理。
+ * 定时器个数很少 (<= RC_DEADLINE_MAX)，直接用数组 + 位图，找最近的截止时间是 O(n) 扫描。
+ * 时间为毫秒，按 32 位回绕比较。
+ */
+#define RC_DEADLINE_MAX 8
+
+typedef struct {
+    uint32_t due_ms[RC_DEADLINE_MAX];
+    uint32_t armed;     // 第 id 位为 1 表示已设置
+} rc_deadline_queue_t;
+
+static inline bool rc_deadline_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static inline void rc_deadline_set(rc_deadline_queue_t *q, int id, uint32_t due_ms)
+{
+    q->due_ms[id] = due_ms;
+    q->armed |= 1u << id;
+}
+
+static inline void rc_deadline_cancel(rc_deadline_queue_t *q, int id)
+{
+    q->armed &= ~(1u << id);
+}
+
+static inline bool rc_deadline_is_armed(const rc_deadline_queue_t *q, int id)
+{
+    return (q->armed >> id) & 1u;
+}
+
+/**
+ * @brief 距离最近一个截止时间还有多少毫秒 (已经到期返回 0)
+ * @return false 没有任何截止时间，可以无限等待
+ */
+static inline bool rc_deadline_next(const rc_deadline_queue_t *q, uint32_t now_ms, uint32_t *wait_ms)
+{
+    bool found = false;
+    uint32_t earliest = 0;
+    for (int id = 0; id < RC_DEADLINE_MAX; id++)
+    {
+        if (!rc_deadline_is_armed(q, id))
+            continue;
+        if (!found || rc_deadline_before(q->due_ms[id], earliest))
+            earliest = q->due_ms[id];
+        found = true;
+    }
+    if (found)
+        *wait_ms = rc_deadline_before(now_ms, earliest) ? earliest - now_ms : 0;
+    return found;
+}
+
+/**
+ * @brief 取出一个已经到期的截止时间 (同时取消它)
+ * @return 到期的 id，没有返回 -1
+ */
+static inline int rc_deadline_pop(rc_deadline_queue_t *q, uint32_t now_ms)
+{
+    for (int id = 0; id < RC_DEADLINE_MAX; id++)
+    {
+        if (rc_deadline_is_armed(q, id) && !rc_deadline_before(now_ms, q->due_ms[id]))
+        {
+            rc_deadline_cancel(q, id);
+            return id;
+        }
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#include "rc_failsafe.h"
+
+void rc_failsafe_arm(rc_failsafe_t *fs, uint64_t now_us, uint32_t timeout_us)
+{
+    // 0 保留给 "未武装"
+    uint64_t deadline = now_us + timeout_us;
+    fs->deadline_us = deadline ? deadline : 1;
+}
+
+void rc_failsafe_disarm(rc_failsafe_t *fs)
+{
+    fs->deadline_us = 0;
+}
+
+bool rc_failsafe_expire(rc_failsafe_t *fs, uint64_t now_us)
+{
+    if (fs->deadline_us == 0 || now_us < fs->deadline_us)
+        return false;
+
+    uint64_t late = now_us - fs->deadline_us;
+    if (late > fs->max_late_us)
+        fs->max_late_us = late > UINT32_MAX ? UINT32_MAX : (uint32_t)late;
+    fs->trips++;
+    fs->deadline_us = 0;
+    return true;
+}
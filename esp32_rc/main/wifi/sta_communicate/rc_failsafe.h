@@ -0,0 +1,43 @@
+#ifndef RC_FAILSAFE_H
+#define RC_FAILSAFE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * 电机失控保护
+ *
+ * 每收到一条有效的控制指令就重新武装一个 esp_timer 单次定时器 (超时时间由 rc_link 自适应给出，
+ * 范围 MOTOR_FAILSAFE_MS..MOTOR_FAILSAFE_MAX_MS)。定时器到期时在 esp_timer 任务里直接编码一帧全 0 停车帧交给 uart_tx，
+ * 不经过 UDP 任务和 uart_send_task，停车不受这两个任务调度的影响。
+ * 回调在 esp_timer 任务的小栈上跑，文本停车帧在初始化时预先编码，回调里不做浮点格式化。
+ *
+ * 这里只有判断逻辑 (rc_failsafe_*)，纯函数，时间由调用者传入，可以在主机上用假时钟测试；
+ * 设备上的封装 (failsafe_*) 见 failsafe.h。
+ */
+
+typedef struct {
+    uint64_t deadline_us;   // 0 表示未武装
+    uint32_t trips;         // 触发次数
+    uint32_t max_late_us;   // 实际触发时间比期限晚的最大值
+} rc_failsafe_t;
+
+/**
+ * @brief 武装 / 重新武装: now_us + timeout_us 之后还没有被重新武装就触发
+ */
+void rc_failsafe_arm(rc_failsafe_t *fs, uint64_t now_us, uint32_t timeout_us);
+
+/**
+ * @brief 解除武装 (主动断开时用，已经发过停车指令)
+ */
+void rc_failsafe_disarm(rc_failsafe_t *fs);
+
+/**
+ * @brief 定时器到期时调用
+ *
+ * 定时器回调可能在重新武装之前就已经排队了，所以这里再和期限比一次。
+ * @return true 需要立即发送停车帧 (同时解除武装，只触发一次)
+ */
+bool rc_failsafe_expire(rc_failsafe_t *fs, uint64_t now_us);
+
+#endif
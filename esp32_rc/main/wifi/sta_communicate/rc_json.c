@@ -0,0 +1,489 @@
+#include "rc_json.h"
+#include <string.h>
+
+// 跳过未知 key 时允许的最大嵌套层数，防止恶意报文把栈打爆
+#define RC_JSON_MAX_DEPTH 8
+
+typedef struct {
+    const char *p;
+    const char *end;
+} rc_json_cursor_t;
+
+static inline void skip_ws(rc_json_cursor_t *c)
+{
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r'))
+        c->p++;
+}
+
+static inline bool expect(rc_json_cursor_t *c, char ch)
+{
+    skip_ws(c);
+    if (c->p < c->end && *c->p == ch)
+    {
+        c->p++;
+        return true;
+    }
+    return false;
+}
+
+static inline bool is_hex(char ch)
+{
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+// 读取一个字符串，返回内容起点和长度 (不含引号，保留转义)
+static bool parse_string(rc_json_cursor_t *c, const char **s, size_t *n)
+{
+    if (!expect(c, '"'))
+        return false;
+
+    const char *start = c->p;
+    while (c->p < c->end)
+    {
+        char ch = *c->p;
+        if (ch == '"')
+        {
+            *s = start;
+            *n = (size_t)(c->p - start);
+            c->p++;
+            return true;
+        }
+        if ((unsigned char)ch < 0x20)
+            return false; // 控制字符必须转义
+        if (ch == '\\')
+        {
+            if (c->end - c->p < 2)
+                return false;
+            char esc = c->p[1];
+            if (esc == 'u')
+            {
+                if (c->end - c->p < 6 || !is_hex(c->p[2]) || !is_hex(c->p[3]) || !is_hex(c->p[4]) || !is_hex(c->p[5]))
+                    return false;
+                c->p += 6;
+                continue;
+            }
+            if (!strchr("\"\\/bfnrt", esc) || esc == '\0')
+                return false;
+            c->p += 2;
+            continue;
+        }
+        c->p++;
+    }
+    return false; // 截断
+}
+
+// 10 的整数次幂，够手柄数据用 (|exp| 超出则判为非法)
+static const double pow10_table[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+};
+#define POW10_MAX ((int)(sizeof(pow10_table) / sizeof(pow10_table[0])) - 1)
+
+// 按 JSON 语法解析数字，不依赖 strtod (不需要 '\0' 结尾，也不受 locale 影响)
+static bool parse_number(rc_json_cursor_t *c, double *out)
+{
+    skip_ws(c);
+    const char *p = c->p;
+    bool neg = false;
+    uint64_t mant = 0;
+    int digits = 0;
+    int exp10 = 0;
+
+    if (p < c->end && *p == '-')
+    {
+        neg = true;
+        p++;
+    }
+    if (p >= c->end)
+        return false;
+
+    if (*p == '0')
+    {
+        p++;
+    }
+    else if (*p >= '1' && *p <= '9')
+    {
+        while (p < c->end && *p >= '0' && *p <= '9')
+        {
+            if (digits < 18)
+            {
+                mant = mant * 10 + (uint64_t)(*p - '0');
+                digits++;
+            }
+            else
+            {
+                exp10++; // 超出精度的位只计量级
+            }
+            p++;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if (p < c->end && *p == '.')
+    {
+        p++;
+        if (p >= c->end || *p < '0' || *p > '9')
+            return false;
+        while (p < c->end && *p >= '0' && *p <= '9')
+        {
+            if (digits < 18)
+            {
+                mant = mant * 10 + (uint64_t)(*p - '0');
+                digits++;
+                exp10--;
+            }
+            p++;
+        }
+    }
+
+    if (p < c->end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool eneg = false;
+        int e = 0;
+        if (p < c->end && (*p == '+' || *p == '-'))
+        {
+            eneg = (*p == '-');
+            p++;
+        }
+        if (p >= c->end || *p < '0' || *p > '9')
+            return false;
+        while (p < c->end && *p >= '0' && *p <= '9')
+        {
+            if (e < 1000)
+                e = e * 10 + (*p - '0');
+            p++;
+        }
+        exp10 += eneg ? -e : e;
+    }
+
+    double v = (double)mant;
+    if (mant != 0)
+    {
+        if (exp10 > POW10_MAX || exp10 < -2 * POW10_MAX)
+            return false;
+        if (exp10 > 0)
+            v *= pow10_table[exp10];
+        else if (exp10 < -POW10_MAX)
+            v = v / pow10_table[POW10_MAX] / pow10_table[-exp10 - POW10_MAX];
+        else if (exp10 < 0)
+            v /= pow10_table[-exp10];
+    }
+
+    *out = neg ? -v : v;
+    c->p = p;
+    return true;
+}
+
+static bool match_literal(rc_json_cursor_t *c, const char *lit)
+{
+    size_t n = strlen(lit);
+    if ((size_t)(c->end - c->p) < n || memcmp(c->p, lit, n) != 0)
+        return false;
+    c->p += n;
+    return true;
+}
+
+// 跳过任意一个值 (用于未知 key)
+static bool skip_value(rc_json_cursor_t *c, int depth)
+{
+    if (depth > RC_JSON_MAX_DEPTH)
+        return false;
+
+    skip_ws(c);
+    if (c->p >= c->end)
+        return false;
+
+    const char *s;
+    size_t n;
+    double d;
+    switch (*c->p)
+    {
+    case '"':
+        return parse_string(c, &s, &n);
+    case '{':
+        c->p++;
+        if (expect(c, '}'))
+            return true;
+        do
+        {
+            if (!parse_string(c, &s, &n) || !expect(c, ':') || !skip_value(c, depth + 1))
+                return false;
+        } while (expect(c, ','));
+        return expect(c, '}');
+    case '[':
+        c->p++;
+        if (expect(c, ']'))
+            return true;
+        do
+        {
+            if (!skip_value(c, depth + 1))
+                return false;
+        } while (expect(c, ','));
+        return expect(c, ']');
+    case 't':
+        return match_literal(c, "true");
+    case 'f':
+        return match_literal(c, "false");
+    case 'n':
+        return match_literal(c, "null");
+    default:
+        return parse_number(c, &d);
+    }
+}
+
+// 数值字段: 非数字的值 (字符串、null...) 也合法，但视为不存在
+static bool parse_number_field(rc_json_cursor_t *c, double *dst, uint32_t flag, uint32_t *present)
+{
+    skip_ws(c);
+    if (c->p < c->end && (*c->p == '-' || (*c->p >= '0' && *c->p <= '9')))
+    {
+        if (!parse_number(c, dst))
+            return false;
+        *present |= flag;
+        return true;
+    }
+    return skip_value(c, 1);
+}
+
+static bool parse_buttons(rc_json_cursor_t *c, rc_json_msg_t *out)
+{
+    skip_ws(c);
+    if (c->p >= c->end || *c->p != '[')
+        return skip_value(c, 1);
+    c->p++;
+
+    out->present |= RC_JSON_HAS_BTN_G1;
+    if (expect(c, ']'))
+        return true;
+
+    int i = 0;
+    do
+    {
+        skip_ws(c);
+        double v = 0;
+        if (c->p < c->end && (*c->p == '-' || (*c->p >= '0' && *c->p <= '9')))
+        {
+            if (!parse_number(c, &v))
+                return false;
+        }
+        else if (!skip_value(c, 2))
+        {
+            return false;
+        }
+        // 只关心按下与否；不能直接转 int，1e18 这种值转换是未定义行为
+        if (i < RC_JSON_MAX_BUTTONS)
+            out->btn_g1[i] = v != 0;
+        i++;
+    } while (expect(c, ','));
+
+    out->btn_g1_count = i < RC_JSON_MAX_BUTTONS ? i : RC_JSON_MAX_BUTTONS;
+    return expect(c, ']');
+}
+
+#define KEY_IS(lit) (klen == sizeof(lit) - 1 && memcmp(key, lit, sizeof(lit) - 1) == 0)
+
+static rc_cmd_t classify_cmd(const char *s, size_t n)
+{
+    if (n == 4 && memcmp(s, "ctrl", 4) == 0)
+        return RC_CMD_CTRL;
+    if (n == 7 && memcmp(s, "connect", 7) == 0)
+        return RC_CMD_CONNECT;
+    if (n == 10 && memcmp(s, "disconnect", 10) == 0)
+        return RC_CMD_DISCONNECT;
+    if (n == 8 && memcmp(s, "takeover", 8) == 0)
+        return RC_CMD_TAKEOVER;
+    return RC_CMD_UNKNOWN;
+}
+
+bool rc_json_parse(const char *buf, size_t len, rc_json_msg_t *out)
+{
+    rc_json_cursor_t c = {.p = buf, .end = buf + len};
+    memset(out, 0, sizeof(*out));
+
+    if (!expect(&c, '{'))
+        return false;
+
+    if (!expect(&c, '}'))
+    {
+        do
+        {
+            const char *key;
+            size_t klen;
+            if (!parse_string(&c, &key, &klen) || !expect(&c, ':'))
+                return false;
+
+            bool ok;
+            if (KEY_IS("cmd"))
+            {
+                skip_ws(&c);
+                if (c.p < c.end && *c.p == '"')
+                {
+                    const char *s = NULL;
+                    size_t n = 0;
+                    ok = parse_string(&c, &s, &n);
+                    if (ok)
+                        out->cmd = classify_cmd(s, n);
+                }
+                else
+                {
+                    ok = skip_value(&c, 1);
+                }
+            }
+            else if (KEY_IS("x1"))
+                ok = parse_number_field(&c, &out->x1, RC_JSON_HAS_X1, &out->present);
+            else if (KEY_IS("y1"))
+                ok = parse_number_field(&c, &out->y1, RC_JSON_HAS_Y1, &out->present);
+            else if (KEY_IS("x2"))
+                ok = parse_number_field(&c, &out->x2, RC_JSON_HAS_X2, &out->present);
+            else if (KEY_IS("y2"))
+                ok = parse_number_field(&c, &out->y2, RC_JSON_HAS_Y2, &out->present);
+            else if (KEY_IS("sc_h1"))
+                ok = parse_number_field(&c, &out->sc_h1, RC_JSON_HAS_SC_H1, &out->present);
+            else if (KEY_IS("sc_v1"))
+                ok = parse_number_field(&c, &out->sc_v1, RC_JSON_HAS_SC_V1, &out->present);
+            else if (KEY_IS("seq"))
+            {
+                double seq = 0;
+                ok = parse_number_field(&c, &seq, RC_JSON_HAS_SEQ, &out->present);
+                if (seq >= 0 && seq < 4294967296.0)
+                    out->seq = (uint16_t)(uint32_t)seq;
+                else
+                    out->present &= ~RC_JSON_HAS_SEQ;
+            }
+            else if (KEY_IS("prio"))
+            {
+                double prio = 0;
+                ok = parse_number_field(&c, &prio, RC_JSON_HAS_PRIO, &out->present);
+                if (prio >= 0 && prio < 256)
+                    out->prio = (uint8_t)prio;
+                else
+                    out->present &= ~RC_JSON_HAS_PRIO;
+            }
+            else if (KEY_IS("btn_g1"))
+                ok = parse_buttons(&c, out);
+            else if (KEY_IS("device"))
+            {
+                skip_ws(&c);
+                if (c.p < c.end && *c.p == '"')
+                {
+                    ok = parse_string(&c, &out->device, &out->device_len);
+                    out->present |= RC_JSON_HAS_DEVICE;
+                }
+                else
+                {
+                    ok = skip_value(&c, 1);
+                }
+            }
+            else if (KEY_IS("auth"))
+            {
+                skip_ws(&c);
+                if (c.p < c.end && *c.p == '"')
+                {
+                    ok = parse_string(&c, &out->auth, &out->auth_len);
+                    out->present |= RC_JSON_HAS_AUTH;
+                }
+                else
+                {
+                    ok = skip_value(&c, 1);
+                }
+            }
+            else if (KEY_IS("role"))
+            {
+                skip_ws(&c);
+                if (c.p < c.end && *c.p == '"')
+                {
+                    const char *s = NULL;
+                    size_t n = 0;
+                    ok = parse_string(&c, &s, &n);
+                    if (ok && n == 9 && memcmp(s, "spectator", 9) == 0)
+                        out->present |= RC_JSON_SPECTATE;
+                }
+                else
+                {
+                    ok = skip_value(&c, 1);
+                }
+            }
+            else
+                ok = skip_value(&c, 1);
+
+            if (!ok)
+                return false;
+        } while (expect(&c, ','));
+
+        if (!expect(&c, '}'))
+            return false;
+    }
+
+    // 对象后面只允许空白 (以及 rx_buffer 末尾补的 '\0')
+    skip_ws(&c);
+    while (c.p < c.end && *c.p == '\0')
+        c.p++;
+    return c.p == c.end;
+}
+
+void rc_json_copy_string(char *dst, size_t dst_size, const char *src, size_t src_len)
+{
+    if (dst_size == 0)
+        return;
+
+    size_t o = 0;
+    for (size_t i = 0; i < src_len && o + 1 < dst_size; i++)
+    {
+        char ch = src[i];
+        if (ch == '\\' && i + 1 < src_len)
+        {
+            char esc = src[++i];
+            switch (esc)
+            {
+            case 'b': ch = '\b'; break;
+            case 'f': ch = '\f'; break;
+            case 'n': ch = '\n'; break;
+            case 'r': ch = '\r'; break;
+            case 't': ch = '\t'; break;
+            case 'u':
+                ch = '?';
+                i += (i + 4 < src_len) ? 4 : src_len - i - 1;
+                break;
+            default: ch = esc; break;
+            }
+        }
+        dst[o++] = ch;
+    }
+    dst[o] = '\0';
+}
+
+void rc_json_to_ctrl(const rc_json_msg_t *msg, UiDataStruct *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    // joystick1
+    if ((msg->present & (RC_JSON_HAS_X1 | RC_JSON_HAS_Y1)) == (RC_JSON_HAS_X1 | RC_JSON_HAS_Y1))
+    {
+        out->x1 = ui_quantize(msg->x1, UI_AXIS_SCALE);
+        out->y1 = ui_quantize(msg->y1, UI_AXIS_SCALE);
+    }
+
+    // joystick2
+    if ((msg->present & (RC_JSON_HAS_X2 | RC_JSON_HAS_Y2)) == (RC_JSON_HAS_X2 | RC_JSON_HAS_Y2))
+    {
+        out->x2 = ui_quantize(msg->x2, UI_AXIS_SCALE);
+        out->y2 = ui_quantize(msg->y2, UI_AXIS_SCALE);
+    }
+
+    // scroller
+    if (msg->present & RC_JSON_HAS_SC_H1)
+        out->sc_h1 = ui_quantize(msg->sc_h1, UI_SCROLLER_SCALE);
+    if (msg->present & RC_JSON_HAS_SC_V1)
+        out->sc_v1 = ui_quantize(msg->sc_v1, UI_SCROLLER_SCALE);
+
+    // button group 1 (缺省的按钮已经填 0)
+    if (msg->present & RC_JSON_HAS_BTN_G1)
+    {
+        for (int i = 0; i < UI_BUTTON_COUNT; i++)
+            ui_set_button(&out->btn_g1, i, msg->btn_g1[i]);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef RC_JSON_H
+#define RC_JSON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_ctrl_data.h"
+
+/*
+ * UDP 指令专用的 JSON 解析器
+ *
+ * 手机发来的都是一层的小对象，例如:
+ *   {"cmd":"ctrl","seq":42,"x1":0.1,"y1":-0.2,"x2":0,"y2":0,"sc_h1":0,"sc_v1":0,"btn_g1":[0,1,0]}
+ * 这里一次扫描 rx_buffer，只提取已知的 key，其它 key 的值直接跳过。
+ * 不分配内存，字符串值只记录指向 rx_buffer 的指针和长度 (原始内容，未反转义)。
+ * 任何语法错误 (括号不配对、缺引号、截断、非法数字...) 都返回 false。
+ */
+
+#define RC_JSON_MAX_BUTTONS 10
+
+typedef enum {
+    RC_CMD_NONE = 0,     // 没有 "cmd" 或不是字符串
+    RC_CMD_UNKNOWN,      // 有 "cmd"，但不认识
+    RC_CMD_CONNECT,
+    RC_CMD_CTRL,
+    RC_CMD_DISCONNECT,
+    RC_CMD_TAKEOVER,     // 旁观者请求接管 (见 rc_session.h)
+} rc_cmd_t;
+
+// rc_json_msg_t.present 的标志位
+#define RC_JSON_HAS_X1     (1u << 0)
+#define RC_JSON_HAS_Y1     (1u << 1)
+#define RC_JSON_HAS_X2     (1u << 2)
+#define RC_JSON_HAS_Y2     (1u << 3)
+#define RC_JSON_HAS_SC_H1  (1u << 4)
+#define RC_JSON_HAS_SC_V1  (1u << 5)
+#define RC_JSON_HAS_BTN_G1 (1u << 6)
+#define RC_JSON_HAS_DEVICE (1u << 7)
+#define RC_JSON_HAS_SEQ    (1u << 8)
+#define RC_JSON_HAS_AUTH   (1u << 9)
+#define RC_JSON_SPECTATE   (1u << 10) // "role":"spectator"，只旁观
+#define RC_JSON_HAS_PRIO   (1u << 11) // 接管优先级 "prio"
+
+typedef struct {
+    rc_cmd_t cmd;
+    uint32_t present;    // RC_JSON_HAS_* 组合
+
+    double x1;
+    double y1;
+    double x2;
+    double y2;
+    double sc_h1;
+    double sc_v1;
+
+    int btn_g1[RC_JSON_MAX_BUTTONS]; // 0 / 1 (非零的数都算按下)，超出部分忽略，不足部分为 0
+    int btn_g1_count;
+
+    uint16_t seq;        // 可选的包序号，按 16 位回绕 (旧版 App 不发)
+    uint8_t prio;        // 接管优先级，0..255 以外的值视为不存在
+
+    const char *device;  // 指向输入缓冲区，未以 '\0' 结尾
+    size_t device_len;
+
+    const char *auth;    // 接管认证码 (十六进制)，同样指向输入缓冲区
+    size_t auth_len;
+} rc_json_msg_t;
+
+/**
+ * @brief 解析一条 UDP JSON 指令
+ *
+ * @param buf 输入 (不要求以 '\0' 结尾)
+ * @param len 输入长度
+ * @param out 解析结果，失败时内容未定义
+ * @return true 语法正确；false 报文非法，应直接丢弃
+ */
+bool rc_json_parse(const char *buf, size_t len, rc_json_msg_t *out);
+
+/**
+ * @brief 把解析出的字符串值 (含转义) 复制到 dst，并保证以 '\0' 结尾
+ *
+ * 只处理 \" \\ \/ \b \f \n \r \t，\uXXXX 按 '?' 输出。
+ */
+void rc_json_copy_string(char *dst, size_t dst_size, const char *src, size_t src_len);
+
+/**
+ * @brief 把 "ctrl" 指令转换成 UiDataStruct (缺少的字段为 0，时间戳不填)
+ */
+void rc_json_to_ctrl(const rc_json_msg_t *msg, UiDataStruct *out);
+
+#endif
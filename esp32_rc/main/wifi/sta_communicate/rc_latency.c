@@ -0,0 +1,183 @@
+#include "rc_latency.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "uart_send_task.h"
+
+static const char *TAG = "RC_LATENCY";
+
+typedef struct {
+    atomic_uint buckets[RC_LAT_BUCKETS];
+    atomic_uint max_us;
+} rc_lat_hist_t;
+
+static rc_lat_hist_t s_hist[RC_LAT_STAGE_COUNT];
+
+static const char *const s_stage_names[RC_LAT_STAGE_COUNT] = {
+    [RC_LAT_PARSE] = "parse",
+    [RC_LAT_QUEUE] = "queue",
+    [RC_LAT_UART] = "uart",
+    [RC_LAT_TOTAL] = "total",
+};
+
+uint32_t rc_lat_now(void)
+{
+    // 最低位置 1，保证不会返回 0 (0 表示 "没有时间戳")
+    return (uint32_t)esp_timer_get_time() | 1u;
+}
+
+// 0..7 直接对应，之后每个 2 倍区间分 4 个桶
+static inline unsigned bucket_of(uint32_t v)
+{
+    if (v < 8)
+        return v;
+    unsigned e = 31 - __builtin_clz(v);
+    unsigned idx = 8 + (e - 3) * 4 + ((v >> (e - 2)) & 3);
+    return idx < RC_LAT_BUCKETS ? idx : RC_LAT_BUCKETS - 1;
+}
+
+// 桶的上界 (含)，最后一个桶收容所有溢出值
+static uint32_t bucket_upper(unsigned idx)
+{
+    if (idx < 8)
+        return idx;
+    if (idx >= RC_LAT_BUCKETS - 1)
+        return UINT32_MAX;
+    unsigned e = (idx - 8) / 4 + 3;
+    unsigned sub = (idx - 8) % 4;
+    uint64_t lo = ((uint64_t)(4 + sub)) << (e - 2);
+    uint64_t hi = lo + (1ull << (e - 2)) - 1;
+    return hi > UINT32_MAX ? UINT32_MAX : (uint32_t)hi;
+}
+
+void rc_lat_record(rc_lat_stage_t stage, uint32_t start_us, uint32_t end_us)
+{
+    if (stage >= RC_LAT_STAGE_COUNT || start_us == 0)
+        return;
+
+    uint32_t d = end_us - start_us;
+    rc_lat_hist_t *h = &s_hist[stage];
+    atomic_fetch_add_explicit(&h->buckets[bucket_of(d)], 1, memory_order_relaxed);
+
+    unsigned old = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    while (d > old && !atomic_compare_exchange_weak_explicit(&h->max_us, &old, d,
+                                                             memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+void rc_lat_summary(rc_lat_stage_t stage, rc_lat_summary_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (stage >= RC_LAT_STAGE_COUNT)
+        return;
+
+    rc_lat_hist_t *h = &s_hist[stage];
+    uint32_t snap[RC_LAT_BUCKETS];
+    uint32_t total = 0;
+    for (int i = 0; i < RC_LAT_BUCKETS; i++)
+    {
+        snap[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += snap[i];
+    }
+    out->count = total;
+    out->max_us = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    if (total == 0)
+        return;
+
+    uint32_t p50_rank = (total + 1) / 2;
+    uint32_t p99_rank = total - total / 100;
+    uint32_t acc = 0;
+    bool p50_done = false;
+    for (int i = 0; i < RC_LAT_BUCKETS; i++)
+    {
+        acc += snap[i];
+        if (!p50_done && acc >= p50_rank)
+        {
+            out->p50_us = bucket_upper(i);
+            p50_done = true;
+        }
+        if (acc >= p99_rank)
+        {
+            out->p99_us = bucket_upper(i);
+            break;
+        }
+    }
+    // 桶上界可能超过实测最大值
+    if (out->p50_us > out->max_us)
+        out->p50_us = out->max_us;
+    if (out->p99_us > out->max_us)
+        out->p99_us = out->max_us;
+}
+
+void rc_lat_reset(void)
+{
+    for (int s = 0; s < RC_LAT_STAGE_COUNT; s++)
+    {
+        for (int i = 0; i < RC_LAT_BUCKETS; i++)
+            atomic_store_explicit(&s_hist[s].buckets[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&s_hist[s].max_us, 0, memory_order_relaxed);
+    }
+}
+
+const char *rc_lat_stage_name(rc_lat_stage_t stage)
+{
+    return stage < RC_LAT_STAGE_COUNT ? s_stage_names[stage] : "?";
+}
+
+// GET /api/latency
+static esp_err_t latency_get_handler(httpd_req_t *req)
+{
+    char buf[768];
+    int n = snprintf(buf, sizeof(buf), "{");
+    for (int s = 0; s < RC_LAT_STAGE_COUNT; s++)
+    {
+        rc_lat_summary_t sum;
+        rc_lat_summary(s, &sum);
+        n += snprintf(buf + n, sizeof(buf) - n,
+                      "%s\"%s\":{\"count\":%lu,\"p50_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu}",
+                      s ? "," : "", rc_lat_stage_name(s),
+                      (unsigned long)sum.count, (unsigned long)sum.p50_us,
+                      (unsigned long)sum.p99_us, (unsigned long)sum.max_us);
+    }
+
+    // UART 发送调度: 保活 / 合并 / 去重的效果
+    uart_sched_stats_t tx;
+    uart_send_get_stats(&tx);
+    n += snprintf(buf + n, sizeof(buf) - n,
+                  ",\"uart_tx\":{\"changed\":%lu,\"keepalive\":%lu,\"coalesced\":%lu,\"suppressed\":%lu,\"bytes_saved\":%lu}",
+                  (unsigned long)tx.sent_changed, (unsigned long)tx.sent_keepalive,
+                  (unsigned long)tx.coalesced, (unsigned long)tx.suppressed, (unsigned long)tx.bytes_saved);
+
+    snprintf(buf + n, sizeof(buf) - n, "}");
+
+    char query[32];
+    char val[4];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", val, sizeof(val)) == ESP_OK && val[0] == '1')
+    {
+        rc_lat_reset();
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+static const httpd_uri_t latency_uri = {
+    .uri = "/api/latency",
+    .method = HTTP_GET,
+    .handler = latency_get_handler,
+    .user_ctx = NULL};
+
+void register_latency_handler(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web Server 句柄为空，无法注册延迟统计接口");
+        return;
+    }
+    ESP_LOGI(TAG, "注册延迟统计接口: /api/latency");
+    httpd_register_uri_handler(server, &latency_uri);
+}
@@ -0,0 +1,65 @@
+#ifndef RC_LATENCY_H
+#define RC_LATENCY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_http_server.h"
+
+/*
+ * 控制链路各阶段延迟统计
+ *
+ *   recvfrom 返回 --PARSE--> ctrl_state_publish 完成 --QUEUE--> uart_send_task 取出
+ *                 --UART--> uart_write_bytes 写入驱动
+ *   TOTAL = recvfrom 返回 -> uart_write_bytes 写入驱动
+ *
+ * 时间戳取 esp_timer_get_time() 的低 32 位 (us)，只用差值，回绕无影响。
+ * 每个阶段一个对数分桶直方图 (每个 2 倍区间 4 个桶)，只做原子加，不加锁。
+ */
+typedef enum {
+    RC_LAT_PARSE = 0,
+    RC_LAT_QUEUE,
+    RC_LAT_UART,
+    RC_LAT_TOTAL,
+    RC_LAT_STAGE_COUNT,
+} rc_lat_stage_t;
+
+#define RC_LAT_BUCKETS 96
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} rc_lat_summary_t;
+
+/**
+ * @brief 当前时间戳 (us, 低 32 位，永不为 0；0 表示样本没有时间戳，记录时忽略)
+ */
+uint32_t rc_lat_now(void);
+
+/**
+ * @brief 记录一个阶段的耗时 (end - start)
+ */
+void rc_lat_record(rc_lat_stage_t stage, uint32_t start_us, uint32_t end_us);
+
+/**
+ * @brief 计算某个阶段的 p50 / p99 / max (结果是桶上界，误差 < 25%)
+ */
+void rc_lat_summary(rc_lat_stage_t stage, rc_lat_summary_t *out);
+
+/**
+ * @brief 清空所有直方图
+ */
+void rc_lat_reset(void);
+
+/**
+ * @brief 阶段名称
+ */
+const char *rc_lat_stage_name(rc_lat_stage_t stage);
+
+/**
+ * @brief 注册 GET /api/latency (JSON，带 ?reset=1 时读取后清空)
+ */
+void register_latency_handler(httpd_handle_t server);
+
+#endif
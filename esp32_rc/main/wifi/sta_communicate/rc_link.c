@@ -0,0 +1,102 @@
+#include "rc_link.h"
+#include <string.h>
+
+// 统计满这么多个间隔之前，均值还不可信
+#define RC_LINK_WARMUP_PKTS 8
+
+void rc_link_reset(rc_link_stats_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+// 更新到达间隔的均值和抖动
+static void note_arrival(rc_link_stats_t *s, uint32_t now_us)
+{
+    if (s->received > 0)
+    {
+        uint32_t gap = now_us - s->last_arrival_us;
+        if (s->received == 1)
+        {
+            s->mean_gap_us = gap;
+        }
+        else
+        {
+            int32_t d = (int32_t)(gap - s->mean_gap_us);
+            s->mean_gap_us += d / 8;
+            uint32_t dev = d < 0 ? (uint32_t)-d : (uint32_t)d;
+            s->jitter_us += ((int32_t)(dev - s->jitter_us)) / 16;
+        }
+    }
+    s->last_arrival_us = now_us;
+    s->received++;
+}
+
+bool rc_link_accept(rc_link_stats_t *s, uint16_t seq, uint32_t now_us)
+{
+    uint32_t gap_pkts = 1;
+    if (s->have_seq)
+    {
+        int16_t diff = (int16_t)(seq - s->last_seq);
+        if (diff == 0)
+        {
+            s->duplicates++;
+            return false;
+        }
+        if (diff < 0 && diff > -RC_LINK_RESYNC_WINDOW)
+        {
+            s->reordered++;
+            return false;
+        }
+        if (diff < 0 || diff >= RC_LINK_RESYNC_WINDOW)
+        {
+            // App 重启或序号被重置，不计丢包
+            s->resyncs++;
+        }
+        else
+        {
+            gap_pkts = (uint32_t)diff;
+            s->lost += gap_pkts - 1;
+        }
+    }
+
+    // 本次间隔内 gap_pkts 个包只到了 1 个
+    uint32_t sample = (gap_pkts - 1) * 1000 / gap_pkts;
+    s->loss_permille += ((int32_t)sample - (int32_t)s->loss_permille) / 8;
+
+    s->have_seq = true;
+    s->last_seq = seq;
+    note_arrival(s, now_us);
+    return true;
+}
+
+void rc_link_note_unsequenced(rc_link_stats_t *s, uint32_t now_us)
+{
+    note_arrival(s, now_us);
+}
+
+uint32_t rc_link_failsafe_ms(const rc_link_stats_t *s, uint32_t min_ms, uint32_t max_ms)
+{
+    if (s->received < RC_LINK_WARMUP_PKTS)
+        return min_ms;
+
+    // 允许连续丢 3 个包，丢包率每 10% 多容忍 1 个
+    uint32_t tolerated = 3 + s->loss_permille / 100;
+    uint64_t us = (uint64_t)s->mean_gap_us * tolerated + (uint64_t)s->jitter_us * 4;
+    uint32_t ms = (uint32_t)((us + 999) / 1000);
+
+    if (ms < min_ms)
+        return min_ms;
+    return ms > max_ms ? max_ms : ms;
+}
+
+uint32_t rc_link_session_timeout_ms(const rc_link_stats_t *s, uint32_t max_ms)
+{
+    if (s->received < RC_LINK_WARMUP_PKTS)
+        return max_ms;
+
+    // 大约 10 个失控保护周期没有消息才认为对方掉线
+    uint32_t ms = rc_link_failsafe_ms(s, 0, UINT32_MAX / 10) * 10;
+    if (ms < RC_LINK_SESSION_MIN_MS)
+        ms = RC_LINK_SESSION_MIN_MS;
+    return ms > max_ms ? max_ms : ms;
+}
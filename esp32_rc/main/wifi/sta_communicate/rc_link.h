@@ -0,0 +1,74 @@
+#ifndef RC_LINK_H
+#define RC_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * 控制链路质量统计 (每个会话一份)
+ *
+ * UDP 会乱序、丢包。每个控制包带一个 16 位序号 (二进制帧的 seq 字段，或 JSON 的 "seq")，
+ * 比上一个已接受的序号旧或相同的包直接丢弃，避免迟到的包让机器人 "回到过去"。
+ * 同时统计丢包率、乱序次数和到达间隔抖动，用来推算自适应的失控保护时间:
+ * 链路稳定时用下限 (MOTOR_FAILSAFE_MS，和原来固定的 500 ms 一样)，链路抖动/丢包时在上下限之间放宽，避免误停。
+ *
+ * 纯逻辑，不依赖 FreeRTOS，时间全部由调用者传入。
+ */
+
+// 序号跳变超过这个范围 (向前或向后) 认为是 App 重启了计数，直接重新同步
+#define RC_LINK_RESYNC_WINDOW 512
+
+// 会话超时的下限 (毫秒)，上限由调用者给出 (SESSION_TIMEOUT_MS)
+// 失控保护时间的上下限也由调用者给出 (MOTOR_FAILSAFE_MS / MOTOR_FAILSAFE_MAX_MS)
+#define RC_LINK_SESSION_MIN_MS  1500
+
+typedef struct {
+    bool have_seq;          // 是否已经收到过带序号的包
+    uint16_t last_seq;      // 最后接受的序号
+
+    uint32_t received;      // 接受的包数
+    uint32_t lost;          // 序号间隔推算出的丢包数
+    uint32_t reordered;     // 迟到 (序号比 last_seq 旧) 被丢弃的包数
+    uint32_t duplicates;    // 重复序号被丢弃的包数
+    uint32_t resyncs;       // 序号大跳变后的重新同步次数
+
+    uint32_t last_arrival_us;
+    uint32_t mean_gap_us;   // 到达间隔均值 (EWMA, 1/8)
+    uint32_t jitter_us;     // 到达间隔偏离均值的平均值 (EWMA, 1/16，参考 RFC 3550)
+    uint16_t loss_permille; // 近期丢包率 (EWMA, 1/8)，千分比
+} rc_link_stats_t;
+
+/**
+ * @brief 清空统计 (新会话建立时调用)
+ */
+void rc_link_reset(rc_link_stats_t *s);
+
+/**
+ * @brief 处理一个带序号的包
+ *
+ * @param seq    包序号
+ * @param now_us 到达时间 (us)
+ * @return true 包是新的，应当使用；false 迟到或重复，应当丢弃
+ */
+bool rc_link_accept(rc_link_stats_t *s, uint16_t seq, uint32_t now_us);
+
+/**
+ * @brief 处理一个不带序号的包 (旧版 App)，只更新到达间隔统计
+ */
+void rc_link_note_unsequenced(rc_link_stats_t *s, uint32_t now_us);
+
+/**
+ * @brief 根据当前链路统计推算电机失控保护时间 (毫秒)
+ *
+ * 大约允许连续丢 3 个包再加 4 倍抖动，丢包率越高允许得越多，
+ * 结果限制在 [min_ms, max_ms]。统计不足时返回 min_ms。
+ * 链路只能把时间放宽，不能收紧到 min_ms 以下 (见 udp_task.h 里 MOTOR_FAILSAFE_MS 的说明)。
+ */
+uint32_t rc_link_failsafe_ms(const rc_link_stats_t *s, uint32_t min_ms, uint32_t max_ms);
+
+/**
+ * @brief 推算会话超时时间 (毫秒)，不超过 max_ms
+ */
+uint32_t rc_link_session_timeout_ms(const rc_link_stats_t *s, uint32_t max_ms);
+
+#endif
@@ -0,0 +1,308 @@
+#include "rc_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "ap_connect.h"
+
+static const char *TAG = "RC_LOG";
+
+static atomic_uint s_dropped_total = 0;
+
+bool rc_log_allow(rc_log_limiter_t *rl, uint32_t *dropped)
+{
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    if (now - rl->window_ms >= 1000)
+    {
+        rl->window_ms = now;
+        rl->count = 0;
+    }
+    if (rl->count >= rl->per_sec)
+    {
+        rl->dropped++;
+        atomic_fetch_add_explicit(&s_dropped_total, 1, memory_order_relaxed);
+        return false;
+    }
+    rl->count++;
+    *dropped = rl->dropped;
+    rl->dropped = 0;
+    return true;
+}
+
+uint32_t rc_log_dropped_total(void)
+{
+    return atomic_load_explicit(&s_dropped_total, memory_order_relaxed);
+}
+
+// ================= 二进制环形日志 =================
+
+typedef struct {
+    uint32_t seq;     // 写入序号 + 1，0 表示空 / 正在写
+    uint32_t t_us;    // esp_timer 低 32 位
+    uint16_t ev;
+    uint16_t a;
+    uint32_t b;
+} rc_blog_entry_t;
+
+_Static_assert(sizeof(rc_blog_entry_t) == 16, "rc_blog_entry_t should stay 16 bytes");
+_Static_assert((RC_BLOG_ENTRIES & (RC_BLOG_ENTRIES - 1)) == 0, "RC_BLOG_ENTRIES must be a power of 2");
+
+#if RC_BLOG_ENABLE
+static const char *const s_event_names[RC_EV_COUNT] = {
+    [RC_EV_NONE] = "none",
+    [RC_EV_SESSION_OPEN] = "session_open",
+    [RC_EV_SESSION_CLOSE] = "session_close",
+    [RC_EV_SESSION_BUSY] = "session_busy",
+    [RC_EV_PKT_BAD] = "pkt_bad",
+    [RC_EV_PKT_STALE] = "pkt_stale",
+    [RC_EV_UART_TX] = "uart_tx",
+    [RC_EV_UART_DROP] = "uart_drop",
+    [RC_EV_FAILSAFE] = "failsafe",
+    [RC_EV_MOTOR_FAULT] = "motor_fault",
+    [RC_EV_TELEM_ERR] = "telem_err",
+    [RC_EV_BOOT] = "boot",
+    [RC_EV_PKT_RX] = "pkt_rx",
+    [RC_EV_OVERWRITE] = "overwrite",
+    [RC_EV_LVGL_FLUSH] = "lvgl_flush",
+    [RC_EV_BUTTON] = "button",
+    [RC_EV_SPECTATE] = "spectate",
+    [RC_EV_TAKEOVER] = "takeover",
+};
+
+#define RC_BLOG_MAGIC 0x52434C47 // "RCLG"
+
+// 复位后保留的部分 (noinit: 启动时不清零，上电时内容随机，靠 magic 判断)
+typedef struct {
+    uint32_t magic;
+    uint32_t boot_count;
+    rc_blog_entry_t ring[RC_BLOG_ENTRIES];
+} rc_blog_store_t;
+
+#if RC_BLOG_IN_PSRAM
+static EXT_RAM_NOINIT_ATTR rc_blog_store_t s_store;
+#else
+static RTC_NOINIT_ATTR rc_blog_store_t s_store;
+#endif
+
+// 写入序号放在普通内存里做原子加 (RTC 内存不保证支持原子读改写)，启动时从记录里恢复
+static atomic_uint s_head = 0;
+
+void rc_blog_init(void)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+    unsigned head = 0;
+
+    if (s_store.magic != RC_BLOG_MAGIC || reason == ESP_RST_POWERON)
+    {
+        memset(&s_store, 0, sizeof(s_store));
+        s_store.magic = RC_BLOG_MAGIC;
+    }
+    else
+    {
+        // 接着上次的序号写，放错槽位的 (复位时正在写) 记录作废
+        for (unsigned i = 0; i < RC_BLOG_ENTRIES; i++)
+        {
+            rc_blog_entry_t *e = &s_store.ring[i];
+            if (e->seq == 0)
+                continue;
+            if (((e->seq - 1) & (RC_BLOG_ENTRIES - 1)) != i || e->ev >= RC_EV_COUNT)
+                e->seq = 0;
+            else if (e->seq > head)
+                head = e->seq;
+        }
+    }
+    s_store.boot_count++;
+    atomic_store(&s_head, head);
+
+    rc_blog(RC_EV_BOOT, reason, s_store.boot_count);
+    ESP_LOGI(TAG, "Trace ring: %d entries, boot %lu, reset reason %d, resumed at %u",
+             RC_BLOG_ENTRIES, (unsigned long)s_store.boot_count, reason, head);
+}
+
+void rc_blog(rc_blog_event_t ev, uint16_t a, uint32_t b)
+{
+    // 每个写者用 fetch_add 拿到自己的槽位，互不等待；
+    // seq 先清 0 再最后写，导出时据此跳过正在写或已经被覆盖的条目
+    unsigned idx = atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed);
+    rc_blog_entry_t *e = &s_store.ring[idx & (RC_BLOG_ENTRIES - 1)];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    atomic_thread_fence(memory_order_release);
+    e->t_us = (uint32_t)esp_timer_get_time();
+    e->ev = (uint16_t)ev;
+    e->a = a;
+    e->b = b;
+    __atomic_store_n(&e->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+// 读出序号为 idx 的条目，已经被覆盖或还没写完返回 false
+static bool blog_read(unsigned idx, rc_blog_entry_t *out)
+{
+    const rc_blog_entry_t *e = &s_store.ring[idx & (RC_BLOG_ENTRIES - 1)];
+    if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != idx + 1)
+        return false;
+    out->seq = idx + 1;
+    out->t_us = e->t_us;
+    out->ev = e->ev;
+    out->a = e->a;
+    out->b = e->b;
+    atomic_thread_fence(memory_order_acquire);
+    return __atomic_load_n(&e->seq, __ATOMIC_RELAXED) == idx + 1;
+}
+
+// 当前还在环里的序号范围 [first, head)
+static unsigned blog_range(unsigned *first)
+{
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+    *first = head > RC_BLOG_ENTRIES ? head - RC_BLOG_ENTRIES : 0;
+    return head;
+}
+#endif
+
+// GET /api/log，每行: 序号 时间(us) 事件 a b
+// 只读；"# next N" 是导出时的写入位置，清空时带上它只清导出过的部分
+static esp_err_t log_get_handler(httpd_req_t *req)
+{
+    char line[96];
+    httpd_resp_set_type(req, "text/plain");
+
+    snprintf(line, sizeof(line), "# dropped_logs %lu\n", (unsigned long)rc_log_dropped_total());
+    httpd_resp_send_chunk(req, line, HTTPD_RESP_USE_STRLEN);
+
+#if RC_BLOG_ENABLE
+    unsigned first;
+    unsigned head = blog_range(&first);
+    snprintf(line, sizeof(line), "# next %u\n", head);
+    httpd_resp_send_chunk(req, line, HTTPD_RESP_USE_STRLEN);
+    for (unsigned idx = first; idx != head; idx++)
+    {
+        rc_blog_entry_t e;
+        if (!blog_read(idx, &e))
+            continue;
+        const char *name = e.ev < RC_EV_COUNT ? s_event_names[e.ev] : "?";
+        snprintf(line, sizeof(line), "%u %lu %s %u %lu\n", idx, (unsigned long)e.t_us, name,
+                 e.a, (unsigned long)e.b);
+        if (httpd_resp_send_chunk(req, line, HTTPD_RESP_USE_STRLEN) != ESP_OK)
+            return ESP_FAIL;
+    }
+#endif
+
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// DELETE /api/log[?before=N]，清空环形日志 (要配对密钥: 这是复位前的事故现场)
+// 带 before 时只清序号小于 N 的条目，导出之后新写入的保留
+static esp_err_t log_delete_handler(httpd_req_t *req)
+{
+    if (!http_check_pair_key(req))
+        return ESP_FAIL;
+
+    unsigned cleared = 0;
+#if RC_BLOG_ENABLE
+    unsigned first;
+    unsigned head = blog_range(&first);
+
+    char query[32];
+    char val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "before", val, sizeof(val)) == ESP_OK)
+    {
+        // 按回绕序号限制在 [first, head] 内: 导出过的条目已经被覆盖就什么都不清
+        unsigned before = (unsigned)strtoul(val, NULL, 10);
+        if ((int)(before - first) <= 0)
+            head = first;
+        else if ((int)(before - head) < 0)
+            head = before;
+    }
+
+    for (unsigned idx = first; idx != head; idx++)
+    {
+        if (__atomic_compare_exchange_n(&s_store.ring[idx & (RC_BLOG_ENTRIES - 1)].seq, &(uint32_t){idx + 1}, 0,
+                                        false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            cleared++;
+    }
+#endif
+
+    char resp[32];
+    snprintf(resp, sizeof(resp), "{\"cleared\":%u}", cleared);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, resp, HTTPD_RESP_USE_STRLEN);
+}
+
+// GET /api/trace，二进制 (格式见 rc_log.h)
+static esp_err_t trace_get_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"rc_trace.bin\"");
+
+    uint8_t hdr[16] = {'R', 'C', 'T', 'R'};
+    uint16_t version = RC_TRACE_FILE_VERSION;
+    uint16_t entry_size = 16;
+    uint32_t capacity = RC_BLOG_ENABLE ? RC_BLOG_ENTRIES : 0;
+    uint32_t boot_count = 0;
+#if RC_BLOG_ENABLE
+    boot_count = s_store.boot_count;
+#endif
+    memcpy(hdr + 4, &version, 2);
+    memcpy(hdr + 6, &entry_size, 2);
+    memcpy(hdr + 8, &capacity, 4);
+    memcpy(hdr + 12, &boot_count, 4);
+    if (httpd_resp_send_chunk(req, (const char *)hdr, sizeof(hdr)) != ESP_OK)
+        return ESP_FAIL;
+
+#if RC_BLOG_ENABLE
+    // 每 32 条发一块，导出期间被覆盖的条目直接跳过
+    rc_blog_entry_t chunk[32];
+    int n = 0;
+    unsigned first;
+    unsigned head = blog_range(&first);
+    for (unsigned idx = first; idx != head; idx++)
+    {
+        if (!blog_read(idx, &chunk[n]))
+            continue;
+        if (++n == sizeof(chunk) / sizeof(chunk[0]))
+        {
+            if (httpd_resp_send_chunk(req, (const char *)chunk, sizeof(chunk)) != ESP_OK)
+                return ESP_FAIL;
+            n = 0;
+        }
+    }
+    if (n > 0 && httpd_resp_send_chunk(req, (const char *)chunk, n * sizeof(chunk[0])) != ESP_OK)
+        return ESP_FAIL;
+#endif
+
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static const httpd_uri_t log_uri = {
+    .uri = "/api/log",
+    .method = HTTP_GET,
+    .handler = log_get_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t log_delete_uri = {
+    .uri = "/api/log",
+    .method = HTTP_DELETE,
+    .handler = log_delete_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t trace_uri = {
+    .uri = "/api/trace",
+    .method = HTTP_GET,
+    .handler = trace_get_handler,
+    .user_ctx = NULL};
+
+void register_log_handler(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web Server 句柄为空，无法注册日志接口");
+        return;
+    }
+    ESP_LOGI(TAG, "注册日志导出接口: /api/log, /api/trace");
+    httpd_register_uri_handler(server, &log_uri);
+    httpd_register_uri_handler(server, &log_delete_uri);
+    httpd_register_uri_handler(server, &trace_uri);
+}
@@ -0,0 +1,158 @@
+#ifndef RC_LOG_H
+#define RC_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_http_server.h"
+
+/*
+ * 控制链路 (热路径) 日志
+ *
+ * 控制帧的处理本身只要几十微秒，而控制台 UART 115200 打一行日志要几毫秒，
+ * 所以热路径上不直接用 ESP_LOGx:
+ *   1. 编译期级别: 每个模块一个 RC_LOG_LEVEL_xxx，高于它的 RC_LOG() 在编译时就被去掉，
+ *      连运行时的级别判断都没有;
+ *   2. 限速: RC_LOG_RL() 每个调用点每秒最多打印 N 条，多出来的只计数，
+ *      下次允许打印时报告丢了多少条;
+ *   3. 二进制环形日志 (trace): rc_blog() 只记录 (时间, 事件号, 两个参数) 共 16 字节，不做格式化。
+ *      稳态下热路径只写这个。环形缓冲区放在 RTC 内存 (或 PSRAM) 的 noinit 段，
+ *      软件复位 / 看门狗复位 / panic 之后内容还在，可以看到复位前最后几秒发生了什么。
+ *      GET /api/log 导出成文本，GET /api/trace 导出二进制，DELETE /api/log 清空 (要配对密钥)，
+ *      用 tools/rc_trace_decode.py 在电脑上解码。
+ */
+
+// ---------- 编译期级别 (可在编译选项里覆盖) ----------
+#ifndef RC_LOG_LEVEL_UDP
+#define RC_LOG_LEVEL_UDP      ESP_LOG_WARN   // udp_task 收包 / 会话
+#endif
+#ifndef RC_LOG_LEVEL_UART
+#define RC_LOG_LEVEL_UART     ESP_LOG_WARN   // uart_send_task / uart_tx
+#endif
+#ifndef RC_LOG_LEVEL_FAILSAFE
+#define RC_LOG_LEVEL_FAILSAFE ESP_LOG_WARN   // 失控保护
+#endif
+#ifndef RC_LOG_LEVEL_TELEM
+#define RC_LOG_LEVEL_TELEM    ESP_LOG_WARN   // 电机遥测 / UDP 遥测
+#endif
+
+// 限速日志默认每秒条数
+#define RC_LOG_RATE_DEFAULT 5
+
+#define RC_LOG_ENABLED(mod, level) ((level) <= RC_LOG_LEVEL_##mod)
+
+/**
+ * @brief 按模块的编译期级别过滤的日志
+ *
+ * 例: RC_LOG(UDP, ESP_LOG_DEBUG, "UDP", "Drop frame, err %d", res);
+ */
+#define RC_LOG(mod, level, tag, fmt, ...)                          \
+    do                                                             \
+    {                                                              \
+        if (RC_LOG_ENABLED(mod, level))                            \
+            ESP_LOG_LEVEL_LOCAL(level, tag, fmt, ##__VA_ARGS__);   \
+    } while (0)
+
+typedef struct {
+    uint32_t window_ms;   // 当前 1 秒窗口的起点
+    uint16_t count;       // 窗口内已经打印的条数
+    uint16_t per_sec;
+    uint32_t dropped;     // 上次打印之后被丢掉的条数
+} rc_log_limiter_t;
+
+#define RC_LOG_LIMITER_INIT(n) { .window_ms = 0, .count = 0, .per_sec = (n), .dropped = 0 }
+
+/**
+ * @brief 限速判断 (每个调用点一个 limiter，多个任务同时用时计数不保证精确)
+ *
+ * @param dropped 允许打印时返回之前丢掉的条数
+ */
+bool rc_log_allow(rc_log_limiter_t *rl, uint32_t *dropped);
+
+/**
+ * @brief 编译期过滤 + 每秒最多 per_sec 条
+ */
+#define RC_LOG_RL(mod, level, tag, per_sec, fmt, ...)                                          \
+    do                                                                                         \
+    {                                                                                          \
+        if (RC_LOG_ENABLED(mod, level))                                                        \
+        {                                                                                      \
+            static rc_log_limiter_t _rc_rl = RC_LOG_LIMITER_INIT(per_sec);                     \
+            uint32_t _rc_dropped;                                                              \
+            if (rc_log_allow(&_rc_rl, &_rc_dropped))                                           \
+            {                                                                                  \
+                if (_rc_dropped)                                                               \
+                    ESP_LOG_LEVEL_LOCAL(level, tag, "(%lu similar messages dropped)",          \
+                                        (unsigned long)_rc_dropped);                           \
+                ESP_LOG_LEVEL_LOCAL(level, tag, fmt, ##__VA_ARGS__);                           \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+// ---------- 二进制环形日志 ----------
+#ifndef RC_BLOG_ENABLE
+#define RC_BLOG_ENABLE 1
+#endif
+// 放在 PSRAM 需要打开 CONFIG_SPIRAM_ALLOW_NOINIT_SEG_EXTERNAL_MEMORY，可以存更多条
+#ifndef RC_BLOG_IN_PSRAM
+#define RC_BLOG_IN_PSRAM 0
+#endif
+#if RC_BLOG_IN_PSRAM
+#define RC_BLOG_ENTRIES 4096  // 2 的幂，每条 16 字节
+#else
+#define RC_BLOG_ENTRIES 256   // RTC 内存只有 8KB，占 4KB
+#endif
+
+// GET /api/trace 的二进制格式 (小端，tools/rc_trace_decode.py 解析):
+//   头 16 字节: magic "RCTR", version u16, entry_size u16, capacity u32, boot_count u32
+//   然后是记录直到结尾，从旧到新: seq u32, t_us u32, event u16, a u16, b u32
+#define RC_TRACE_FILE_VERSION 1
+
+typedef enum {
+    RC_EV_NONE = 0,
+    RC_EV_SESSION_OPEN,   // a: 端口           b: IPv4 地址
+    RC_EV_SESSION_CLOSE,  // a: 0 断开 1 超时  b: 收到的包数
+    RC_EV_SESSION_BUSY,   // a: 端口           b: 被拒绝的 IPv4 地址
+    RC_EV_PKT_BAD,        // a: rc_pkt_result_t
+    RC_EV_PKT_STALE,      // a: 包序号         b: 上一个序号
+    RC_EV_UART_TX,        // a: 帧长           b: uart_sched_action_t
+    RC_EV_UART_DROP,      // a: 帧长           b: esp_err_t
+    RC_EV_FAILSAFE,       // a: 帧长           b: 处理耗时 us
+    RC_EV_MOTOR_FAULT,    // a: 故障标志
+    RC_EV_TELEM_ERR,      // a: 第几个接收者 (0 = 控制者)  b: errno
+    RC_EV_BOOT,           // a: esp_reset_reason_t  b: 启动次数 (t_us 从这里重新计时)
+    RC_EV_PKT_RX,         // a: 长度           b: 源 IPv4 地址
+    RC_EV_OVERWRITE,      // a: 0 控制总线 1 uart_tx  b: 被覆盖的份数 / 累计次数
+    RC_EV_LVGL_FLUSH,     // a: 这一帧 flush 的块数  b: 像素数
+    RC_EV_BUTTON,         // a: button_event_t
+    RC_EV_SPECTATE,       // a: 端口           b: 旁观者 IPv4 地址
+    RC_EV_TAKEOVER,       // a: 1 成功 0 拒绝 2 优先级不够  b: 请求者 IPv4 地址
+    RC_EV_COUNT,          // 只能在末尾追加，解码工具按编号查名字
+} rc_blog_event_t;
+
+#if RC_BLOG_ENABLE
+/**
+ * @brief 启动时尽早调用: 检查上一次运行留下的记录 (上电复位时清空)，并记一条 RC_EV_BOOT
+ */
+void rc_blog_init(void);
+
+/**
+ * @brief 记录一条二进制日志，任何任务都可以调用，不加锁、不格式化
+ */
+void rc_blog(rc_blog_event_t ev, uint16_t a, uint32_t b);
+#else
+#define rc_blog_init() ((void)0)
+#define rc_blog(ev, a, b) ((void)0)
+#endif
+
+/**
+ * @brief 被限速丢掉的日志总条数
+ */
+uint32_t rc_log_dropped_total(void);
+
+/**
+ * @brief 注册 GET /api/log (文本)、DELETE /api/log (清空，要配对密钥) 和 GET /api/trace (二进制)
+ */
+void register_log_handler(httpd_handle_t server);
+
+#endif
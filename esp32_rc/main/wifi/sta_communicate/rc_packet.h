@@ -0,0 +1,95 @@
+#ifndef RC_PACKET_H
+#define RC_PACKET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_ctrl_data.h"
+
+/*
+ * 二进制控制帧 (与 JSON "ctrl" 指令并存)
+ *
+ * 手机端仍然先用 JSON 发送 "connect" 建立会话，之后可以改发这个定长二进制帧。
+ * JSON 报文总是以 '{' 开头，而二进制帧以魔数 "RC" 开头，所以 UDP 任务
+ * 只看前两个字节就能分流，不需要额外的端口。
+ *
+ * 布局 (小端, 共 24 字节):
+ *   0  magic[2]    'R' 'C'
+ *   2  version     RC_PKT_VERSION
+ *   3  flags       保留, 置 0
+ *   4  seq         uint16 序号, 每帧 +1 (回绕)
+ *   6  x1 y1 x2 y2 int16, Q15 定点: -32767..32767 对应 -1.0..1.0
+ *  14  sc_h1 sc_v1 int16, 单位 0.01 (与 UART 文本里的 %.2f 精度一致)
+ *  18  btn_g1      uint16, bit i = 按钮 i
+ *  20  btn_g2      uint16, bit i = 按钮 i
+ *  22  crc         CRC-16/CCITT-FALSE, 覆盖 0..21 字节
+ */
+#define RC_PKT_MAGIC0   'R'
+#define RC_PKT_MAGIC1   'C'
+#define RC_PKT_VERSION  1
+#define RC_PKT_SIZE     24
+
+#define RC_PKT_AXIS_SCALE     32767
+#define RC_PKT_SCROLLER_SCALE 100
+#define RC_PKT_BTN_MASK       0x03FF  // 每组 10 个按钮
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic[2];
+    uint8_t  version;
+    uint8_t  flags;
+    uint16_t seq;
+    int16_t  x1;
+    int16_t  y1;
+    int16_t  x2;
+    int16_t  y2;
+    int16_t  sc_h1;
+    int16_t  sc_v1;
+    uint16_t btn_g1;
+    uint16_t btn_g2;
+    uint16_t crc;
+} rc_ctrl_packet_t;
+
+_Static_assert(sizeof(rc_ctrl_packet_t) == RC_PKT_SIZE, "rc_ctrl_packet_t layout changed");
+// 报文直接搬进 UiDataStruct，两边的定点格式必须一致
+_Static_assert(RC_PKT_AXIS_SCALE == UI_AXIS_SCALE && RC_PKT_SCROLLER_SCALE == UI_SCROLLER_SCALE,
+               "rc packet and UiDataStruct fixed-point scales differ");
+
+typedef enum {
+    RC_PKT_OK = 0,
+    RC_PKT_ERR_LEN,      // 长度不对
+    RC_PKT_ERR_MAGIC,    // 不是二进制帧 (可能是 JSON)
+    RC_PKT_ERR_VERSION,  // 版本不支持
+    RC_PKT_ERR_CRC,      // 校验失败
+} rc_pkt_result_t;
+
+/**
+ * @brief 快速判断一段 UDP 负载是否是二进制控制帧 (只看魔数)
+ */
+static inline bool rc_packet_is_binary(const uint8_t *buf, size_t len)
+{
+    return len >= 2 && buf[0] == RC_PKT_MAGIC0 && buf[1] == RC_PKT_MAGIC1;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 查表实现
+ */
+uint16_t rc_crc16_ccitt(const uint8_t *data, size_t len);
+
+/**
+ * @brief 校验并解码一帧二进制控制数据，直接写入 UiDataStruct，不做任何堆分配
+ *
+ * @param buf  UDP 负载
+ * @param len  负载长度
+ * @param out  解码结果 (只有返回 RC_PKT_OK 时才会被写入)
+ * @param seq  可为 NULL, 返回帧序号
+ */
+rc_pkt_result_t rc_packet_decode(const uint8_t *buf, size_t len, UiDataStruct *out, uint16_t *seq);
+
+/**
+ * @brief 把 UiDataStruct 编码成二进制控制帧 (调试 / 回放工具使用)
+ *
+ * @return 写入的字节数 (RC_PKT_SIZE)，缓冲区不足时返回 0
+ */
+size_t rc_packet_encode(const UiDataStruct *in, uint16_t seq, uint8_t *buf, size_t len);
+
+#endif
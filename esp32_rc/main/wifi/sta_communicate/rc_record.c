@@ -0,0 +1,478 @@
+#include "rc_record.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/message_buffer.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "shaping.h"
+#include "ap_connect.h"
+
+static const char *TAG = "RC_REC";
+
+#define REC_FLUSH_BYTES     1024  // 攒够这么多再写 flash，减少写操作次数
+#define REC_FLUSH_MS        200   // 没攒够时最多等这么久
+#define REC_REPLAY_YIELD    256   // 最快回放时每隔多少包让出一次 CPU (避免饿死看门狗)
+#define REC_REPLAY_CORE     1
+
+static const esp_partition_t *s_part = NULL;
+static MessageBufferHandle_t s_msgbuf = NULL;
+static TaskHandle_t s_writer = NULL;
+static SemaphoreHandle_t s_flushed = NULL;
+
+static atomic_int s_state = RC_REC_IDLE;
+static atomic_bool s_capture = false;   // UDP 任务只看这一个标志
+static uint32_t s_t0_us;                // 开始录制的时间 (rc_lat_now)
+
+// 以下由录制任务写，其他任务只读
+static atomic_uint s_records = 0;
+static atomic_uint s_data_bytes = 0;
+static atomic_uint s_dropped = 0;
+static uint32_t s_last_t_us;
+
+static uint8_t s_pending[REC_FLUSH_BYTES + sizeof(rc_rec_entry_t) + RC_REC_MAX_PAYLOAD];
+static size_t s_pending_len;
+static uint32_t s_erased_end;           // [0, s_erased_end) 已擦除，只有录制任务访问
+
+static rc_rec_bench_t s_bench;          // 回放任务写，结束后才给 HTTP 读
+
+// ================= 录制 =================
+
+void rec_capture(const uint8_t *buf, size_t len, uint32_t rx_us, bool from_client)
+{
+    if (!atomic_load_explicit(&s_capture, memory_order_acquire))
+        return;
+    if (len > RC_REC_MAX_PAYLOAD)
+        len = RC_REC_MAX_PAYLOAD;
+
+    uint8_t msg[sizeof(rc_rec_entry_t) + RC_REC_MAX_PAYLOAD + 3];
+    rc_rec_entry_t e = {
+        .t_us = rx_us - s_t0_us,
+        .len = (uint16_t)len,
+        .flags = from_client ? RC_REC_FLAG_CLIENT : 0,
+    };
+    size_t total = RC_REC_ALIGN4(sizeof(e) + len);
+    memcpy(msg, &e, sizeof(e));
+    memcpy(msg + sizeof(e), buf, len);
+    memset(msg + sizeof(e) + len, 0, total - sizeof(e) - len);
+
+    // 消息缓冲区要么整条放进去，要么一点都不放；满了就丢，绝不阻塞 UDP 任务
+    if (xMessageBufferSend(s_msgbuf, msg, total, 0) != total)
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+}
+
+// 写入 [0, end) 之前按扇区擦除还没擦过的部分，一次只擦需要的几个扇区
+static esp_err_t rec_erase_until(uint32_t end)
+{
+    while (s_erased_end < end)
+    {
+        esp_err_t err = esp_partition_erase_range(s_part, s_erased_end, s_part->erase_size);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "擦除录制分区失败 @0x%lx: %s", (unsigned long)s_erased_end, esp_err_to_name(err));
+            return err;
+        }
+        s_erased_end += s_part->erase_size;
+    }
+    return ESP_OK;
+}
+
+static void rec_flush_pending(void)
+{
+    if (s_pending_len == 0)
+        return;
+    uint32_t off = RC_REC_HEADER_SIZE + atomic_load(&s_data_bytes);
+    esp_err_t err = rec_erase_until(off + s_pending_len);
+    if (err == ESP_OK)
+        err = esp_partition_write(s_part, off, s_pending, s_pending_len);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "写入录制数据失败 @0x%lx: %s", (unsigned long)off, esp_err_to_name(err));
+        atomic_fetch_add(&s_dropped, 1);
+    }
+    else
+    {
+        atomic_fetch_add(&s_data_bytes, s_pending_len);
+    }
+    s_pending_len = 0;
+}
+
+static void rec_append(const uint8_t *msg, size_t n)
+{
+    if (atomic_load(&s_state) != RC_REC_RECORDING)
+        return; // 停止之后才到的包直接丢掉
+
+    uint32_t used = RC_REC_HEADER_SIZE + atomic_load(&s_data_bytes) + s_pending_len;
+    if (used + n > s_part->size)
+    {
+        atomic_fetch_add(&s_dropped, 1); // 分区写满
+        return;
+    }
+    if (s_pending_len + n > sizeof(s_pending))
+        rec_flush_pending();
+
+    memcpy(s_pending + s_pending_len, msg, n);
+    s_pending_len += n;
+    s_last_t_us = ((const rc_rec_entry_t *)msg)->t_us;
+    atomic_fetch_add(&s_records, 1);
+
+    if (s_pending_len >= REC_FLUSH_BYTES)
+        rec_flush_pending();
+}
+
+static void rec_write_header(void)
+{
+    rc_rec_header_t h = {
+        .magic = RC_REC_MAGIC,
+        .version = RC_REC_VERSION,
+        .header_size = RC_REC_HEADER_SIZE,
+        .records = atomic_load(&s_records),
+        .data_bytes = atomic_load(&s_data_bytes),
+        .dropped = atomic_load(&s_dropped),
+        .duration_us = s_last_t_us,
+    };
+    // 一条数据都没写时第 0 个扇区还没擦
+    esp_err_t err = rec_erase_until(sizeof(h));
+    if (err == ESP_OK)
+        err = esp_partition_write(s_part, 0, &h, sizeof(h));
+    if (err != ESP_OK)
+        ESP_LOGE(TAG, "写入录制文件头失败: %s", esp_err_to_name(err));
+}
+
+// 录制任务: 把 UDP 任务送来的记录攒成块写进 flash，收到停止通知时写完剩余数据和文件头
+static void rec_writer_task(void *arg)
+{
+    uint8_t msg[sizeof(rc_rec_entry_t) + RC_REC_MAX_PAYLOAD + 3];
+    for (;;)
+    {
+        size_t n = xMessageBufferReceive(s_msgbuf, msg, sizeof(msg), pdMS_TO_TICKS(REC_FLUSH_MS));
+        if (n > 0)
+            rec_append(msg, n);
+        else
+            rec_flush_pending();
+
+        if (ulTaskNotifyTake(pdTRUE, 0))
+        {
+            while ((n = xMessageBufferReceive(s_msgbuf, msg, sizeof(msg), 0)) > 0)
+                rec_append(msg, n);
+            rec_flush_pending();
+            rec_write_header();
+            atomic_store(&s_state, RC_REC_IDLE);
+            xSemaphoreGive(s_flushed);
+        }
+    }
+}
+
+esp_err_t rec_init(void)
+{
+    if (s_part != NULL)
+        return ESP_OK;
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, RC_REC_PARTITION_LABEL);
+    if (s_part == NULL)
+    {
+        ESP_LOGW(TAG, "没有 \"%s\" 分区，录制功能不可用", RC_REC_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    s_msgbuf = xMessageBufferCreate(RC_REC_BUFFER_SIZE);
+    s_flushed = xSemaphoreCreateBinary();
+    if (s_msgbuf == NULL || s_flushed == NULL ||
+        xTaskCreate(rec_writer_task, "rec_writer", 3072, NULL, 2, &s_writer) != pdPASS)
+    {
+        ESP_LOGE(TAG, "创建录制任务失败");
+        s_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 上一次的录制还在分区里，可以直接回放 / 下载
+    rc_rec_header_t h;
+    if (esp_partition_read(s_part, 0, &h, sizeof(h)) == ESP_OK && memcmp(h.magic, RC_REC_MAGIC, 4) == 0 &&
+        h.version == RC_REC_VERSION && h.data_bytes <= s_part->size - RC_REC_HEADER_SIZE)
+    {
+        atomic_store(&s_records, h.records);
+        atomic_store(&s_data_bytes, h.data_bytes);
+        atomic_store(&s_dropped, h.dropped);
+        s_last_t_us = h.duration_us;
+    }
+    ESP_LOGI(TAG, "录制分区 %lu KB，已有 %u 条记录", (unsigned long)(s_part->size / 1024),
+             atomic_load(&s_records));
+    return ESP_OK;
+}
+
+esp_err_t rec_start(void)
+{
+    if (s_part == NULL)
+        return ESP_ERR_NOT_FOUND;
+    if (atomic_load(&s_state) != RC_REC_IDLE)
+        return ESP_ERR_INVALID_STATE;
+
+    // 不在这里整体擦除 (1MB 要好几秒，会卡住 HTTP 任务)，录制任务写到哪擦到哪。
+    // 第 0 个扇区 (旧的文件头) 在第一次写入时被擦掉，之前重启的话旧录制仍然完整可用
+    s_erased_end = 0;
+    atomic_store(&s_records, 0);
+    atomic_store(&s_data_bytes, 0);
+    atomic_store(&s_dropped, 0);
+    s_last_t_us = 0;
+    s_pending_len = 0;
+    s_t0_us = (uint32_t)esp_timer_get_time();
+    atomic_store(&s_state, RC_REC_RECORDING);
+    atomic_store_explicit(&s_capture, true, memory_order_release);
+    ESP_LOGI(TAG, "开始录制");
+    return ESP_OK;
+}
+
+esp_err_t rec_stop(void)
+{
+    if (atomic_load(&s_state) != RC_REC_RECORDING)
+        return ESP_ERR_INVALID_STATE;
+
+    atomic_store(&s_capture, false);
+    xSemaphoreTake(s_flushed, 0);
+    xTaskNotifyGive(s_writer);
+    if (xSemaphoreTake(s_flushed, pdMS_TO_TICKS(2000)) != pdTRUE)
+    {
+        ESP_LOGE(TAG, "等待录制数据写完超时");
+        return ESP_ERR_TIMEOUT;
+    }
+    ESP_LOGI(TAG, "停止录制: %u 条, %u 字节, 丢弃 %u 条", atomic_load(&s_records),
+             atomic_load(&s_data_bytes), atomic_load(&s_dropped));
+    return ESP_OK;
+}
+
+// ================= 回放 =================
+
+static uint32_t cycle_clock(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static void replay_task(void *arg)
+{
+    bool realtime = (bool)(uintptr_t)arg;
+    rc_rec_bench_t b = {.realtime = realtime};
+
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    shaping_get_params(params);
+    static rc_replay_t r; // 带一个 UART 帧缓冲区，不放在回放任务的栈上
+    rc_replay_init(&r, params, UART_FRAME_MODE == UART_FRAME_MODE_BINARY, cycle_clock);
+
+    uint8_t payload[RC_REC_MAX_PAYLOAD];
+    const uint32_t end = RC_REC_HEADER_SIZE + atomic_load(&s_data_bytes);
+    uint32_t off = RC_REC_HEADER_SIZE;
+    int64_t start_us = esp_timer_get_time();
+
+    while (off + sizeof(rc_rec_entry_t) <= end)
+    {
+        rc_rec_entry_t e;
+        if (esp_partition_read(s_part, off, &e, sizeof(e)) != ESP_OK || e.len > RC_REC_MAX_PAYLOAD ||
+            off + sizeof(e) + e.len > end ||
+            esp_partition_read(s_part, off + sizeof(e), payload, e.len) != ESP_OK)
+        {
+            ESP_LOGW(TAG, "回放在 0x%lx 处遇到损坏的记录，提前结束", (unsigned long)off);
+            break;
+        }
+        off += RC_REC_ALIGN4(sizeof(e) + e.len);
+
+        if (realtime)
+        {
+            int64_t due = start_us + e.t_us;
+            int64_t wait = due - esp_timer_get_time();
+            if (wait >= 1000 * portTICK_PERIOD_MS)
+                vTaskDelay(pdMS_TO_TICKS(wait / 1000));
+        }
+        else if (r.stats.packets % REC_REPLAY_YIELD == REC_REPLAY_YIELD - 1)
+        {
+            vTaskDelay(1);
+        }
+        rc_replay_packet(&r, &e, payload);
+    }
+
+    b.stats = r.stats;
+    b.wall_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_bench = b;
+    atomic_store(&s_state, RC_REC_IDLE);
+    ESP_LOGI(TAG, "回放结束: %lu 包 (控制 %lu, 非会话 %lu, 过时 %lu)，用时 %lu ms", (unsigned long)b.stats.packets,
+             (unsigned long)b.stats.ctrl, (unsigned long)b.stats.not_client, (unsigned long)b.stats.stale,
+             (unsigned long)(b.wall_us / 1000));
+    vTaskDelete(NULL);
+}
+
+esp_err_t rec_replay_start(bool realtime)
+{
+    if (s_part == NULL)
+        return ESP_ERR_NOT_FOUND;
+    int expected = RC_REC_IDLE;
+    if (!atomic_compare_exchange_strong(&s_state, &expected, RC_REC_REPLAYING))
+        return ESP_ERR_INVALID_STATE;
+    if (atomic_load(&s_records) == 0)
+    {
+        atomic_store(&s_state, RC_REC_IDLE);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 固定在一个核上，周期计数才可比
+    if (xTaskCreatePinnedToCore(replay_task, "rec_replay", 4096, (void *)(uintptr_t)realtime, 2, NULL,
+                                REC_REPLAY_CORE) != pdPASS)
+    {
+        atomic_store(&s_state, RC_REC_IDLE);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void rec_get_status(rc_rec_status_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->state = (rc_rec_state_t)atomic_load(&s_state);
+    out->records = atomic_load(&s_records);
+    out->data_bytes = atomic_load(&s_data_bytes);
+    out->dropped = atomic_load(&s_dropped);
+    out->capacity = s_part ? s_part->size : 0;
+    if (out->state != RC_REC_REPLAYING)
+        out->bench = s_bench;
+}
+
+// ================= HTTP =================
+
+static const char *const s_state_names[] = {"idle", "recording", "replaying"};
+
+// 平均每包的周期数和微秒数
+static int bench_json(char *buf, size_t size, const char *name, uint64_t cycles, uint32_t max_cycles, uint32_t n)
+{
+    const uint32_t mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    double avg = n ? (double)cycles / n : 0;
+    return snprintf(buf, size, ",\"%s\":{\"avg_cycles\":%.0f,\"avg_us\":%.2f,\"max_cycles\":%lu}", name, avg,
+                    avg / mhz, (unsigned long)max_cycles);
+}
+
+// GET /api/rec
+static esp_err_t rec_get_handler(httpd_req_t *req)
+{
+    rc_rec_status_t st;
+    rec_get_status(&st);
+
+    char buf[640];
+    int n = snprintf(buf, sizeof(buf),
+                     "{\"state\":\"%s\",\"records\":%lu,\"bytes\":%lu,\"dropped\":%lu,\"capacity\":%lu",
+                     s_state_names[st.state], (unsigned long)st.records, (unsigned long)st.data_bytes,
+                     (unsigned long)st.dropped, (unsigned long)st.capacity);
+    const rc_replay_stats_t *b = &st.bench.stats;
+    if (b->packets > 0)
+    {
+        n += snprintf(buf + n, sizeof(buf) - n,
+                      ",\"replay\":{\"realtime\":%s,\"packets\":%lu,\"parse_ok\":%lu,\"ctrl\":%lu,"
+                      "\"not_client\":%lu,\"stale\":%lu,\"wall_us\":%lu",
+                      st.bench.realtime ? "true" : "false", (unsigned long)b->packets, (unsigned long)b->parse_ok,
+                      (unsigned long)b->ctrl, (unsigned long)b->not_client, (unsigned long)b->stale,
+                      (unsigned long)st.bench.wall_us);
+        n += bench_json(buf + n, sizeof(buf) - n, "parse", b->parse_ticks, b->parse_max_ticks, b->packets);
+        n += bench_json(buf + n, sizeof(buf) - n, "shape", b->shape_ticks, 0, b->ctrl);
+        n += bench_json(buf + n, sizeof(buf) - n, "encode", b->encode_ticks, b->encode_max_ticks, b->ctrl);
+        n += snprintf(buf + n, sizeof(buf) - n, "}");
+    }
+    snprintf(buf + n, sizeof(buf) - n, "}");
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+// POST /api/rec?cmd=start|stop|replay|replay_rt
+static esp_err_t rec_post_handler(httpd_req_t *req)
+{
+    if (!http_check_pair_key(req))
+        return ESP_FAIL;
+
+    char query[32];
+    char cmd[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "cmd", cmd, sizeof(cmd)) != ESP_OK)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "missing cmd");
+        return ESP_FAIL;
+    }
+
+    esp_err_t err;
+    if (strcmp(cmd, "start") == 0)
+        err = rec_start();
+    else if (strcmp(cmd, "stop") == 0)
+        err = rec_stop();
+    else if (strcmp(cmd, "replay") == 0)
+        err = rec_replay_start(false);
+    else if (strcmp(cmd, "replay_rt") == 0)
+        err = rec_replay_start(true);
+    else
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "unknown cmd");
+        return ESP_FAIL;
+    }
+
+    if (err != ESP_OK)
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_send(req, esp_err_to_name(err), HTTPD_RESP_USE_STRLEN);
+    }
+    return rec_get_handler(req);
+}
+
+// GET /api/rec/data，文件头 + 记录，原样导出
+static esp_err_t rec_data_handler(httpd_req_t *req)
+{
+    if (s_part == NULL || atomic_load(&s_state) == RC_REC_RECORDING)
+    {
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"rc_rec.bin\"");
+
+    char chunk[1024];
+    uint32_t end = RC_REC_HEADER_SIZE + atomic_load(&s_data_bytes);
+    for (uint32_t off = 0; off < end; off += sizeof(chunk))
+    {
+        size_t n = end - off < sizeof(chunk) ? end - off : sizeof(chunk);
+        if (esp_partition_read(s_part, off, chunk, n) != ESP_OK ||
+            httpd_resp_send_chunk(req, chunk, n) != ESP_OK)
+            return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static const httpd_uri_t rec_get_uri = {
+    .uri = "/api/rec",
+    .method = HTTP_GET,
+    .handler = rec_get_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t rec_post_uri = {
+    .uri = "/api/rec",
+    .method = HTTP_POST,
+    .handler = rec_post_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t rec_data_uri = {
+    .uri = "/api/rec/data",
+    .method = HTTP_GET,
+    .handler = rec_data_handler,
+    .user_ctx = NULL};
+
+void register_rec_handler(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web Server 句柄为空，无法注册录制接口");
+        return;
+    }
+    ESP_LOGI(TAG, "注册录制 / 回放接口: /api/rec, /api/rec/data");
+    httpd_register_uri_handler(server, &rec_get_uri);
+    httpd_register_uri_handler(server, &rec_post_uri);
+    httpd_register_uri_handler(server, &rec_data_uri);
+}
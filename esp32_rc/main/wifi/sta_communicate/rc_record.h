@@ -0,0 +1,85 @@
+#ifndef RC_RECORD_H
+#define RC_RECORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "rc_replay.h"
+
+/*
+ * 控制会话录制 / 回放
+ *
+ * 录制: udp_server_task 收到的每个 UDP 负载 (原样) 连同接收时间写进 "rcrec" 数据分区。
+ *   UDP 任务只把数据拷进一个消息缓冲区 (不阻塞，满了就丢并计数)，
+ *   由低优先级的录制任务写 flash。分区不在开始时整体擦除，录制任务写到哪个扇区才擦哪个扇区
+ *   (每次一个 4 KB 扇区，几十毫秒)，HTTP 请求立即返回。
+ *
+ * 回放: 从分区读出录下的负载，按 实时 / 最快 两种速度送进 rc_replay 的流水线
+ *   (解析 -> 整形 -> UART 编码，过滤规则和分区格式见 rc_replay.h)，
+ *   用 CPU 周期计数统计每一级的耗时。回放不发布控制状态、不写 UART，不会动电机，
+ *   可以用真实流量对比解析器 / 编码器优化前后的差别。
+ *
+ * GET /api/rec/data 下载原始数据，tools/rc_rec_dump.py 可以解出每一包，
+ * host_test/rc_replay_host 可以在电脑上跑同样的回放。
+ */
+#define RC_REC_PARTITION_LABEL "rcrec"
+#define RC_REC_BUFFER_SIZE     4096  // UDP 任务 -> 录制任务的消息缓冲区
+
+typedef enum {
+    RC_REC_IDLE = 0,
+    RC_REC_RECORDING,
+    RC_REC_REPLAYING,
+} rc_rec_state_t;
+
+typedef struct {
+    rc_replay_stats_t stats; // 计数单位是 CPU 周期
+    uint32_t wall_us;        // 回放总耗时
+    bool realtime;
+} rc_rec_bench_t;
+
+typedef struct {
+    rc_rec_state_t state;
+    uint32_t records;
+    uint32_t data_bytes;
+    uint32_t dropped;        // 流缓冲满 / 分区写满丢掉的包
+    uint32_t capacity;       // 分区大小
+    rc_rec_bench_t bench;    // 最近一次回放的结果
+} rc_rec_status_t;
+
+/**
+ * @brief 查找分区并创建录制任务 (没有 rcrec 分区时返回 ESP_ERR_NOT_FOUND，录制功能不可用)
+ */
+esp_err_t rec_init(void);
+
+/**
+ * @brief 开始录制 (不擦除，扇区由录制任务在写入前擦除)
+ */
+esp_err_t rec_start(void);
+
+/**
+ * @brief 停止录制，写入文件头
+ */
+esp_err_t rec_stop(void);
+
+/**
+ * @brief 在 UDP 任务里对每个收到的包调用；没在录制时只是一次原子读
+ */
+void rec_capture(const uint8_t *buf, size_t len, uint32_t rx_us, bool from_client);
+
+/**
+ * @brief 在后台任务里回放最近一次录制，结果通过 rec_get_status 获取
+ *
+ * @param realtime true 按录制时的时间间隔回放，false 尽快回放
+ */
+esp_err_t rec_replay_start(bool realtime);
+
+void rec_get_status(rc_rec_status_t *out);
+
+/**
+ * @brief 注册 GET/POST /api/rec 和 GET /api/rec/data (POST 检查配对密钥)
+ */
+void register_rec_handler(httpd_handle_t server);
+
+#endif
@@ -0,0 +1,105 @@
+#include "rc_replay.h"
+#include <string.h>
+#include "rc_packet.h"
+#include "rc_json.h"
+
+void rc_replay_init(rc_replay_t *r, const rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT], bool binary,
+                    rc_replay_clock_t clock)
+{
+    memset(r, 0, sizeof(*r));
+    r->clock = clock;
+    r->binary = binary;
+    rc_link_reset(&r->link);
+    memcpy(r->params, params, sizeof(r->params));
+}
+
+bool rc_replay_packet(rc_replay_t *r, const rc_rec_entry_t *e, const uint8_t *payload)
+{
+    rc_replay_stats_t *b = &r->stats;
+    b->packets++;
+
+    // 1. 解析 (和 udp_task 一样: 不是当前会话手机发的二进制帧不解码，JSON 要解析才知道是什么命令)
+    const bool client = (e->flags & RC_REC_FLAG_CLIENT) != 0;
+    const bool bin = rc_packet_is_binary(payload, e->len);
+    if (bin && !client)
+    {
+        b->not_client++;
+        return false;
+    }
+    UiDataStruct data;
+    bool ctrl = false;
+    bool has_seq = false;
+    uint16_t seq = 0;
+    uint32_t c0 = r->clock();
+    if (bin)
+    {
+        if (rc_packet_decode(payload, e->len, &data, &seq) == RC_PKT_OK)
+        {
+            b->parse_ok++;
+            ctrl = true;
+            has_seq = true;
+        }
+    }
+    else
+    {
+        rc_json_msg_t msg;
+        if (rc_json_parse((const char *)payload, e->len, &msg))
+        {
+            b->parse_ok++;
+            if (msg.cmd == RC_CMD_CTRL)
+            {
+                rc_json_to_ctrl(&msg, &data);
+                ctrl = true;
+                has_seq = (msg.present & RC_JSON_HAS_SEQ) != 0;
+                seq = msg.seq;
+            }
+        }
+    }
+    uint32_t c = r->clock() - c0;
+    b->parse_ticks += c;
+    if (c > b->parse_max_ticks)
+        b->parse_max_ticks = c;
+    if (!ctrl)
+        return false;
+    if (!client)
+    {
+        b->not_client++;
+        return false;
+    }
+    bool fresh = true;
+    if (has_seq)
+        fresh = rc_link_accept(&r->link, seq, e->t_us);
+    else
+        rc_link_note_unsequenced(&r->link, e->t_us);
+    if (!fresh)
+    {
+        b->stale++;
+        return false;
+    }
+    b->ctrl++;
+
+    // 2. 整形 (用录制时的包间隔)
+    uint32_t dt_us = r->have_prev ? e->t_us - r->prev_t_us : 0;
+    r->prev_t_us = e->t_us;
+    r->have_prev = true;
+    c0 = r->clock();
+    data.x1 = rc_shape_axis(&r->params[0], &r->shape[0], data.x1, dt_us);
+    data.y1 = rc_shape_axis(&r->params[1], &r->shape[1], data.y1, dt_us);
+    data.x2 = rc_shape_axis(&r->params[2], &r->shape[2], data.x2, dt_us);
+    data.y2 = rc_shape_axis(&r->params[3], &r->shape[3], data.y2, dt_us);
+    b->shape_ticks += r->clock() - c0;
+
+    // 3. UART 编码 (按当前帧格式)
+    c0 = r->clock();
+    if (r->binary)
+        r->frame_len = uart_frame_encode_binary(&data, r->frame_seq++, r->frame, sizeof(r->frame));
+    else
+        r->frame_len = uart_frame_encode_text(&data, (char *)r->frame, sizeof(r->frame));
+    c = r->clock() - c0;
+    b->encode_ticks += c;
+    if (c > b->encode_max_ticks)
+        b->encode_max_ticks = c;
+
+    r->data = data;
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef RC_REPLAY_H
+#define RC_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_ctrl_data.h"
+#include "rc_link.h"
+#include "rc_shaping.h"
+#include "uart_frame.h"
+
+/*
+ * 录制文件格式和回放流水线 (纯逻辑，设备上的 rc_record.c 和主机上的 host_test/rc_replay_host.c 共用)
+ *
+ * 文件格式 (小端，rcrec 分区 / GET /api/rec/data 下载的文件，tools/rc_rec_dump.py 也按这个解析):
+ *   0   文件头 32 字节 (停止录制时写入):
+ *         magic "RCRC", version u16, header_size u16, records u32, data_bytes u32,
+ *         dropped u32, duration_us u32, reserved[8]
+ *   32  记录，一条接一条:
+ *         t_us u32 (相对开始录制), len u16, flags u16, payload[len]，整条补齐到 4 字节
+ *
+ * 回放每一包: 解析 (rc_packet / rc_json) -> 整形 (rc_shape_axis，独立的状态) -> UART 编码，
+ * 和实时流量一样只用当前会话手机发来的 (RC_REC_FLAG_CLIENT) 控制包，并经过 rc_link 的序号检查。
+ * 每一级的耗时用调用者给的计数器统计 (设备上是 CPU 周期，主机上是纳秒)。
+ */
+#define RC_REC_MAGIC       "RCRC"
+#define RC_REC_VERSION     1
+#define RC_REC_HEADER_SIZE 32
+#define RC_REC_MAX_PAYLOAD 256   // 和 UDP 接收缓冲区一样大
+
+#define RC_REC_FLAG_CLIENT (1u << 0)  // 来自当前会话的手机
+
+#define RC_REC_ALIGN4(n) (((n) + 3u) & ~3u)
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t records;
+    uint32_t data_bytes;
+    uint32_t dropped;
+    uint32_t duration_us;
+    uint8_t reserved[8];
+} rc_rec_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t t_us;
+    uint16_t len;
+    uint16_t flags;
+} rc_rec_entry_t;
+
+_Static_assert(sizeof(rc_rec_header_t) == RC_REC_HEADER_SIZE, "rc_rec_header_t layout changed");
+_Static_assert(sizeof(rc_rec_entry_t) == 8, "rc_rec_entry_t layout changed");
+
+// 计时用的计数器，只用差值 (允许回绕)
+typedef uint32_t (*rc_replay_clock_t)(void);
+
+typedef struct {
+    uint32_t packets;
+    uint32_t parse_ok;       // 解析成功 (二进制 + JSON)
+    uint32_t ctrl;           // 其中的控制指令 (已通过会话和序号检查)
+    uint32_t not_client;     // 不是当前会话手机发来的控制包，和实时一样忽略
+    uint32_t stale;          // rc_link 判为迟到 / 重复而丢弃的控制包
+    uint64_t parse_ticks;
+    uint64_t shape_ticks;
+    uint64_t encode_ticks;
+    uint32_t parse_max_ticks;
+    uint32_t encode_max_ticks;
+} rc_replay_stats_t;
+
+typedef struct {
+    rc_replay_clock_t clock;
+    bool binary;             // UART 帧格式，UART_FRAME_MODE == UART_FRAME_MODE_BINARY
+    rc_link_stats_t link;    // 回放自己的链路统计
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    rc_shape_state_t shape[RC_SHAPE_AXIS_COUNT];
+    uint8_t frame_seq;       // 自己的 UART 序号，不影响真实的发送序号
+    uint32_t prev_t_us;
+    bool have_prev;
+    rc_replay_stats_t stats;
+    UiDataStruct data;       // 最近一个被接受的控制包 (整形之后)
+    uint8_t frame[UART_FRAME_MAX_LEN];
+    size_t frame_len;        // 最近一个控制包编码出的 UART 帧长度
+} rc_replay_t;
+
+void rc_replay_init(rc_replay_t *r, const rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT], bool binary,
+                    rc_replay_clock_t clock);
+
+/**
+ * @brief 回放一条记录
+ *
+ * @return true 表示是被接受的控制包，r->data / r->frame 是这一包的结果
+ */
+bool rc_replay_packet(rc_replay_t *r, const rc_rec_entry_t *e, const uint8_t *payload);
+
+#endif
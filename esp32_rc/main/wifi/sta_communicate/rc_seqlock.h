@@ -0,0 +1,80 @@
+#ifndef RC_SEQLOCK_H
+#define RC_SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/*
+ * 单写者 / 多读者的顺序锁 (seqlock)
+ *
+ * 写者: 序号 +1 (变成奇数) -> 写数据 -> 序号 +1 (变回偶数)
+ * 读者: 读序号 -> 拷贝数据 -> 再读序号，两次相同且为偶数才算读到完整的一份
+ *
+ * 写者永远不会被读者阻塞，读者也不进入临界区，适合 "只关心最新值" 的数据
+ * (遥测、控制状态)。只能有一个写任务。
+ */
+typedef struct {
+    atomic_uint seq;
+} rc_seqlock_t;
+
+#define RC_SEQLOCK_INIT { .seq = 0 }
+
+static inline void rc_seqlock_write_begin(rc_seqlock_t *l)
+{
+    unsigned s = atomic_load_explicit(&l->seq, memory_order_relaxed);
+    atomic_store_explicit(&l->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void rc_seqlock_write_end(rc_seqlock_t *l)
+{
+    unsigned s = atomic_load_explicit(&l->seq, memory_order_relaxed);
+    atomic_store_explicit(&l->seq, s + 1, memory_order_release);
+}
+
+static inline unsigned rc_seqlock_read_begin(rc_seqlock_t *l)
+{
+    unsigned s;
+    while ((s = atomic_load_explicit(&l->seq, memory_order_acquire)) & 1u)
+    {
+        // 写者正在写，数据很小，直接自旋
+    }
+    return s;
+}
+
+static inline bool rc_seqlock_read_retry(rc_seqlock_t *l, unsigned start)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&l->seq, memory_order_relaxed) != start;
+}
+
+/**
+ * @brief 写入一份数据 (只能由唯一的写者调用)
+ */
+static inline void rc_seqlock_store(rc_seqlock_t *l, void *dst, const void *src, size_t size)
+{
+    rc_seqlock_write_begin(l);
+    memcpy(dst, src, size);
+    rc_seqlock_write_end(l);
+}
+
+/**
+ * @brief 读出一份完整的数据
+ *
+ * @return 读到的版本号 (偶数)，0 表示还从未写过
+ */
+static inline unsigned rc_seqlock_load(rc_seqlock_t *l, void *dst, const void *src, size_t size)
+{
+    unsigned s;
+    do
+    {
+        s = rc_seqlock_read_begin(l);
+        memcpy(dst, src, size);
+    } while (rc_seqlock_read_retry(l, s));
+    return s;
+}
+
+#endif
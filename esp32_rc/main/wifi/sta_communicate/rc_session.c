@@ -0,0 +1,259 @@
+#include "rc_session.h"
+#include <string.h>
+
+_Static_assert(RC_SESSION_MAX_PEERS <= 8, "free_mask is 8 bits");
+_Static_assert(RC_SESSION_HASH_SIZE >= 2 * RC_SESSION_MAX_PEERS, "keep the hash table at most half full");
+
+#define HASH_MASK (RC_SESSION_HASH_SIZE - 1)
+
+static inline unsigned peer_hash(const rc_peer_t *p)
+{
+    // 乘法哈希取高位；同一个手机换端口重连也会落到不同的格子
+    uint32_t h = (p->addr ^ ((uint32_t)p->port << 16 | p->port)) * 2654435761u;
+    return h >> (32 - RC_SESSION_HASH_BITS);
+}
+
+void rc_session_init(rc_session_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->state = SESSION_IDLE;
+    s->owner = -1;
+    s->free_mask = (uint8_t)((1u << RC_SESSION_MAX_PEERS) - 1);
+    memset(s->index, -1, sizeof(s->index));
+}
+
+// 在哈希表里找 peer 所在的格子，找不到返回 -1
+static int index_pos(const rc_session_t *s, const rc_peer_t *peer)
+{
+    unsigned i = peer_hash(peer);
+    for (unsigned n = 0; n < RC_SESSION_HASH_SIZE; n++, i = (i + 1) & HASH_MASK)
+    {
+        int slot = s->index[i];
+        if (slot < 0)
+            return -1;
+        if (rc_peer_equal(&s->slots[slot].peer, peer))
+            return (int)i;
+    }
+    return -1;
+}
+
+int rc_session_find(const rc_session_t *s, const rc_peer_t *peer)
+{
+    int pos = index_pos(s, peer);
+    return pos < 0 ? -1 : s->index[pos];
+}
+
+static int slot_add(rc_session_t *s, const rc_peer_t *peer, rc_role_t role, uint32_t now_ms)
+{
+    if (s->free_mask == 0)
+        return -1;
+    int slot = __builtin_ctz(s->free_mask);
+    s->free_mask &= (uint8_t)~(1u << slot);
+
+    rc_session_slot_t *e = &s->slots[slot];
+    memset(e, 0, sizeof(*e));
+    e->peer = *peer;
+    e->role = role;
+    e->last_packet_ms = now_ms;
+
+    // 装载率不超过一半，一定有空格
+    unsigned i = peer_hash(peer);
+    while (s->index[i] >= 0)
+        i = (i + 1) & HASH_MASK;
+    s->index[i] = (int8_t)slot;
+    return slot;
+}
+
+// 线性探测的删除: 把后面同一串里的项往前挪，不用墓碑
+static void slot_remove(rc_session_t *s, int slot)
+{
+    int pos = index_pos(s, &s->slots[slot].peer);
+    if (pos >= 0)
+    {
+        unsigned hole = (unsigned)pos;
+        s->index[hole] = -1;
+        for (unsigned j = (hole + 1) & HASH_MASK; s->index[j] >= 0; j = (j + 1) & HASH_MASK)
+        {
+            unsigned home = peer_hash(&s->slots[s->index[j]].peer);
+            // home 落在 (hole, j] 之间的项留在原地，否则挪进空洞
+            bool stays = hole < j ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!stays)
+            {
+                s->index[hole] = s->index[j];
+                s->index[j] = -1;
+                hole = j;
+            }
+        }
+    }
+
+    if (s->owner == slot)
+    {
+        s->owner = -1;
+        s->state = SESSION_IDLE;
+    }
+    s->slots[slot].role = RC_ROLE_NONE;
+    s->free_mask |= (uint8_t)(1u << slot);
+}
+
+static void make_owner(rc_session_t *s, int slot, uint8_t prio, uint32_t now_ms)
+{
+    if (s->owner >= 0 && s->owner != slot)
+    {
+        s->slots[s->owner].role = RC_ROLE_SPECTATOR;
+        s->slots[s->owner].prio = 0;
+    }
+    s->owner = (int8_t)slot;
+    s->state = SESSION_LOCKED;
+    s->slots[slot].role = RC_ROLE_OWNER;
+    s->slots[slot].prio = prio;
+    s->slots[slot].challenged = false;
+    s->slots[slot].last_packet_ms = now_ms;
+    rc_link_reset(&s->link);
+}
+
+rc_session_connect_t rc_session_connect(rc_session_t *s, const rc_peer_t *peer, bool spectate, uint32_t now_ms,
+                                        int *slot)
+{
+    int i = rc_session_find(s, peer);
+    if (i >= 0)
+    {
+        s->slots[i].last_packet_ms = now_ms;
+        if (i == s->owner)
+        {
+            *slot = i;
+            return RC_SESSION_REFRESHED;
+        }
+    }
+    else
+    {
+        i = slot_add(s, peer, RC_ROLE_SPECTATOR, now_ms);
+        if (i < 0)
+        {
+            *slot = -1;
+            return RC_SESSION_BUSY;
+        }
+    }
+
+    *slot = i;
+    if (s->owner < 0 && !spectate)
+    {
+        make_owner(s, i, 0, now_ms);
+        return RC_SESSION_OPENED;
+    }
+    return RC_SESSION_SPECTATING;
+}
+
+void rc_session_touch_peer(rc_session_t *s, const rc_peer_t *peer, uint32_t now_ms)
+{
+    int i = rc_session_find(s, peer);
+    if (i >= 0)
+        s->slots[i].last_packet_ms = now_ms;
+}
+
+bool rc_session_disconnect(rc_session_t *s, const rc_peer_t *peer)
+{
+    int i = rc_session_find(s, peer);
+    if (i < 0)
+        return false;
+    bool was_owner = i == s->owner;
+    slot_remove(s, i);
+    return was_owner;
+}
+
+bool rc_session_challenge(rc_session_t *s, const rc_peer_t *peer, const uint8_t *nonce, uint32_t now_ms)
+{
+    int i = rc_session_find(s, peer);
+    if (i < 0 && (i = slot_add(s, peer, RC_ROLE_SPECTATOR, now_ms)) < 0)
+        return false;
+
+    rc_session_slot_t *e = &s->slots[i];
+    e->last_packet_ms = now_ms;
+    e->challenged = true;
+    e->challenge_ms = now_ms;
+    memcpy(e->nonce, nonce, RC_SESSION_NONCE_LEN);
+    return true;
+}
+
+const uint8_t *rc_session_pending_nonce(const rc_session_t *s, const rc_peer_t *peer, uint32_t now_ms)
+{
+    int i = rc_session_find(s, peer);
+    if (i < 0)
+        return NULL;
+    const rc_session_slot_t *e = &s->slots[i];
+    if (!e->challenged || now_ms - e->challenge_ms > RC_SESSION_CHALLENGE_MS)
+        return NULL;
+    return e->nonce;
+}
+
+rc_takeover_result_t rc_session_takeover(rc_session_t *s, const rc_peer_t *peer, bool authenticated,
+                                         uint8_t prio, uint32_t now_ms, int *old_owner)
+{
+    *old_owner = -1;
+    int i = rc_session_find(s, peer);
+    if (i < 0)
+        return RC_TAKEOVER_DENIED;
+
+    rc_session_slot_t *e = &s->slots[i];
+    bool valid = e->challenged && now_ms - e->challenge_ms <= RC_SESSION_CHALLENGE_MS;
+    e->challenged = false; // 一次性，失败了要重新要随机数
+    memset(e->nonce, 0, sizeof(e->nonce));
+    if (!valid || !authenticated)
+        return RC_TAKEOVER_DENIED;
+
+    if (prio > RC_SESSION_PRIO_MAX)
+        prio = RC_SESSION_PRIO_MAX;
+    if (i != s->owner)
+    {
+        if (s->owner >= 0 && s->slots[s->owner].prio > prio)
+            return RC_TAKEOVER_OUTRANKED;
+        *old_owner = s->owner;
+        make_owner(s, i, prio, now_ms);
+    }
+    else
+    {
+        s->slots[i].prio = prio; // 已经是控制者，只更新优先级
+    }
+    return RC_TAKEOVER_OK;
+}
+
+static inline uint32_t slot_timeout(const rc_session_t *s, int i, uint32_t max_timeout_ms)
+{
+    return i == s->owner ? rc_link_session_timeout_ms(&s->link, max_timeout_ms) : max_timeout_ms;
+}
+
+bool rc_session_deadline(const rc_session_t *s, uint32_t max_timeout_ms, uint32_t *due_ms)
+{
+    bool any = false;
+    uint32_t best = 0;
+    uint8_t used = (uint8_t)~s->free_mask & ((1u << RC_SESSION_MAX_PEERS) - 1);
+    while (used)
+    {
+        int i = __builtin_ctz(used);
+        used &= used - 1;
+        uint32_t due = s->slots[i].last_packet_ms + slot_timeout(s, i, max_timeout_ms) + 1;
+        // 按回绕时间比较，取最早的
+        if (!any || (int32_t)(due - best) < 0)
+            best = due;
+        any = true;
+    }
+    if (any)
+        *due_ms = best;
+    return any;
+}
+
+bool rc_session_expire(rc_session_t *s, uint32_t now_ms, uint32_t max_timeout_ms)
+{
+    bool owner_expired = false;
+    uint8_t used = (uint8_t)~s->free_mask & ((1u << RC_SESSION_MAX_PEERS) - 1);
+    while (used)
+    {
+        int i = __builtin_ctz(used);
+        used &= used - 1;
+        if (now_ms - s->slots[i].last_packet_ms <= slot_timeout(s, i, max_timeout_ms))
+            continue;
+        if (i == s->owner)
+            owner_expired = true;
+        slot_remove(s, i);
+    }
+    return owner_expired;
+}
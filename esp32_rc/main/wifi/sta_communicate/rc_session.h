@@ -0,0 +1,185 @@
+#ifndef RC_SESSION_H
+#define RC_SESSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_link.h"
+
+/*
+ * UDP 控制会话表
+ *
+ * 同一时间只有一个控制者 (owner): 没有控制者时第一个发 "connect" 的手机成为控制者。
+ * 之后再来的手机不再只收到 busy，而是作为旁观者 (spectator) 登记进表里，
+ * 只接收遥测，它们的 ctrl 被忽略；表满了才回 busy。
+ * 旁观者可以发起接管 (takeover): 设备回一个一次性随机数，旁观者用配对密钥算出认证码回来，
+ * 验证通过后原控制者降为旁观者 (认证算法和密钥在 udp_task.c，这里只管状态)。
+ * 接管带一个优先级 (0..RC_SESSION_PRIO_MAX，包含在认证码里): 只能接管优先级不高于自己的控制者。
+ * 普通 connect 得到的控制权优先级为 0，任何通过认证的接管都能抢；
+ * 以优先级 2 接管的 (例如带队老师) 不会被优先级 1 的接管抢走。
+ * 控制者断开或超时 (根据链路统计自适应，见 rc_link.h) 后会话回到空闲，旁观者保留。
+ * 旁观者不发控制指令，要每隔不超过 SESSION_TIMEOUT_MS 重发一次 "connect" (或任意指令) 保活，
+ * 否则超时后从表里删除。
+ *
+ * 表的容量固定，不分配内存。按地址查找用开放寻址哈希表，收包路径上没有线性扫描；
+ * 判断 "是不是控制者" 只比较一次地址。
+ *
+ * 纯逻辑，不依赖 lwIP / FreeRTOS: 地址用 rc_peer_t 表示，时间由调用者传入，
+ * 回复 ACK、发遥测、武装失控保护这些副作用由 udp_task.c 根据返回值去做。
+ */
+#define RC_SESSION_MAX_PEERS   4      // 控制者 + 旁观者
+#define RC_SESSION_HASH_BITS   3      // 哈希表 8 格，装载率不超过 1/2
+#define RC_SESSION_HASH_SIZE   (1u << RC_SESSION_HASH_BITS)
+#define RC_SESSION_NONCE_LEN   8
+#define RC_SESSION_CHALLENGE_MS 2000  // 接管随机数的有效期
+#define RC_SESSION_PRIO_MAX    3      // 接管优先级上限
+
+// 对端地址，和 sockaddr_in 里的一样都是网络字节序，只用来比较
+typedef struct {
+    uint32_t addr;
+    uint16_t port;
+} rc_peer_t;
+
+typedef enum {
+    SESSION_IDLE,      // 没有控制者
+    SESSION_LOCKED     // 有控制者，只听这一个人的
+} session_state_t;
+
+typedef enum {
+    RC_ROLE_NONE = 0,
+    RC_ROLE_OWNER,
+    RC_ROLE_SPECTATOR,
+} rc_role_t;
+
+typedef struct {
+    rc_peer_t peer;
+    uint8_t role;                   // rc_role_t
+    uint8_t prio;                   // 作为控制者时的优先级 (接管时给出，connect 为 0)
+    bool challenged;                // 发过接管随机数，等待应答
+    uint32_t last_packet_ms;        // 最后一次收到这个人的合法包 (毫秒)
+    uint32_t challenge_ms;          // 随机数发出的时间
+    uint8_t nonce[RC_SESSION_NONCE_LEN];
+} rc_session_slot_t;
+
+typedef struct {
+    session_state_t state;
+    int8_t owner;                   // 控制者所在槽位，-1 = 没有
+    uint8_t free_mask;              // 空闲槽位的位图
+    rc_link_stats_t link;           // 控制者的序号 / 丢包 / 抖动统计
+    rc_session_slot_t slots[RC_SESSION_MAX_PEERS];
+    int8_t index[RC_SESSION_HASH_SIZE];  // 地址哈希 -> 槽位，-1 = 空
+} rc_session_t;
+
+typedef enum {
+    RC_SESSION_OPENED = 0,  // 成为控制者 (链路统计已清零)
+    RC_SESSION_REFRESHED,   // 已经是控制者了，只刷新心跳
+    RC_SESSION_SPECTATING,  // 登记 / 刷新为旁观者
+    RC_SESSION_BUSY,        // 表满了，拒绝
+} rc_session_connect_t;
+
+typedef enum {
+    RC_TAKEOVER_DENIED = 0, // 没有有效的随机数或认证失败 (随机数已作废)
+    RC_TAKEOVER_OK,         // 接管成功，原控制者 (如果有) 降为旁观者
+    RC_TAKEOVER_OUTRANKED,  // 认证通过，但控制者的优先级更高
+} rc_takeover_result_t;
+
+static inline bool rc_peer_equal(const rc_peer_t *a, const rc_peer_t *b)
+{
+    return a->addr == b->addr && a->port == b->port;
+}
+
+void rc_session_init(rc_session_t *s);
+
+/**
+ * @brief 按地址查找槽位
+ *
+ * @return 槽位号，不在表里返回 -1
+ */
+int rc_session_find(const rc_session_t *s, const rc_peer_t *peer);
+
+/**
+ * @brief 处理 "connect" 请求
+ *
+ * @param spectate true 只想旁观 (有空位时即使没有控制者也不接管)
+ * @param slot     返回对方所在的槽位 (BUSY 时为 -1)
+ */
+rc_session_connect_t rc_session_connect(rc_session_t *s, const rc_peer_t *peer, bool spectate, uint32_t now_ms,
+                                        int *slot);
+
+/**
+ * @brief peer 是不是当前的控制者 (只有它的 ctrl 会被处理)
+ */
+static inline bool rc_session_is_client(const rc_session_t *s, const rc_peer_t *peer)
+{
+    return s->owner >= 0 && rc_peer_equal(peer, &s->slots[s->owner].peer);
+}
+
+/**
+ * @brief 当前控制者的地址，没有控制者返回 NULL
+ */
+static inline const rc_peer_t *rc_session_owner(const rc_session_t *s)
+{
+    return s->owner >= 0 ? &s->slots[s->owner].peer : NULL;
+}
+
+/**
+ * @brief 收到控制者的合法包，刷新心跳
+ */
+static inline void rc_session_touch(rc_session_t *s, uint32_t now_ms)
+{
+    if (s->owner >= 0)
+        s->slots[s->owner].last_packet_ms = now_ms;
+}
+
+/**
+ * @brief 收到表里任何一个人 (包括旁观者) 的合法指令，刷新它的心跳
+ */
+void rc_session_touch_peer(rc_session_t *s, const rc_peer_t *peer, uint32_t now_ms);
+
+/**
+ * @brief 处理 "disconnect" 请求，对方从表里删除
+ *
+ * @return true 断开的是控制者，会话回到空闲
+ */
+bool rc_session_disconnect(rc_session_t *s, const rc_peer_t *peer);
+
+/**
+ * @brief 接管第一步: 给 peer 发一个随机数 (peer 不在表里时先登记为旁观者)
+ *
+ * @param nonce 调用者生成的随机数 (RC_SESSION_NONCE_LEN 字节)
+ * @return false 表满了
+ */
+bool rc_session_challenge(rc_session_t *s, const rc_peer_t *peer, const uint8_t *nonce, uint32_t now_ms);
+
+/**
+ * @brief 接管第二步之前: 取 peer 还在有效期内的随机数，用来验证认证码
+ *
+ * @return 随机数，没有或已过期返回 NULL
+ */
+const uint8_t *rc_session_pending_nonce(const rc_session_t *s, const rc_peer_t *peer, uint32_t now_ms);
+
+/**
+ * @brief 接管第二步: 随机数无论成败都作废，authenticated 且 prio 不低于控制者时 peer 成为控制者
+ *
+ * @param prio      请求的优先级 (超过 RC_SESSION_PRIO_MAX 按上限算)，认证码必须覆盖它
+ * @param old_owner 接管成功时返回原控制者的槽位 (没有为 -1)
+ */
+rc_takeover_result_t rc_session_takeover(rc_session_t *s, const rc_peer_t *peer, bool authenticated,
+                                         uint8_t prio, uint32_t now_ms, int *old_owner);
+
+/**
+ * @brief 最近的超时截止时间 (毫秒)，表空时返回 false
+ *
+ * 控制者按链路统计自适应，旁观者固定用 max_timeout_ms
+ * @param max_timeout_ms 超时上限 (SESSION_TIMEOUT_MS)
+ */
+bool rc_session_deadline(const rc_session_t *s, uint32_t max_timeout_ms, uint32_t *due_ms);
+
+/**
+ * @brief 删除超时的表项
+ *
+ * @return true 控制者超时了，会话回到空闲
+ */
+bool rc_session_expire(rc_session_t *s, uint32_t now_ms, uint32_t max_timeout_ms);
+
+#endif
@@ -0,0 +1,59 @@
+#include "rc_shaping.h"
+
+int16_t rc_shape_axis(const rc_shape_axis_t *p, rc_shape_state_t *st, int16_t in, uint32_t dt_us)
+{
+    // 1. 死区: 去掉中间一段，剩下的重新拉伸到 0..1
+    int32_t mag = in < 0 ? -(int32_t)in : in;
+    if (mag > RC_SHAPE_ONE)
+        mag = RC_SHAPE_ONE;
+    if (mag <= p->deadband)
+        mag = 0;
+    else if (p->deadband)
+        mag = (mag - p->deadband) * RC_SHAPE_ONE / (RC_SHAPE_ONE - p->deadband);
+
+    // 2. expo: (1 - e) * x + e * x^3，中位附近更细腻，满舵不变
+    if (p->expo && mag)
+    {
+        // 满量程是 32767 而不是 2^15，用除法保证 1.0 映射回 1.0
+        int32_t cube = (int32_t)((int64_t)mag * mag * mag / ((int64_t)RC_SHAPE_ONE * RC_SHAPE_ONE));
+        mag = ((RC_SHAPE_ONE - p->expo) * mag + p->expo * cube) / RC_SHAPE_ONE;
+    }
+    int32_t v = in < 0 ? -mag : mag;
+
+    // 3. 一阶低通，状态多留 8 位小数；步长截断为 0 时直接到位，保证能精确回到 0
+    int32_t target = v << 8;
+    if (p->lowpass && p->lowpass < 256)
+    {
+        int32_t step = (int32_t)((int64_t)(target - st->lp) * p->lowpass / 256);
+        st->lp = step ? st->lp + step : target;
+    }
+    else
+    {
+        st->lp = target;
+    }
+    v = st->lp / 256;
+
+    // 4. 变化率限制
+    if (p->slew)
+    {
+        if (dt_us > RC_SHAPE_MAX_DT_US)
+            dt_us = RC_SHAPE_MAX_DT_US;
+        int32_t max_step = (int32_t)((uint64_t)p->slew * dt_us / 1000);
+        int32_t d = v - st->out;
+        if (d > max_step)
+            v = st->out + max_step;
+        else if (d < -max_step)
+            v = st->out - max_step;
+    }
+
+    st->out = (int16_t)v;
+    return st->out;
+}
+
+void rc_shape_default(rc_shape_axis_t *p)
+{
+    p->deadband = 0;
+    p->expo = 0;
+    p->lowpass = 0;
+    p->slew = 0;
+}
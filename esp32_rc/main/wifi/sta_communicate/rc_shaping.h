@@ -0,0 +1,51 @@
+#ifndef RC_SHAPING_H
+#define RC_SHAPING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rc_ctrl_data.h"
+
+/*
+ * 摇杆输入整形
+ *
+ * UDP 任务收到控制指令后、发布到控制总线之前，对 x1/y1/x2/y2 逐轴做:
+ *   死区 -> expo 曲线 -> 一阶低通 -> 变化率限制
+ * 手机摇杆在中位附近的抖动被死区吃掉，细小的来回变化被低通抹平，
+ * 下游 (UART、LCD) 就不会一直收到没有意义的变化。
+ *
+ * 全部是 Q15 定点整数运算，每包 4 个轴，开销可以忽略。
+ * 按钮和滑条不经过整形。
+ *
+ * 这里只有整形逻辑 (rc_shape_*)，纯函数，时间由调用者传入，可以在主机上测试；
+ * 设备上的封装 (参数存储、HTTP 接口) 见 shaping.h。
+ */
+#define RC_SHAPE_AXIS_COUNT 4   // x1 y1 x2 y2
+#define RC_SHAPE_ONE        UI_AXIS_SCALE
+#define RC_SHAPE_MAX_DT_US  100000  // 两包间隔超过 100ms 按 100ms 算 (限制变化率时用)
+
+typedef struct {
+    uint16_t deadband;  // 死区 (Q15)，|输入| 不超过它输出 0，之外的部分重新拉伸到满量程
+    uint16_t expo;      // 三次项权重 (Q15)，0 = 线性，RC_SHAPE_ONE = 纯三次曲线
+    uint16_t lowpass;   // 低通新样本权重 (Q8, 1..255)，0 或 >= 256 = 不滤波
+    uint16_t slew;      // 每毫秒最大变化量 (Q15)，0 = 不限
+} rc_shape_axis_t;
+
+typedef struct {
+    int32_t lp;         // 低通状态 (Q15 << 8)
+    int16_t out;        // 上一次的输出
+} rc_shape_state_t;
+
+/**
+ * @brief 对一个轴做一次整形
+ *
+ * 状态全 0 表示 "停着" (初始化 / 复位后)，限制变化率时从 0 开始爬升。
+ * @param dt_us 距离上一个样本的时间，0 表示未知 (这一次不允许变化)
+ */
+int16_t rc_shape_axis(const rc_shape_axis_t *p, rc_shape_state_t *st, int16_t in, uint32_t dt_us);
+
+/**
+ * @brief 默认参数: 全部关闭，输出等于输入 (需要整形的通过 /api/shaping 打开)
+ */
+void rc_shape_default(rc_shape_axis_t *p);
+
+#endif
@@ -0,0 +1,237 @@
+#include "shaping.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "nvs_manager.h"
+#include "ap_connect.h"
+
+static const char *TAG = "SHAPING";
+
+// NVS 里保存的格式，改动结构时增加版本号
+#define SHAPING_NVS_KEY     "rc_shape"
+#define SHAPING_NVS_VERSION 1
+
+typedef struct {
+    uint16_t version;
+    rc_shape_axis_t axis[RC_SHAPE_AXIS_COUNT];
+} shaping_blob_t;
+
+static const char *s_axis_names[RC_SHAPE_AXIS_COUNT] = {"x1", "y1", "x2", "y2"};
+
+// HTTP 任务写、UDP 任务读: 写入放在自旋锁里，UDP 任务只在 s_params_dirty 时拷贝一次
+static rc_shape_axis_t s_params[RC_SHAPE_AXIS_COUNT];
+static portMUX_TYPE s_params_lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_bool s_params_dirty = true;
+static atomic_bool s_reset_req = false;
+
+// 以下只在 UDP 任务中访问
+static rc_shape_axis_t s_active[RC_SHAPE_AXIS_COUNT];
+static rc_shape_state_t s_state[RC_SHAPE_AXIS_COUNT];
+static uint32_t s_last_us = 0;  // 0 = 复位后还没有样本
+
+esp_err_t shaping_init(void)
+{
+    rc_shape_axis_t params[RC_SHAPE_AXIS_COUNT];
+    shaping_blob_t blob;
+    esp_err_t err = load_blob_from_nvs(SHAPING_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK && blob.version == SHAPING_NVS_VERSION)
+    {
+        memcpy(params, blob.axis, sizeof(params));
+        ESP_LOGI(TAG, "Loaded shaping params from NVS");
+    }
+    else
+    {
+        for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+            rc_shape_default(&params[i]);
+    }
+
+    taskENTER_CRITICAL(&s_params_lock);
+    memcpy(s_params, params, sizeof(s_params));
+    taskEXIT_CRITICAL(&s_params_lock);
+    atomic_store(&s_params_dirty, true);
+    return ESP_OK;
+}
+
+void shaping_apply(UiDataStruct *data, uint32_t now_us)
+{
+    if (atomic_exchange(&s_params_dirty, false))
+    {
+        taskENTER_CRITICAL(&s_params_lock);
+        memcpy(s_active, s_params, sizeof(s_active));
+        taskEXIT_CRITICAL(&s_params_lock);
+    }
+    if (atomic_exchange(&s_reset_req, false))
+    {
+        memset(s_state, 0, sizeof(s_state));
+        s_last_us = 0;
+    }
+
+    uint32_t dt_us = s_last_us ? now_us - s_last_us : 0;
+    s_last_us = now_us ? now_us : 1;
+
+    data->x1 = rc_shape_axis(&s_active[0], &s_state[0], data->x1, dt_us);
+    data->y1 = rc_shape_axis(&s_active[1], &s_state[1], data->y1, dt_us);
+    data->x2 = rc_shape_axis(&s_active[2], &s_state[2], data->x2, dt_us);
+    data->y2 = rc_shape_axis(&s_active[3], &s_state[3], data->y2, dt_us);
+}
+
+void shaping_reset(void)
+{
+    atomic_store(&s_reset_req, true);
+}
+
+void shaping_get_params(rc_shape_axis_t out[RC_SHAPE_AXIS_COUNT])
+{
+    taskENTER_CRITICAL(&s_params_lock);
+    memcpy(out, s_params, sizeof(s_params));
+    taskEXIT_CRITICAL(&s_params_lock);
+}
+
+esp_err_t shaping_set_params(const rc_shape_axis_t in[RC_SHAPE_AXIS_COUNT])
+{
+    shaping_blob_t blob = {.version = SHAPING_NVS_VERSION};
+    memcpy(blob.axis, in, sizeof(blob.axis));
+
+    taskENTER_CRITICAL(&s_params_lock);
+    memcpy(s_params, in, sizeof(s_params));
+    taskEXIT_CRITICAL(&s_params_lock);
+    atomic_store(&s_params_dirty, true);
+
+    return save_blob_to_nvs(SHAPING_NVS_KEY, &blob, sizeof(blob));
+}
+
+// ================= HTTP 接口 =================
+// 对外用小数表示，便于手工调参:
+//   deadband / expo: 0..1，lowpass: 新样本权重 0..1 (1 = 不滤波)，slew: 每秒最大变化 (满量程 = 1)
+
+static uint16_t frac_to_q(double v, double one, double max)
+{
+    double q = v * one + 0.5;
+    if (q < 0)
+        q = 0;
+    if (q > max)
+        q = max;
+    return (uint16_t)q;
+}
+
+// GET /api/shaping
+static esp_err_t shaping_get_handler(httpd_req_t *req)
+{
+    rc_shape_axis_t p[RC_SHAPE_AXIS_COUNT];
+    shaping_get_params(p);
+
+    char buf[384];
+    int n = snprintf(buf, sizeof(buf), "{");
+    for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+    {
+        double lowpass = (p[i].lowpass && p[i].lowpass < 256) ? p[i].lowpass / 256.0 : 1.0;
+        n += snprintf(buf + n, sizeof(buf) - n,
+                      "%s\"%s\":{\"deadband\":%.3f,\"expo\":%.3f,\"lowpass\":%.3f,\"slew\":%.2f}",
+                      i ? "," : "", s_axis_names[i],
+                      (double)p[i].deadband / RC_SHAPE_ONE, (double)p[i].expo / RC_SHAPE_ONE,
+                      lowpass, (double)p[i].slew * 1000 / RC_SHAPE_ONE);
+    }
+    snprintf(buf + n, sizeof(buf) - n, "}");
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, buf, HTTPD_RESP_USE_STRLEN);
+}
+
+// POST /api/shaping，只修改请求里出现的轴和字段，例如 {"x1":{"deadband":0.05,"expo":0.3}}
+static esp_err_t shaping_post_handler(httpd_req_t *req)
+{
+    if (!http_check_pair_key(req))
+        return ESP_FAIL;
+
+    char buf[384];
+    if (req->content_len >= sizeof(buf))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "body too large");
+        return ESP_FAIL;
+    }
+    // 一次 recv 不一定收全，读到 content_len 为止 (超时重试几次，对方卡住就放弃)
+    size_t got = 0;
+    int timeouts = 0;
+    while (got < req->content_len)
+    {
+        int ret = httpd_req_recv(req, buf + got, req->content_len - got);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= 3)
+            continue;
+        if (ret <= 0)
+        {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "incomplete body");
+            return ESP_FAIL;
+        }
+        got += ret;
+    }
+    if (got == 0)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "no body");
+        return ESP_FAIL;
+    }
+    buf[got] = '\0';
+
+    cJSON *root = cJSON_Parse(buf);
+    if (root == NULL)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad json");
+        return ESP_FAIL;
+    }
+
+    rc_shape_axis_t p[RC_SHAPE_AXIS_COUNT];
+    shaping_get_params(p);
+    for (int i = 0; i < RC_SHAPE_AXIS_COUNT; i++)
+    {
+        cJSON *axis = cJSON_GetObjectItem(root, s_axis_names[i]);
+        if (!cJSON_IsObject(axis))
+            continue;
+
+        cJSON *item = cJSON_GetObjectItem(axis, "deadband");
+        if (cJSON_IsNumber(item))
+            p[i].deadband = frac_to_q(item->valuedouble, RC_SHAPE_ONE, RC_SHAPE_ONE - 1);
+        item = cJSON_GetObjectItem(axis, "expo");
+        if (cJSON_IsNumber(item))
+            p[i].expo = frac_to_q(item->valuedouble, RC_SHAPE_ONE, RC_SHAPE_ONE);
+        item = cJSON_GetObjectItem(axis, "lowpass");
+        if (cJSON_IsNumber(item))
+            p[i].lowpass = item->valuedouble >= 1.0 ? 0 : frac_to_q(item->valuedouble, 256, 255);
+        item = cJSON_GetObjectItem(axis, "slew");
+        if (cJSON_IsNumber(item))
+            p[i].slew = frac_to_q(item->valuedouble / 1000, RC_SHAPE_ONE, UINT16_MAX);
+    }
+    cJSON_Delete(root);
+
+    if (shaping_set_params(p) != ESP_OK)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    return shaping_get_handler(req);
+}
+
+static const httpd_uri_t shaping_get_uri = {
+    .uri = "/api/shaping",
+    .method = HTTP_GET,
+    .handler = shaping_get_handler,
+    .user_ctx = NULL};
+
+static const httpd_uri_t shaping_post_uri = {
+    .uri = "/api/shaping",
+    .method = HTTP_POST,
+    .handler = shaping_post_handler,
+    .user_ctx = NULL};
+
+void register_shaping_handler(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        ESP_LOGE(TAG, "Web Server 句柄为空，无法注册输入整形接口");
+        return;
+    }
+    ESP_LOGI(TAG, "注册输入整形接口: /api/shaping");
+    httpd_register_uri_handler(server, &shaping_get_uri);
+    httpd_register_uri_handler(server, &shaping_post_uri);
+}
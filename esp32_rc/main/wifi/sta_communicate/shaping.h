@@ -0,0 +1,45 @@
+#ifndef SHAPING_H
+#define SHAPING_H
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "rc_shaping.h"
+
+/*
+ * 摇杆整形的设备端封装 (整形逻辑见 rc_shaping.h)
+ *
+ * 参数每个轴一份，保存在 NVS 中 (nvs_manager)，可以通过 GET/POST /api/shaping 查看和修改
+ * (POST 要带配对密钥，见 ap_connect.h)。
+ */
+
+/**
+ * @brief 从 NVS 读取参数 (没有保存过就用默认值)
+ */
+esp_err_t shaping_init(void);
+
+/**
+ * @brief 对一包控制数据的摇杆轴做整形，只能在 UDP 任务中调用
+ *
+ * @param now_us 这包数据的接收时间 (rc_lat_now())
+ */
+void shaping_apply(UiDataStruct *data, uint32_t now_us);
+
+/**
+ * @brief 请求把整形状态清零 (会话开始 / 结束、失控保护停车后)
+ *
+ * 任何任务都可以调用，下一次 shaping_apply 时生效。
+ */
+void shaping_reset(void);
+
+/**
+ * @brief 读 / 写当前参数 (写入立即生效并保存到 NVS)
+ */
+void shaping_get_params(rc_shape_axis_t out[RC_SHAPE_AXIS_COUNT]);
+esp_err_t shaping_set_params(const rc_shape_axis_t in[RC_SHAPE_AXIS_COUNT]);
+
+/**
+ * @brief 注册 GET/POST /api/shaping (POST 检查配对密钥)
+ */
+void register_shaping_handler(httpd_handle_t server);
+
+#endif
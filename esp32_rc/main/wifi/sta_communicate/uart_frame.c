@@ -0,0 +1,200 @@
+#include "uart_frame.h"
+#include "rc_packet.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// uart_send_task 和失控保护定时器都会编码发送帧
+static atomic_uint s_tx_seq = 0;
+
+static inline void wr_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t rd_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+size_t uart_cobs_encode(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    if (cap < UART_COBS_MAX_LEN(len) - 1)
+        return 0;
+
+    size_t code_idx = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+        }
+        else
+        {
+            out[o++] = in[i];
+            if (++code == 0xFF)
+            {
+                out[code_idx] = code;
+                code_idx = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_idx] = code;
+    return o;
+}
+
+size_t uart_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len)
+    {
+        uint8_t code = in[i++];
+        if (code == 0)
+            return 0;
+        for (uint8_t j = 1; j < code; j++)
+        {
+            if (i >= len || in[i] == 0 || o >= cap)
+                return 0;
+            out[o++] = in[i++];
+        }
+        if (code != 0xFF && i < len)
+        {
+            if (o >= cap)
+                return 0;
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+size_t uart_frame_encode_text(const UiDataStruct *data, char *out, size_t cap)
+{
+    int n = snprintf(out, cap,
+                     "BEGIN,%.5f,%.5f,%.5f,%.5f,%.2f,%.2f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,END",
+                     ui_axis(data->x1), ui_axis(data->y1),
+                     ui_axis(data->x2), ui_axis(data->y2),
+                     ui_scroller(data->sc_h1), ui_scroller(data->sc_v1),
+                     ui_button(data->btn_g1, 0), ui_button(data->btn_g1, 1), ui_button(data->btn_g1, 2),
+                     ui_button(data->btn_g1, 3), ui_button(data->btn_g1, 4), ui_button(data->btn_g1, 5),
+                     ui_button(data->btn_g1, 6), ui_button(data->btn_g1, 7), ui_button(data->btn_g1, 8),
+                     ui_button(data->btn_g1, 9));
+    if (n < 0 || (size_t)n >= cap)
+        return 0;
+    return (size_t)n;
+}
+
+size_t uart_frame_encode_binary(const UiDataStruct *data, uint8_t seq, uint8_t *out, size_t cap)
+{
+    uint8_t raw[UART_CTRL_RAW_LEN];
+
+    raw[0] = UART_MSG_CTRL;
+    raw[1] = seq;
+    wr_u16(raw + 2, (uint16_t)data->x1);
+    wr_u16(raw + 4, (uint16_t)data->y1);
+    wr_u16(raw + 6, (uint16_t)data->x2);
+    wr_u16(raw + 8, (uint16_t)data->y2);
+    wr_u16(raw + 10, (uint16_t)data->sc_h1);
+    wr_u16(raw + 12, (uint16_t)data->sc_v1);
+    wr_u16(raw + 14, data->btn_g1);
+    wr_u16(raw + 16, data->btn_g2);
+    wr_u16(raw + UART_CTRL_PAYLOAD_LEN, rc_crc16_ccitt(raw, UART_CTRL_PAYLOAD_LEN));
+
+    if (cap < 1)
+        return 0;
+    size_t n = uart_cobs_encode(raw, sizeof(raw), out, cap - 1);
+    if (n == 0)
+        return 0;
+    out[n++] = UART_FRAME_DELIM;
+    return n;
+}
+
+bool uart_frame_decode_binary(const uint8_t *in, size_t len, UiDataStruct *data, uint8_t *seq)
+{
+    uint8_t raw[UART_CTRL_RAW_LEN];
+    if (uart_cobs_decode(in, len, raw, sizeof(raw)) != UART_CTRL_RAW_LEN)
+        return false;
+    if (raw[0] != UART_MSG_CTRL)
+        return false;
+    if (rc_crc16_ccitt(raw, UART_CTRL_PAYLOAD_LEN) != rd_u16(raw + UART_CTRL_PAYLOAD_LEN))
+        return false;
+
+    memset(data, 0, sizeof(*data));
+    data->x1 = (int16_t)rd_u16(raw + 2);
+    data->y1 = (int16_t)rd_u16(raw + 4);
+    data->x2 = (int16_t)rd_u16(raw + 6);
+    data->y2 = (int16_t)rd_u16(raw + 8);
+    data->sc_h1 = (int16_t)rd_u16(raw + 10);
+    data->sc_v1 = (int16_t)rd_u16(raw + 12);
+    data->btn_g1 = rd_u16(raw + 14);
+    data->btn_g2 = rd_u16(raw + 16);
+    if (seq)
+        *seq = raw[1];
+    return true;
+}
+
+void uart_frame_parser_init(uart_frame_parser_t *p, uart_frame_handler_t handler, void *ctx)
+{
+    memset(p, 0, sizeof(*p));
+    p->handler = handler;
+    p->ctx = ctx;
+}
+
+static void parser_emit(uart_frame_parser_t *p)
+{
+    uint8_t raw[UART_RX_FRAME_MAX + 2];
+    size_t n = uart_cobs_decode(p->buf, p->len, raw, sizeof(raw));
+    if (n < 3)
+    {
+        p->stats.framing_errors++;
+        return;
+    }
+    if (rc_crc16_ccitt(raw, n - 2) != rd_u16(raw + n - 2))
+    {
+        p->stats.crc_errors++;
+        return;
+    }
+    p->stats.frames++;
+    if (p->handler)
+        p->handler(raw[0], raw, n - 2, p->ctx);
+}
+
+void uart_frame_parser_feed(uart_frame_parser_t *p, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t b = data[i];
+        if (b == UART_FRAME_DELIM)
+        {
+            if (p->overflow)
+                p->stats.framing_errors++;
+            else if (p->len > 0)
+                parser_emit(p);
+            // 分隔符就是重新同步点
+            p->len = 0;
+            p->overflow = false;
+            continue;
+        }
+        if (p->overflow)
+            continue;
+        if (p->len >= sizeof(p->buf))
+        {
+            p->overflow = true;
+            continue;
+        }
+        p->buf[p->len++] = b;
+    }
+}
+
+size_t uart_frame_encode(const UiDataStruct *data, uint8_t *out, size_t cap)
+{
+    if (UART_FRAME_MODE == UART_FRAME_MODE_BINARY)
+        return uart_frame_encode_binary(data, (uint8_t)atomic_fetch_add_explicit(&s_tx_seq, 1, memory_order_relaxed), out, cap);
+    return uart_frame_encode_text(data, (char *)out, cap);
+}
@@ -0,0 +1,126 @@
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_ctrl_data.h"
+
+/*
+ * 发往电机控制板的 UART 帧格式
+ *
+ * UART_FRAME_MODE_TEXT   : 旧板子使用的 "BEGIN,x1,y1,x2,y2,h,v,b0..b9,END"，约 90 字节，
+ *                          115200 波特率下单帧线上时间约 7.8 ms。
+ *                          摇杆来自 Q15 定点，%.5f 的最后一位可能和旧固件不同；
+ *                          滑条限幅在 +-327.67 (见 rc_ctrl_data.h)
+ * UART_FRAME_MODE_BINARY : COBS 编码的二进制帧，以 0x00 作为帧分隔符，共 22 字节，
+ *                          115200 波特率下约 1.9 ms
+ *
+ * 二进制帧 COBS 解码前的内容 (小端):
+ *   0  type      UART_MSG_CTRL
+ *   1  seq       uint8 序号, 每帧 +1
+ *   2  x1 y1 x2 y2   int16, Q15 定点 (与 rc_packet.h 相同)
+ *  10  sc_h sc_v     int16, 单位 0.01
+ *  14  btn_g1 btn_g2 uint16, bit i = 按钮 i
+ *  18  crc       CRC-16/CCITT-FALSE, 覆盖 0..17 字节
+ */
+#define UART_FRAME_MODE_TEXT   0
+#define UART_FRAME_MODE_BINARY 1
+
+// 编译期选择帧格式，旧电机板保持 TEXT；新电机板编译时加 -DUART_FRAME_MODE=UART_FRAME_MODE_BINARY
+#ifndef UART_FRAME_MODE
+#define UART_FRAME_MODE UART_FRAME_MODE_TEXT
+#endif
+
+#define UART_FRAME_DELIM 0x00
+
+// 消息类型 (第一个字节)，0x80 以上是电机板 -> ESP32 方向
+#define UART_MSG_CTRL      0x01
+#define UART_MSG_TELEMETRY 0x81
+
+#define UART_CTRL_PAYLOAD_LEN 18
+#define UART_CTRL_RAW_LEN     (UART_CTRL_PAYLOAD_LEN + 2)
+
+// COBS 编码后的最大长度: 每 254 字节多 1 字节开销，外加 1 字节开销和 1 字节分隔符
+#define UART_COBS_MAX_LEN(n) ((n) + ((n) / 254) + 2)
+
+// 编码缓冲区需要的大小 (取文本帧和二进制帧中较大者)
+#define UART_FRAME_MAX_LEN 128
+
+/**
+ * @brief 按 UART_FRAME_MODE 编码一帧控制数据
+ *
+ * @return 写入 out 的字节数，缓冲区不足时返回 0
+ */
+size_t uart_frame_encode(const UiDataStruct *data, uint8_t *out, size_t cap);
+
+/**
+ * @brief 编码旧的文本帧 "BEGIN,...,END"
+ */
+size_t uart_frame_encode_text(const UiDataStruct *data, char *out, size_t cap);
+
+/**
+ * @brief 编码二进制控制帧 (含 COBS 和结尾的 0x00)
+ */
+size_t uart_frame_encode_binary(const UiDataStruct *data, uint8_t seq, uint8_t *out, size_t cap);
+
+/**
+ * @brief 解码一帧二进制控制帧 (输入不含结尾的 0x00)，电机板侧 / 调试使用
+ *
+ * @return true 解码成功且 CRC 正确
+ */
+bool uart_frame_decode_binary(const uint8_t *in, size_t len, UiDataStruct *data, uint8_t *seq);
+
+// 接收方向单帧 (COBS 解码后) 的最大长度
+#define UART_RX_FRAME_MAX 64
+
+/**
+ * @brief 收到一帧合法数据 (CRC 已校验) 后的回调
+ *
+ * @param type    消息类型 (payload[0])
+ * @param payload 解码后的数据，不含 CRC
+ * @param len     payload 长度
+ */
+typedef void (*uart_frame_handler_t)(uint8_t type, const uint8_t *payload, size_t len, void *ctx);
+
+typedef struct {
+    uint32_t frames;      // 合法帧
+    uint32_t crc_errors;  // CRC 错误
+    uint32_t framing_errors; // COBS 格式错误 / 超长帧 (已重新同步)
+} uart_frame_parser_stats_t;
+
+// 流式解析器: 从字节流中按 0x00 切帧，超长或损坏的数据会被丢弃直到下一个 0x00
+typedef struct {
+    uint8_t buf[UART_COBS_MAX_LEN(UART_RX_FRAME_MAX)];
+    size_t len;
+    bool overflow;
+    uart_frame_handler_t handler;
+    void *ctx;
+    uart_frame_parser_stats_t stats;
+} uart_frame_parser_t;
+
+/**
+ * @brief 初始化流式解析器
+ */
+void uart_frame_parser_init(uart_frame_parser_t *p, uart_frame_handler_t handler, void *ctx);
+
+/**
+ * @brief 喂入任意长度的原始字节，每解析出一帧调用一次 handler
+ */
+void uart_frame_parser_feed(uart_frame_parser_t *p, const uint8_t *data, size_t len);
+
+/**
+ * @brief COBS 编码，不追加分隔符
+ *
+ * @return 编码后长度，缓冲区不足时返回 0
+ */
+size_t uart_cobs_encode(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+
+/**
+ * @brief COBS 解码 (输入不含分隔符)
+ *
+ * @return 解码后长度，格式错误或缓冲区不足时返回 0
+ */
+size_t uart_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+
+#endif
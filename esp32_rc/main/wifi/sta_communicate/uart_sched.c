@@ -0,0 +1,55 @@
+#include "uart_sched.h"
+#include <string.h>
+
+// 只比较控制值，不比较后面的时间戳
+#define CTRL_CMP_LEN offsetof(UiDataStruct, rx_us)
+
+void uart_sched_init(uart_sched_t *s, uint32_t keepalive_ms)
+{
+    memset(s, 0, sizeof(*s));
+    s->keepalive_ms = keepalive_ms ? keepalive_ms : UART_KEEPALIVE_MS;
+}
+
+uart_sched_action_t uart_sched_decide(uart_sched_t *s, const UiDataStruct *cur, uint32_t updates, uint32_t now_ms)
+{
+    // 多次发布只发最后一份
+    if (updates > 1)
+    {
+        s->stats.coalesced += updates - 1;
+        s->stats.bytes_saved += (updates - 1) * s->last_len;
+    }
+
+    if (!s->have_last || memcmp(cur, &s->last, CTRL_CMP_LEN) != 0)
+        return UART_SCHED_CHANGED;
+
+    if (updates > 0)
+    {
+        s->stats.suppressed++;
+        s->stats.bytes_saved += s->last_len;
+    }
+
+    if (now_ms - s->last_tx_ms >= s->keepalive_ms)
+        return UART_SCHED_KEEPALIVE;
+    return UART_SCHED_NONE;
+}
+
+void uart_sched_sent(uart_sched_t *s, uart_sched_action_t action, const UiDataStruct *cur, size_t len, uint32_t now_ms)
+{
+    if (action == UART_SCHED_CHANGED)
+        s->stats.sent_changed++;
+    else if (action == UART_SCHED_KEEPALIVE)
+        s->stats.sent_keepalive++;
+
+    s->last = *cur;
+    s->last_len = (uint16_t)len;
+    s->last_tx_ms = now_ms;
+    s->have_last = true;
+}
+
+uint32_t uart_sched_wait_ms(const uart_sched_t *s, uint32_t now_ms)
+{
+    if (!s->have_last)
+        return 0;
+    uint32_t elapsed = now_ms - s->last_tx_ms;
+    return elapsed >= s->keepalive_ms ? 0 : s->keepalive_ms - elapsed;
+}
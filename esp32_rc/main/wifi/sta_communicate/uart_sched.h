@@ -0,0 +1,67 @@
+#ifndef UART_SCHED_H
+#define UART_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "rc_ctrl_data.h"
+
+/*
+ * UART 控制帧发送调度
+ *
+ * uart_send_task 每次醒来都先问调度器要不要发:
+ *   - 控制值 (摇杆 / 滑条 / 按钮) 和上次发出去的不同: 立即发送;
+ *   - 没变化: 只在距上次发送满 keepalive_ms 时重发一次当前状态 (保活)，
+ *     让电机板知道链路还在，而不是每次更新都发一遍;
+ *   - 两次醒来之间有多次发布: 只发最新的一份，其余计为合并。
+ * 时间戳 (rx_us / queued_us) 不算控制值。
+ *
+ * 判断逻辑 (uart_sched_*) 是纯函数，时间由调用者传入；
+ * 发送任务本身见 uart_send_task.h。
+ */
+#define UART_KEEPALIVE_MS 200   // 默认保活间隔
+
+typedef struct {
+    uint32_t sent_changed;    // 因为状态变化而发送的帧数
+    uint32_t sent_keepalive;  // 保活重发的帧数
+    uint32_t coalesced;       // 被后面的更新覆盖、没有单独发送的发布次数
+    uint32_t suppressed;      // 内容和上次发送相同、不用发送的发布次数
+    uint32_t bytes_saved;     // 合并和去重省下的字节数 (按上一帧的长度估算)
+} uart_sched_stats_t;
+
+typedef enum {
+    UART_SCHED_NONE = 0,
+    UART_SCHED_CHANGED,       // 状态变化，立即发送
+    UART_SCHED_KEEPALIVE,     // 保活重发
+} uart_sched_action_t;
+
+typedef struct {
+    uint32_t keepalive_ms;
+    uint32_t last_tx_ms;
+    bool have_last;
+    UiDataStruct last;        // 上次发送的状态
+    uint16_t last_len;        // 上次发送的帧长
+    uart_sched_stats_t stats;
+} uart_sched_t;
+
+void uart_sched_init(uart_sched_t *s, uint32_t keepalive_ms);
+
+/**
+ * @brief 决定这次醒来要不要发送
+ *
+ * @param cur     当前最新的控制状态
+ * @param updates 上次醒来之后的发布次数 (ulTaskNotifyTake 的返回值)
+ */
+uart_sched_action_t uart_sched_decide(uart_sched_t *s, const UiDataStruct *cur, uint32_t updates, uint32_t now_ms);
+
+/**
+ * @brief 帧已经交给 uart_tx 后调用
+ */
+void uart_sched_sent(uart_sched_t *s, uart_sched_action_t action, const UiDataStruct *cur, size_t len, uint32_t now_ms);
+
+/**
+ * @brief 没有新发布的话，最多还能等多久 (到下一次保活)
+ */
+uint32_t uart_sched_wait_ms(const uart_sched_t *s, uint32_t now_ms);
+
+#endif
@@ -3,6 +3,14 @@
 #include "freertos/queue.h"
 #include "esp_event.h"
 #include "udp_task.h"
+#include "uart_frame.h"
+#include "uart_tx.h"
+#include "uart_telemetry.h"
+#include "rc_latency.h"
+#include "rc_ctrl_state.h"
+#include "uart_send_task.h"
+#include "rc_log.h"
+#include "esp_timer.h"
 
 
 /* UART asynchronous example, that uses separate RX and TX tasks
@@ -19,33 +27,31 @@
 #include "string.h"
 #include "driver/gpio.h"
 
-static const int RX_BUF_SIZE = 1024;
-
-#define TXD_PIN (GPIO_NUM_4)
-#define RXD_PIN (GPIO_NUM_5)
+static const int RX_BUF_SIZE = UART_RX_BUF_SIZE;
 
 void init(void)
 {
-    const uart_config_t uart_config = {
-        .baud_rate = 115200,
-        .data_bits = UART_DATA_8_BITS,
-        .parity = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk = UART_SCLK_DEFAULT,
-    };
-    // We won't use a buffer for sending data.
-    uart_driver_install(UART_NUM_1, RX_BUF_SIZE * 2, 0, 0, NULL, 0);
-    uart_param_config(UART_NUM_1, &uart_config);
-    uart_set_pin(UART_NUM_1, TXD_PIN, RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    // 驱动安装、波特率、流控都在 uart_tx.c 里统一配置
+    ESP_ERROR_CHECK(uart_tx_init());
+}
+
+// 发送任意字节 (二进制帧里可能含 0x00，不能用 strlen)
+// 只是交给发送管线，不会等字节真正发出去
+int sendBytes(const char* logName, const uint8_t* data, size_t len)
+{
+    if (uart_tx_submit(data, len) != ESP_OK)
+    {
+        RC_LOG_RL(UART, ESP_LOG_WARN, logName, RC_LOG_RATE_DEFAULT, "Drop %d bytes", (int)len);
+        rc_blog(RC_EV_UART_DROP, len, ESP_FAIL);
+        return 0;
+    }
+    RC_LOG(UART, ESP_LOG_DEBUG, logName, "Queued %d bytes", (int)len);
+    return (int)len;
 }
 
 int sendData(const char* logName, const char* data)
 {
-    const int len = strlen(data);
-    const int txBytes = uart_write_bytes(UART_NUM_1, data, len);
-    ESP_LOGI(logName, "Wrote %d bytes", txBytes);
-    return txBytes;
+    return sendBytes(logName, (const uint8_t *)data, strlen(data));
 }
 
 
@@ -55,82 +61,98 @@ static void rx_task(void *arg)
     esp_log_level_set(RX_TASK_TAG, ESP_LOG_INFO);
     uint8_t* data = (uint8_t*) malloc(RX_BUF_SIZE + 1);
     while (1) {
-        const int rxBytes = uart_read_bytes(UART_NUM_1, data, RX_BUF_SIZE, 1000 / portTICK_PERIOD_MS);
+        // uart_read_bytes 会一直等到读满 length 才返回，这里先阻塞等第一个字节，
+        // 再把驱动缓冲区里已有的数据一次取走，避免遥测被攒成 1 秒一批
+        int rxBytes = uart_read_bytes(UART_PORT_NUM, data, 1, portMAX_DELAY);
         if (rxBytes > 0) {
-            data[rxBytes] = 0;
-            ESP_LOGI(RX_TASK_TAG, "Read %d bytes: '%s'", rxBytes, data);
-            ESP_LOG_BUFFER_HEXDUMP(RX_TASK_TAG, data, rxBytes, ESP_LOG_INFO);
+            size_t buffered = 0;
+            uart_get_buffered_data_len(UART_PORT_NUM, &buffered);
+            if (buffered > RX_BUF_SIZE - 1)
+                buffered = RX_BUF_SIZE - 1;
+            if (buffered > 0) {
+                int more = uart_read_bytes(UART_PORT_NUM, data + 1, buffered, 0);
+                if (more > 0)
+                    rxBytes += more;
+            }
+
+            // 交给帧解析器: 重新同步、CRC 校验、按消息类型分发到遥测存储
+            motor_telemetry_feed(data, rxBytes);
+            RC_LOG(TELEM, ESP_LOG_DEBUG, RX_TASK_TAG, "Read %d bytes", rxBytes);
+            if (RC_LOG_ENABLED(TELEM, ESP_LOG_VERBOSE))
+                ESP_LOG_BUFFER_HEXDUMP(RX_TASK_TAG, data, rxBytes, ESP_LOG_VERBOSE);
         }
     }
     free(data);
 }
 
 
+static uart_sched_t s_sched;
+
+void uart_send_get_stats(uart_sched_stats_t *out)
+{
+    // 各计数器只由发送任务递增，逐个 32 位读取即可
+    *out = s_sched.stats;
+}
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
 void uart_send_task(void *pvParameters)
 {
     const char *TAG = "UART_SEND_TASK";
     UiDataStruct ui_data;
+    uint8_t frame[UART_FRAME_MAX_LEN];
+
+    // 控制状态每次变化都立即通知本任务 (不限频、无阈值)
+    ctrl_state_subscribe(xTaskGetCurrentTaskHandle(), NULL);
     for(;;)
     {
-        //ESP_LOGE(TAG, "Waiting for data from UDP task..." );
-        // 等待接收来自 UDP 任务的控制数据
-        // if (xQueueReceive(robot_ctrl_queue, &ui_data, portMAX_DELAY) == pdTRUE)
-        // {
-            
-        //     // 这里将接收到的数据通过 UART 发送出去
-        //     // 假设有一个函数 uart_send_data() 用于发送数据
-        //     // uart_send_data(&ui_data, sizeof(UiDataStruct));
-        //     char buffer[2048];
-        //     snprintf(buffer,sizeof(buffer),
-        //              "BEGIN,%.5f,%.5f,%.5f,%.5f,%.2f,%.2f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,END",
-        //              ui_data.joystick1.x, ui_data.joystick1.y,
-        //              ui_data.joystick2.x, ui_data.joystick2.y,
-        //              ui_data.scroller_horiz1, ui_data.scroller_vertical1,
-        //                 ui_data.button_group1[0], ui_data.button_group1[1], ui_data.button_group1[2],
-        //                 ui_data.button_group1[3], ui_data.button_group1[4], ui_data.button_group1[5],
-        //                 ui_data.button_group1[6], ui_data.button_group1[7], ui_data.button_group1[8], 
-        //                 ui_data.button_group1[9]
-        //              );
-
-
-        //     sendData("UART_SEND",buffer);
-        //     ESP_LOGE(TAG, "Sent Data: %s", buffer );
-        //     //ESP_LOGE(TAG, "Sent data over UART" );
-        // }
-
-
-        if (xQueueReceive(robot_ctrl_queue, &ui_data, 500) == pdTRUE)
+        // 等到有新的发布，或者到了下一次保活的时间 (向上取整到 tick，避免空转)
+        uint32_t wait_ms = uart_sched_wait_ms(&s_sched, now_ms());
+        TickType_t wait_ticks = (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        uint32_t updates = ulTaskNotifyTake(pdTRUE, wait_ticks);
+        if (updates > 1)
+            rc_blog(RC_EV_OVERWRITE, 0, updates - 1);
+
+        ctrl_state_read(&ui_data);
+        uint32_t now = now_ms();
+        uart_sched_action_t action = uart_sched_decide(&s_sched, &ui_data, updates, now);
+        if (action == UART_SCHED_NONE)
+            continue;
+
+        // 按当前帧格式 (文本 / 二进制) 编码后交给发送管线
+        // 保活帧重发的是当前状态，不是全 0 (停车由失控保护负责)
+        size_t len = uart_frame_encode(&ui_data, frame, sizeof(frame));
+        if (len == 0)
+            continue;
+
+        esp_err_t err;
+        if (action == UART_SCHED_CHANGED && updates > 0)
+        {
+            uint32_t deq_us = rc_lat_now();
+            rc_lat_record(RC_LAT_QUEUE, ui_data.queued_us, deq_us);
+            err = uart_tx_submit_timed(frame, len, ui_data.rx_us, deq_us);
+        }
+        else
+        {
+            err = uart_tx_submit(frame, len);
+        }
+        // 提交失败也记为已发送，否则会立刻重试空转
+        uart_sched_sent(&s_sched, action, &ui_data, len, now);
+
+        // 稳态只写二进制日志，不格式化
+        if (err != ESP_OK)
         {
-            
-            // 这里将接收到的数据通过 UART 发送出去
-            // 假设有一个函数 uart_send_data() 用于发送数据
-            // uart_send_data(&ui_data, sizeof(UiDataStruct));
-            char buffer[2048];
-            snprintf(buffer,sizeof(buffer),
-                     "BEGIN,%.5f,%.5f,%.5f,%.5f,%.2f,%.2f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,END",
-                     ui_data.joystick1.x, ui_data.joystick1.y,
-                     ui_data.joystick2.x, ui_data.joystick2.y,
-                     ui_data.scroller_horiz1, ui_data.scroller_vertical1,
-                        ui_data.button_group1[0], ui_data.button_group1[1], ui_data.button_group1[2],
-                        ui_data.button_group1[3], ui_data.button_group1[4], ui_data.button_group1[5],
-                        ui_data.button_group1[6], ui_data.button_group1[7], ui_data.button_group1[8], 
-                        ui_data.button_group1[9]
-                     );
-
-
-            sendData("UART_SEND",buffer);
-            ESP_LOGE(TAG, "Sent Data: %s", buffer );
-            //ESP_LOGE(TAG, "Sent data over UART" );
+            rc_blog(RC_EV_UART_DROP, len, err);
+            RC_LOG_RL(UART, ESP_LOG_WARN, TAG, RC_LOG_RATE_DEFAULT, "Drop %d bytes (%s)", (int)len, esp_err_to_name(err));
         }
         else
         {
-            // 超时未收到数据，可以选择发送心跳包或执行其他操作
-            char buffer[512*2];
-            snprintf(buffer,sizeof(buffer),
-                     "BEGIN,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,END"
-                     );
-            sendData("UART_SEND",buffer);
-            ESP_LOGE(TAG, "Sent Heartbeat Data: %s", buffer );
+            rc_blog(RC_EV_UART_TX, len, action);
+            RC_LOG(UART, ESP_LOG_DEBUG, TAG, "Sent %d bytes (%s, mode %d)", (int)len,
+                   action == UART_SCHED_CHANGED ? "changed" : "keepalive", UART_FRAME_MODE);
         }
     }
     vTaskDelete(NULL);
@@ -143,6 +165,7 @@ void uart_send_task(void *pvParameters)
 void uart_task_init(void)
 {
     init();
+    uart_sched_init(&s_sched, UART_KEEPALIVE_MS);
     xTaskCreate(rx_task, "uart_rx_task", 1024 * 2, NULL, configMAX_PRIORITIES - 1, NULL);
     xTaskCreate(uart_send_task, "uart_tx_task", 1024 * 8, NULL, configMAX_PRIORITIES - 1, NULL);
 }
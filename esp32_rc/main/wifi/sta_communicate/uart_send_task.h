@@ -0,0 +1,18 @@
+#ifndef UART_SEND_TASK_H
+#define UART_SEND_TASK_H
+
+#include "uart_sched.h"
+
+/*
+ * UART 发送任务 (uart_send_task.c)
+ *
+ * 订阅控制状态，按 uart_sched 的判断把帧交给 uart_tx。
+ * 任务由 uart_task_init() (udp_task.h) 创建。
+ */
+
+/**
+ * @brief 获取发送调度统计
+ */
+void uart_send_get_stats(uart_sched_stats_t *out);
+
+#endif
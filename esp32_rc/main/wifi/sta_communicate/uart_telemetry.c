@@ -0,0 +1,91 @@
+#include "uart_telemetry.h"
+#include "rc_seqlock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "rc_log.h"
+#include "udp_telemetry.h"
+
+static const char *TAG = "MOTOR_TELEM";
+
+// 最新值存储: UART 接收任务是唯一写者，UDP / LVGL 任务随时读取
+static rc_seqlock_t s_lock = RC_SEQLOCK_INIT;
+static motor_telemetry_t s_latest;
+
+static uart_frame_parser_t s_parser;
+static bool s_parser_ready = false;
+static motor_telemetry_stats_t s_stats;
+
+static inline uint16_t rd_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void handle_telemetry(const uint8_t *payload, size_t len)
+{
+    if (len != UART_TELEMETRY_PAYLOAD_LEN)
+    {
+        s_stats.bad_length++;
+        return;
+    }
+
+    motor_telemetry_t t;
+    t.seq = payload[1];
+    for (int i = 0; i < MOTOR_COUNT; i++)
+    {
+        t.speed_rpm[i] = (int16_t)rd_u16(payload + 2 + i * 2);
+        t.current_ma[i] = (int16_t)rd_u16(payload + 10 + i * 2);
+    }
+    t.battery_mv = rd_u16(payload + 18);
+    t.fault_flags = rd_u16(payload + 20);
+    t.rx_tick = xTaskGetTickCount();
+
+    if (t.fault_flags != s_latest.fault_flags)
+    {
+        rc_blog(RC_EV_MOTOR_FAULT, t.fault_flags, 0);
+        RC_LOG_RL(TELEM, ESP_LOG_WARN, TAG, RC_LOG_RATE_DEFAULT, "Fault flags changed: 0x%04x", t.fault_flags);
+    }
+    bool urgent = t.fault_flags != s_latest.fault_flags;
+
+    rc_seqlock_store(&s_lock, &s_latest, &t, sizeof(t));
+    s_stats.received++;
+
+    // 故障变化要马上告诉手机，不等 UDP 任务的下一个遥测周期 (要在存完最新值之后)
+    if (urgent)
+        udp_telemetry_kick();
+}
+
+// 按消息类型分发
+static void on_frame(uint8_t type, const uint8_t *payload, size_t len, void *ctx)
+{
+    switch (type)
+    {
+    case UART_MSG_TELEMETRY:
+        handle_telemetry(payload, len);
+        break;
+    default:
+        s_stats.unknown_type++;
+        break;
+    }
+}
+
+void motor_telemetry_feed(const uint8_t *data, size_t len)
+{
+    if (!s_parser_ready)
+    {
+        uart_frame_parser_init(&s_parser, on_frame, NULL);
+        s_parser_ready = true;
+    }
+    uart_frame_parser_feed(&s_parser, data, len);
+}
+
+bool motor_telemetry_get(motor_telemetry_t *out)
+{
+    return rc_seqlock_load(&s_lock, out, &s_latest, sizeof(*out)) != 0;
+}
+
+void motor_telemetry_get_stats(motor_telemetry_stats_t *out)
+{
+    *out = s_stats;
+    out->link = s_parser.stats;
+}
@@ -0,0 +1,64 @@
+#ifndef UART_TELEMETRY_H
+#define UART_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "uart_frame.h"
+
+/*
+ * 电机板上报的遥测数据 (UART_MSG_TELEMETRY)
+ *
+ * 帧格式与发送方向相同 (COBS + 0x00 分隔 + CRC-16)，COBS 解码后 (小端):
+ *   0  type          UART_MSG_TELEMETRY
+ *   1  seq           uint8
+ *   2  speed[4]      int16, 轮速 rpm
+ *  10  current[4]    int16, 电机电流 mA
+ *  18  battery_mv    uint16, 电池电压 mV
+ *  20  fault_flags   uint16, MOTOR_FAULT_* 组合
+ *  22  crc
+ */
+#define MOTOR_COUNT 4
+#define UART_TELEMETRY_PAYLOAD_LEN 22
+
+#define MOTOR_FAULT_OVERCURRENT (1u << 0)
+#define MOTOR_FAULT_UNDERVOLT   (1u << 1)
+#define MOTOR_FAULT_OVERTEMP    (1u << 2)
+#define MOTOR_FAULT_STALL       (1u << 3)
+#define MOTOR_FAULT_LINK_LOST   (1u << 4) // 电机板自己检测到 ESP32 指令超时
+#define MOTOR_FAULT_STALE       (1u << 15) // ESP32 侧加上的: 太久没收到遥测，数值是旧的 (见 udp_telemetry.h)
+
+typedef struct {
+    int16_t speed_rpm[MOTOR_COUNT];
+    int16_t current_ma[MOTOR_COUNT];
+    uint16_t battery_mv;
+    uint16_t fault_flags;
+    uint8_t seq;          // 电机板的帧序号
+    uint32_t rx_tick;     // 收到这一帧时的 xTaskGetTickCount()
+} motor_telemetry_t;
+
+typedef struct {
+    uint32_t received;    // 成功解析的遥测帧
+    uint32_t unknown_type;
+    uint32_t bad_length;
+    uart_frame_parser_stats_t link; // 帧层统计 (CRC / 同步错误)
+} motor_telemetry_stats_t;
+
+/**
+ * @brief 把 UART 收到的原始字节交给解析器 (只能由 UART 接收任务调用)
+ */
+void motor_telemetry_feed(const uint8_t *data, size_t len);
+
+/**
+ * @brief 读取最新的遥测值 (任何任务都可以调用，不阻塞写者，不经过队列)
+ *
+ * @return false 表示还没有收到过遥测
+ */
+bool motor_telemetry_get(motor_telemetry_t *out);
+
+/**
+ * @brief 获取解析统计
+ */
+void motor_telemetry_get_stats(motor_telemetry_stats_t *out);
+
+#endif
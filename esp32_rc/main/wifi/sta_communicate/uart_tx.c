@@ -0,0 +1,151 @@
+#include "uart_tx.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "rc_latency.h"
+#include "rc_log.h"
+
+static const char *TAG = "UART_TX";
+
+// 等待发送的最新一帧 (只保留一帧，旧的直接被覆盖)
+static uint8_t s_pending[UART_TX_MAX_FRAME];
+static size_t s_pending_len = 0;
+static uint32_t s_pending_rx_us = 0;
+static uint32_t s_pending_deq_us = 0;
+static portMUX_TYPE s_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t s_tx_task = NULL;
+static uart_tx_stats_t s_stats = {0};
+
+esp_err_t uart_tx_submit(const uint8_t *data, size_t len)
+{
+    return uart_tx_submit_timed(data, len, 0, 0);
+}
+
+esp_err_t uart_tx_submit_timed(const uint8_t *data, size_t len, uint32_t rx_us, uint32_t deq_us)
+{
+    if (len == 0 || len > UART_TX_MAX_FRAME)
+        return ESP_ERR_INVALID_SIZE;
+    if (s_tx_task == NULL)
+        return ESP_ERR_INVALID_STATE;
+
+    taskENTER_CRITICAL(&s_pending_lock);
+    bool overwrite = s_pending_len > 0;
+    if (overwrite)
+        s_stats.coalesced++;
+    uint32_t coalesced = s_stats.coalesced;  // 锁内取值，锁外写日志
+    memcpy(s_pending, data, len);
+    s_pending_len = len;
+    s_pending_rx_us = rx_us;
+    s_pending_deq_us = deq_us;
+    s_stats.submitted++;
+    taskEXIT_CRITICAL(&s_pending_lock);
+
+    if (overwrite)
+        rc_blog(RC_EV_OVERWRITE, 1, coalesced);
+    xTaskNotifyGive(s_tx_task);
+    return ESP_OK;
+}
+
+void uart_tx_get_stats(uart_tx_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_pending_lock);
+    *out = s_stats;
+    taskEXIT_CRITICAL(&s_pending_lock);
+}
+
+// 按当前波特率估算发送 n 个字节需要的 tick 数 (8N1 = 10 bit/字节)，至少 1 tick
+static TickType_t bytes_to_ticks(size_t n)
+{
+    uint32_t us = (uint32_t)((uint64_t)n * 10 * 1000000 / UART_BAUD_RATE);
+    TickType_t t = pdMS_TO_TICKS((us + 999) / 1000);
+    return t > 0 ? t : 1;
+}
+
+static void uart_tx_task(void *arg)
+{
+    uint8_t frame[UART_TX_MAX_FRAME];
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        for (;;)
+        {
+            // 1. 链路积压过多时先等驱动把数据发出去，这段时间里新来的帧会覆盖 s_pending
+            size_t free_size = 0;
+            uart_get_tx_buffer_free_size(UART_PORT_NUM, &free_size);
+            size_t backlog = UART_TX_RING_SIZE - free_size;
+            if (backlog > UART_TX_MAX_BACKLOG)
+            {
+                uart_wait_tx_done(UART_PORT_NUM, bytes_to_ticks(backlog - UART_TX_MAX_BACKLOG));
+                continue;
+            }
+
+            // 2. 取出最新的一帧
+            size_t len;
+            uint32_t rx_us, deq_us;
+            taskENTER_CRITICAL(&s_pending_lock);
+            len = s_pending_len;
+            if (len > 0)
+                memcpy(frame, s_pending, len);
+            rx_us = s_pending_rx_us;
+            deq_us = s_pending_deq_us;
+            s_pending_len = 0;
+            taskEXIT_CRITICAL(&s_pending_lock);
+
+            if (len == 0)
+                break;
+
+            // 3. 写入环形缓冲区，有足够空间时不会阻塞
+            int written = uart_write_bytes(UART_PORT_NUM, frame, len);
+            if (written > 0)
+            {
+                uint32_t done = rc_lat_now();
+                rc_lat_record(RC_LAT_UART, deq_us, done);
+                rc_lat_record(RC_LAT_TOTAL, rx_us, done);
+
+                taskENTER_CRITICAL(&s_pending_lock);
+                s_stats.written++;
+                s_stats.bytes += written;
+                taskEXIT_CRITICAL(&s_pending_lock);
+            }
+        }
+    }
+}
+
+esp_err_t uart_tx_init(void)
+{
+    const uart_config_t uart_config = {
+        .baud_rate = UART_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+#if UART_USE_HW_FLOWCTRL
+        .flow_ctrl = UART_HW_FLOWCTRL_CTS_RTS,
+        .rx_flow_ctrl_thresh = 122,
+#else
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+#endif
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    // 发送端使用环形缓冲区，uart_write_bytes 拷贝进去就返回，由中断搬运到 FIFO
+    ESP_ERROR_CHECK(uart_driver_install(UART_PORT_NUM, UART_RX_BUF_SIZE * 2, UART_TX_RING_SIZE, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));
+#if UART_USE_HW_FLOWCTRL
+    ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, UART_TXD_PIN, UART_RXD_PIN, UART_RTS_PIN, UART_CTS_PIN));
+#else
+    ESP_ERROR_CHECK(uart_set_pin(UART_PORT_NUM, UART_TXD_PIN, UART_RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+#endif
+
+    ESP_LOGI(TAG, "UART%d @ %d baud, tx ring %d bytes, flow ctrl %d",
+             UART_PORT_NUM, UART_BAUD_RATE, UART_TX_RING_SIZE, UART_USE_HW_FLOWCTRL);
+
+    if (xTaskCreate(uart_tx_task, "uart_tx_pipe", 1024 * 3, NULL, configMAX_PRIORITIES - 1, &s_tx_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create uart tx task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,73 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
+
+/*
+ * UART 发送管线
+ *
+ * 调用者 (uart_send_task 等) 通过 uart_tx_submit() 把一帧交给发送任务后立即返回，
+ * 不再卡在 uart_write_bytes 上等字节从 FIFO 发完。
+ * 驱动层有 UART_TX_RING_SIZE 字节的发送环形缓冲区，由中断把数据搬进硬件 FIFO；
+ * 发送任务只在环形缓冲区里积压不超过 UART_TX_MAX_BACKLOG 字节时才写入新帧，
+ * 链路跟不上时，还没写出去的旧帧会被新帧直接覆盖 (合并)，保证 UDP -> UART 延迟有上限。
+ */
+#define UART_PORT_NUM   UART_NUM_1
+#define UART_TXD_PIN    (GPIO_NUM_4)
+#define UART_RXD_PIN    (GPIO_NUM_5)
+
+// 波特率: 旧电机板用 115200，ESP32-S3 的 UART 最高可到 5 Mbaud
+#define UART_BAUD_RATE  115200
+
+// 硬件流控 (RTS/CTS)，需要电机板支持，使用空闲的 GPIO6 / GPIO7
+#define UART_USE_HW_FLOWCTRL 0
+#define UART_RTS_PIN    (GPIO_NUM_6)
+#define UART_CTS_PIN    (GPIO_NUM_7)
+
+#define UART_RX_BUF_SIZE 1024
+#define UART_TX_RING_SIZE 512
+// 环形缓冲区中允许积压的最大字节数，超过后新帧先挂起等待合并
+#define UART_TX_MAX_BACKLOG 128
+// 单帧最大长度
+#define UART_TX_MAX_FRAME 128
+
+typedef struct {
+    uint32_t submitted;  // uart_tx_submit 调用次数
+    uint32_t written;    // 实际写入驱动的帧数
+    uint32_t coalesced;  // 被更新的帧覆盖而丢弃的帧数
+    uint32_t bytes;      // 写入驱动的字节数
+} uart_tx_stats_t;
+
+/**
+ * @brief 安装 UART 驱动 (含发送环形缓冲区) 并启动发送任务
+ */
+esp_err_t uart_tx_init(void);
+
+/**
+ * @brief 非阻塞地提交一帧数据
+ *
+ * 数据会被复制，调用后缓冲区可以立即复用。
+ * 如果上一帧还在等待发送，会被这一帧替换。
+ *
+ * @return ESP_OK; 帧过长返回 ESP_ERR_INVALID_SIZE; 未初始化返回 ESP_ERR_INVALID_STATE
+ */
+esp_err_t uart_tx_submit(const uint8_t *data, size_t len);
+
+/**
+ * @brief 同 uart_tx_submit，额外带上延迟统计用的时间戳
+ *
+ * 帧真正写入驱动时记录 RC_LAT_UART (deq_us -> 写入) 和 RC_LAT_TOTAL (rx_us -> 写入)，
+ * 被合并掉的帧不计入。
+ */
+esp_err_t uart_tx_submit_timed(const uint8_t *data, size_t len, uint32_t rx_us, uint32_t deq_us);
+
+/**
+ * @brief 获取发送统计
+ */
+void uart_tx_get_stats(uart_tx_stats_t *out);
+
+#endif
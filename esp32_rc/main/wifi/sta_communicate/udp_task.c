@@ -4,15 +4,26 @@
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
-#include "cJSON.h"
 #include "esp_log.h"
 #include "esp_event_base.h"
+#include "rc_packet.h"
+#include "rc_json.h"
+#include "udp_telemetry.h"
+#include "rc_latency.h"
+#include "failsafe.h"
+#include "rc_ctrl_state.h"
+#include "rc_deadline.h"
+#include "shaping.h"
+#include "rc_log.h"
+#include "rc_record.h"
+#include "rc_session.h"
+#include "lvgl_task.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "mbedtls/md.h"
 #include <stdio.h>
 static char TAG[] = "UDP_TASK";
 char *devices_name;
-// 全局队列句柄
-QueueHandle_t robot_ctrl_queue = NULL;
-QueueHandle_t lvgl_rc_queue = NULL;
 SemaphoreHandle_t wifi_info_semaphore = NULL;
 /**
  * @brief 初始化 mDNS 服务
@@ -37,15 +48,404 @@ void start_mdns_service()
     // ESP_LOGI("MDNS", "mDNS started. You can ping 'my-robot.local'");
     ESP_LOGE("MDNS", "mDNS started. You can ping '%s.local'", my_wifi_config.device_name);
 }
-// 比较两个 sockaddr_in 是否相同 (IP 和 Port 都要一样)
-static bool is_same_client(struct sockaddr_in *a, struct sockaddr_in *b)
+// 会话表 (见 rc_session.h)，只在 UDP 任务里访问，udp_server_task 开始时初始化
+static rc_session_t g_session;
+// 每个槽位对应的 socket 地址，回复和发遥测用
+static struct sockaddr_in s_peer_addr[RC_SESSION_MAX_PEERS];
+
+static inline rc_peer_t peer_of(const struct sockaddr_in *a)
+{
+    return (rc_peer_t){.addr = a->sin_addr.s_addr, .port = a->sin_port};
+}
+
+static void send_reply(int sock, const struct sockaddr_in *to, const char *reply)
+{
+    sendto(sock, reply, strlen(reply), 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+// 回复 busy (旧版 App 只认这个)，登记成旁观者的额外带上 role 和保活期限
+static void send_busy_reply(int sock, const struct sockaddr_in *to, bool spectator)
+{
+    char reply[128];
+    if (spectator)
+        snprintf(reply, sizeof(reply), "{\"status\":\"busy\",\"device\":\"%s\",\"role\":\"spectator\",\"timeout_ms\":%d}",
+                 my_wifi_config.device_name, SESSION_TIMEOUT_MS);
+    else
+        snprintf(reply, sizeof(reply), "{\"status\":\"busy\",\"device\":\"%s\"}", my_wifi_config.device_name);
+    send_reply(sock, to, reply);
+}
+
+static int hex_val(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+// 配对密钥 (配网页面设置，保存在 NVS)，空字符串表示没有设置，不允许接管
+static char s_pair_key[MAX_PAIR_KEY_LEN + 1];
+
+// 接管认证码: HMAC-SHA256(key = 配对密钥, msg = 随机数 [+ 优先级 1 字节]) 的十六进制，比较时不提前退出
+static bool takeover_auth_ok(const uint8_t *nonce, const rc_json_msg_t *msg)
+{
+    uint8_t mac[32];
+    if (s_pair_key[0] == '\0' || nonce == NULL || msg->auth == NULL || msg->auth_len != 2 * sizeof(mac))
+        return false;
+
+    // 带 "prio" 时优先级也在认证范围内，防止被中途改高
+    uint8_t data[RC_SESSION_NONCE_LEN + 1];
+    size_t data_len = RC_SESSION_NONCE_LEN;
+    memcpy(data, nonce, RC_SESSION_NONCE_LEN);
+    if (msg->present & RC_JSON_HAS_PRIO)
+        data[data_len++] = msg->prio;
+
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char *)s_pair_key,
+                        strlen(s_pair_key), data, data_len, mac) != 0)
+        return false;
+
+    const char *auth = msg->auth;
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(mac); i++)
+    {
+        int hi = hex_val(auth[2 * i]);
+        int lo = hex_val(auth[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        diff |= mac[i] ^ (uint8_t)(hi << 4 | lo);
+    }
+    return diff == 0;
+}
+// 当前这包数据从 recvfrom 返回的时间 (rc_lat_now())，用于统计处理耗时
+static uint32_t s_rx_time_us = 0;
+
+// 把解析好的控制数据分发给电机任务和 LVGL 任务
+static void dispatch_ctrl_data(UiDataStruct *ctrl_data)
+{
+    ctrl_data->rx_us = s_rx_time_us;
+    ctrl_data->queued_us = rc_lat_now();
+
+    // 发布最新控制状态，电机任务和 LVGL 任务收到通知后自己来取
+    ctrl_state_publish(ctrl_data);
+
+    uint32_t done = rc_lat_now();
+    rc_lat_record(RC_LAT_PARSE, s_rx_time_us, done);
+    udp_telemetry_note_latency(done - s_rx_time_us);
+}
+
+// 接受一条新的控制指令: 刷新会话心跳，整形摇杆输入，重新武装失控保护
+static void accept_ctrl(UiDataStruct *ctrl_data, uint32_t now)
 {
-    // ESP_LOGE(TAG, "Comparing clients: %s:%d and %s:%d",
-    //          inet_ntoa(a->sin_addr), ntohs(a->sin_port),
-    //          inet_ntoa(b->sin_addr), ntohs(b->sin_port));
-    return (a->sin_addr.s_addr == b->sin_addr.s_addr) &&
-           (a->sin_port == b->sin_port);
+    rc_session_touch(&g_session, now);
+    shaping_apply(ctrl_data, s_rx_time_us);
+    dispatch_ctrl_data(ctrl_data);
+    failsafe_feed(rc_link_failsafe_ms(&g_session.link, MOTOR_FAILSAFE_MS, MOTOR_FAILSAFE_MAX_MS));
 }
+
+// 控制者离开或被接管: 马上停车，新的控制者从静止开始
+static void stop_for_owner_change(void)
+{
+    failsafe_disarm();
+    shaping_reset();
+    UiDataStruct stop_data = {0};
+    dispatch_ctrl_data(&stop_data);
+}
+
+// 处理二进制控制帧 (见 rc_packet.h)，全程不分配内存
+static void handle_binary_ctrl(const uint8_t *buf, int len, const rc_peer_t *peer, uint32_t now)
+{
+    if (!rc_session_is_client(&g_session, peer))
+    {
+        // 忽略非连接者的控制指令
+        return;
+    }
+
+    UiDataStruct ctrl_data;
+    uint16_t seq;
+    rc_pkt_result_t res = rc_packet_decode(buf, len, &ctrl_data, &seq);
+    if (res != RC_PKT_OK)
+    {
+        RC_LOG(UDP, ESP_LOG_DEBUG, "UDP", "Drop binary ctrl frame, err %d", res);
+        rc_blog(RC_EV_PKT_BAD, res, 0);
+        return;
+    }
+
+    if (!rc_link_accept(&g_session.link, seq, s_rx_time_us))
+    {
+        // 迟到或重复的包: 说明对方还在线，但内容已经过时
+        rc_blog(RC_EV_PKT_STALE, seq, g_session.link.last_seq);
+        rc_session_touch(&g_session, now);
+        return;
+    }
+    accept_ctrl(&ctrl_data, now);
+}
+
+// 处理一个收到的 UDP 包 (rx_buffer 末尾至少还有 1 字节空间)
+static void handle_packet(int sock, char *rx_buffer, int len, struct sockaddr_in *source_addr, uint32_t now)
+{
+    rc_blog(RC_EV_PKT_RX, len, source_addr->sin_addr.s_addr);
+    const rc_peer_t peer = peer_of(source_addr);
+    if (len > 0 && rc_packet_is_binary((const uint8_t *)rx_buffer, len))
+    {
+        // 二进制控制帧，跳过 JSON 解析
+        handle_binary_ctrl((const uint8_t *)rx_buffer, len, &peer, now);
+    }
+    else if (len > 0)
+    {
+        rx_buffer[len] = 0;
+        // ESP_LOGI("UDP", "Recv: %s", rx_buffer);
+
+        // 就地解析，只取已知字段，不分配内存 (见 rc_json.h)
+        rc_json_msg_t msg;
+        if (rc_json_parse(rx_buffer, len, &msg))
+        {
+            // 表里的任何人发来合法指令都算心跳 (旁观者靠重发 connect 保活)
+            rc_session_touch_peer(&g_session, &peer, now);
+
+            // ============================
+            // 场景 A: 处理连接请求 "connect"
+            // ============================
+            if (msg.cmd == RC_CMD_CONNECT)
+            {
+                ESP_LOGI("UDP", "Received connection request from %s:%d",
+                         inet_ntoa(source_addr->sin_addr), ntohs(source_addr->sin_port));
+                bool known = rc_session_find(&g_session, &peer) >= 0;
+                int slot;
+                rc_session_connect_t res =
+                    rc_session_connect(&g_session, &peer, (msg.present & RC_JSON_SPECTATE) != 0, now, &slot);
+                if (slot >= 0)
+                    s_peer_addr[slot] = *source_addr;
+
+                if (res == RC_SESSION_OPENED)
+                {
+                    shaping_reset();
+                    rc_blog(RC_EV_SESSION_OPEN, ntohs(source_addr->sin_port), source_addr->sin_addr.s_addr);
+
+                    rc_json_copy_string(my_wifi_config.device_name, sizeof(my_wifi_config.device_name),
+                                        msg.device ? msg.device : "", msg.device_len);
+
+                    ESP_LOGE("UDP", "Connected device: %s", my_wifi_config.device_name);
+                    // devices_name = cmd_item1 ? cJSON_GetStringValue(cmd_item1) : "";
+                    // ESP_LOGE("UDP", "Connected device: %s", devices_name);
+                    ESP_LOGI("SESSION", "New client connected!");
+                    udp_telemetry_reset();
+
+                    // 发送回复 (ACK)，告诉手机连接成功
+                    send_reply(sock, source_addr, "{\"status\":\"ok\"}");
+                }
+                else if (res == RC_SESSION_REFRESHED)
+                {
+                    // 已经是这个人了，心跳已经刷新
+                    send_reply(sock, source_addr, "{\"status\":\"ok\"}");
+                }
+                else if (res == RC_SESSION_SPECTATING)
+                {
+                    // 已经有别人在控制，登记为旁观者，只收遥测 (重复的 connect 当作心跳)
+                    if (!known)
+                    {
+                        ESP_LOGI("SESSION", "Spectator joined");
+                        rc_blog(RC_EV_SPECTATE, ntohs(source_addr->sin_port), source_addr->sin_addr.s_addr);
+                        udp_telemetry_reset(); // 新来的马上拿到关键帧
+                    }
+                    send_busy_reply(sock, source_addr, true);
+                }
+                else
+                {
+                    // 会话表满了，拒绝!
+                    // 被拒绝的一方可能一直重试，限速打印
+                    RC_LOG_RL(UDP, ESP_LOG_WARN, "SESSION", RC_LOG_RATE_DEFAULT, "Rejecting connection, session table full");
+                    rc_blog(RC_EV_SESSION_BUSY, ntohs(source_addr->sin_port), source_addr->sin_addr.s_addr);
+                    send_busy_reply(sock, source_addr, false);
+                }
+            }
+
+            // ============================
+            // 场景 B: 处理控制指令 "ctrl"
+            // ============================
+            else if (msg.cmd == RC_CMD_CTRL)
+            {
+                // ESP_LOGE("UDP", "Received control command");
+                //  char log_buf[256];
+                //  snprintf(log_buf, sizeof(log_buf), "Received control command from %s:%d",
+                //           inet_ntoa(source_addr->sin_addr), ntohs(source_addr->sin_port));
+                //  ESP_LOGI("UDP", "%s", log_buf);
+
+                // snprintf(log_buf, sizeof(log_buf), "g_session.state:%d,g_session.client_addr:%s:%d",
+                //          g_session.state,
+                //          inet_ntoa(g_session.client_addr.sin_addr),
+                //          ntohs(g_session.client_addr.sin_port));
+                // ESP_LOGI("UDP", "%s", log_buf);
+                if (rc_session_is_client(&g_session, &peer))
+                {
+                    rc_session_touch(&g_session, now);
+
+                    // 带序号的丢弃迟到包；旧版 App 不带序号，只统计到达间隔
+                    bool fresh = true;
+                    if (msg.present & RC_JSON_HAS_SEQ)
+                        fresh = rc_link_accept(&g_session.link, msg.seq, s_rx_time_us);
+                    else
+                        rc_link_note_unsequenced(&g_session.link, s_rx_time_us);
+
+                    UiDataStruct ctrl_data;
+                    rc_json_to_ctrl(&msg, &ctrl_data);
+
+                    // debug log
+                    // ESP_LOGI("UDP", "Joystick1: (%.2f, %.2f)", ctrl_data.joystick1.x, ctrl_data.joystick1.y);
+                    // ESP_LOGI("UDP", "Joystick2: (%.2f, %.2f)", ctrl_data.joystick2.x, ctrl_data.joystick2.y);
+                    // ESP_LOGI("UDP", "Scroller: (%.2f, %.2f)", ctrl_data.scroller_horiz1, ctrl_data.scroller_vertical1);
+
+                    // ESP_LOGI("UDP", "Buttons:");
+                    // for (int i = 0; i < 10; i++)
+                    //     ESP_LOGI("UDP", "  [%d] = %d", i, ctrl_data.button_group1[i]);
+
+                    if (fresh)
+                        accept_ctrl(&ctrl_data, now);
+                }
+                else
+                {
+                    // 忽略非连接者的控制指令
+                    // ESP_LOGD("UDP", "Ignored packet from unauthorized source");
+                }
+            }
+
+            // ============================
+            // 场景 C: 处理断开请求 "disconnect"
+            // ============================
+            else if (msg.cmd == RC_CMD_DISCONNECT)
+            {
+                // 旁观者断开只是从表里删掉
+                if (rc_session_disconnect(&g_session, &peer))
+                {
+                    ESP_LOGI("SESSION", "Client requested disconnect.");
+                    rc_blog(RC_EV_SESSION_CLOSE, 0, g_session.link.received);
+                    stop_for_owner_change();
+                }
+            }
+
+            // ============================
+            // 场景 D: 旁观者请求接管 "takeover"
+            //   1. 不带 auth: 回一个随机数 {"status":"challenge","nonce":"<16 位十六进制>"}
+            //   2. 带 auth (HMAC-SHA256(配对密钥, 随机数 [+ prio 字节]) 的十六进制) 和可选的 "prio":
+            //      验证通过、且优先级不低于当前控制者就成为控制者
+            //   没有设置配对密钥时一律拒绝
+            // ============================
+            else if (msg.cmd == RC_CMD_TAKEOVER)
+            {
+                if (s_pair_key[0] == '\0')
+                {
+                    RC_LOG_RL(UDP, ESP_LOG_WARN, "SESSION", RC_LOG_RATE_DEFAULT, "Takeover refused, no pairing key set");
+                    rc_blog(RC_EV_TAKEOVER, 0, source_addr->sin_addr.s_addr);
+                    send_reply(sock, source_addr, "{\"status\":\"denied\",\"reason\":\"no_key\"}");
+                }
+                else if (!(msg.present & RC_JSON_HAS_AUTH))
+                {
+                    uint8_t nonce[RC_SESSION_NONCE_LEN];
+                    esp_fill_random(nonce, sizeof(nonce));
+                    if (!rc_session_challenge(&g_session, &peer, nonce, now))
+                    {
+                        send_busy_reply(sock, source_addr, false);
+                    }
+                    else
+                    {
+                        s_peer_addr[rc_session_find(&g_session, &peer)] = *source_addr;
+                        char reply[64];
+                        int n = snprintf(reply, sizeof(reply), "{\"status\":\"challenge\",\"nonce\":\"");
+                        for (int i = 0; i < RC_SESSION_NONCE_LEN; i++)
+                            n += snprintf(reply + n, sizeof(reply) - n, "%02x", nonce[i]);
+                        snprintf(reply + n, sizeof(reply) - n, "\"}");
+                        send_reply(sock, source_addr, reply);
+                    }
+                }
+                else
+                {
+                    bool ok = takeover_auth_ok(rc_session_pending_nonce(&g_session, &peer, now), &msg);
+                    int old_owner;
+                    rc_takeover_result_t res = rc_session_takeover(&g_session, &peer, ok, msg.prio, now, &old_owner);
+                    if (res == RC_TAKEOVER_OK)
+                    {
+                        ESP_LOGW("SESSION", "Takeover by %s:%d", inet_ntoa(source_addr->sin_addr), ntohs(source_addr->sin_port));
+                        rc_blog(RC_EV_TAKEOVER, 1, source_addr->sin_addr.s_addr);
+                        stop_for_owner_change();
+                        if (old_owner >= 0)
+                            send_busy_reply(sock, &s_peer_addr[old_owner], true); // 告诉原控制者它现在只能旁观
+                        if (msg.present & RC_JSON_HAS_DEVICE)
+                            rc_json_copy_string(my_wifi_config.device_name, sizeof(my_wifi_config.device_name),
+                                                msg.device, msg.device_len);
+                        udp_telemetry_reset();
+                        send_reply(sock, source_addr, "{\"status\":\"ok\",\"role\":\"owner\"}");
+                    }
+                    else if (res == RC_TAKEOVER_OUTRANKED)
+                    {
+                        RC_LOG_RL(UDP, ESP_LOG_WARN, "SESSION", RC_LOG_RATE_DEFAULT, "Takeover denied, owner has higher priority");
+                        rc_blog(RC_EV_TAKEOVER, 2, source_addr->sin_addr.s_addr);
+                        send_reply(sock, source_addr, "{\"status\":\"denied\",\"reason\":\"priority\"}");
+                    }
+                    else
+                    {
+                        RC_LOG_RL(UDP, ESP_LOG_WARN, "SESSION", RC_LOG_RATE_DEFAULT, "Takeover denied");
+                        rc_blog(RC_EV_TAKEOVER, 0, source_addr->sin_addr.s_addr);
+                        send_reply(sock, source_addr, "{\"status\":\"denied\"}");
+                    }
+                }
+            }
+        }
+    }
+}
+
+// UDP 任务里的定时工作 (rc_deadline_queue_t 的 id)
+enum {
+    UDP_DL_SESSION = 0, // 会话超时检查
+    UDP_DL_TELEMETRY,   // 遥测发送
+    UDP_DL_CTRL_FLUSH,  // 补发被限频推迟的控制状态通知
+};
+
+// 当前时间 (毫秒)
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// 遥测发给控制者和所有旁观者 (控制者排第一个)
+static void poll_telemetry(int sock, uint32_t now)
+{
+    struct sockaddr_in dests[RC_SESSION_MAX_PEERS];
+    int n = 0;
+    if (g_session.owner >= 0)
+        dests[n++] = s_peer_addr[g_session.owner];
+    for (int i = 0; i < RC_SESSION_MAX_PEERS; i++)
+    {
+        if (g_session.slots[i].role == RC_ROLE_SPECTATOR)
+            dests[n++] = s_peer_addr[i];
+    }
+    udp_telemetry_poll(sock, dests, n, now);
+}
+
+// 根据会话状态设置 / 取消定时工作
+static void update_deadlines(rc_deadline_queue_t *dl, uint32_t now)
+{
+    // 控制总线里被限频推迟的通知 (和会话无关，断开时的停车状态也要送到)
+    uint32_t flush_due;
+    if (ctrl_state_next_flush(&flush_due))
+        rc_deadline_set(dl, UDP_DL_CTRL_FLUSH, flush_due);
+    else
+        rc_deadline_cancel(dl, UDP_DL_CTRL_FLUSH);
+
+    uint32_t session_due;
+    if (!rc_session_deadline(&g_session, SESSION_TIMEOUT_MS, &session_due))
+    {
+        rc_deadline_cancel(dl, UDP_DL_SESSION);
+        rc_deadline_cancel(dl, UDP_DL_TELEMETRY);
+        return;
+    }
+    if (!rc_deadline_is_armed(dl, UDP_DL_SESSION))
+        rc_deadline_set(dl, UDP_DL_SESSION, session_due);
+    rc_deadline_set(dl, UDP_DL_TELEMETRY, udp_telemetry_next_due_ms(now));
+}
+
 void udp_server_task(void *pvParameters)
 {
 
@@ -76,215 +476,123 @@ void udp_server_task(void *pvParameters)
         return;
     }
 
-    // 默认情况下，recvfrom 是死等的（阻塞）。如果没有数据，任务会一直卡在那里不动。
-    // 我们设置 100ms 超时，意味着 recvfrom 最多等 100ms。
-    // 重要：设置 Socket 接收超时
-    // 这样 recvfrom 不会死等，每隔 100ms 会返回一次，让我们有机会检查会话是否超时
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 100000; // 100ms
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
+    // 不再用 SO_RCVTIMEO 定时唤醒: 会话超时、遥测发送都放进截止时间队列，
+    // 由 select() 在收到数据或最近的截止时间到达时返回 (电机失控保护由 rc_failsafe 的定时器负责)
     struct sockaddr_in source_addr;
-    socklen_t socklen = sizeof(source_addr);
 
     ESP_LOGI("UDP", "Waiting for data...");
 
+    rc_deadline_queue_t deadlines = {0};
+    rc_session_init(&g_session);
+
+    // 电机故障变化时由 UART 接收任务唤醒 select()，遥测不用等到下一个周期
+    int wake_fd = udp_telemetry_wake_fd();
+    int max_fd = wake_fd > sock ? wake_fd : sock;
+
     while (1)
     {
-        // 1. 尝试接收数据 (带超时)
-        int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, 0, (struct sockaddr *)&source_addr, &socklen);
-
-        uint32_t now = xTaskGetTickCount(); // 获取当前系统滴答
-        // ESP_LOGE("UDP", "正在运行");
-        //  2. 检查会话是否超时 (看门狗)
-        if (g_session.state == SESSION_LOCKED)
-        {
-            uint32_t diff = (now - g_session.last_packet_tick) * portTICK_PERIOD_MS;
-            if (diff > SESSION_TIMEOUT_MS)
-            {
-                ESP_LOGW("SESSION", "Client timed out! Resetting to IDLE.");
-                g_session.state = SESSION_IDLE;
-            }
-        }
+        uint32_t now = now_ms();
 
-        // 3. 处理接收到的数据
-        if (len > 0)
+        // 1. 处理所有到期的定时工作
+        int id;
+        while ((id = rc_deadline_pop(&deadlines, now)) >= 0)
         {
-            rx_buffer[len] = 0;
-            // ESP_LOGI("UDP", "Recv: %s", rx_buffer);
-
-            cJSON *root = cJSON_Parse(rx_buffer);
-            if (root)
+            if (id == UDP_DL_SESSION)
             {
-                cJSON *cmd_item = cJSON_GetObjectItem(root, "cmd");
-                char *cmd_str = cmd_item ? cJSON_GetStringValue(cmd_item) : "";
-
-                // ============================
-                // 场景 A: 处理连接请求 "connect"
-                // ============================
-                if (strcmp(cmd_str, "connect") == 0)
+                // 看门狗: 超时时间根据链路统计自适应；电机停转由 rc_failsafe 的定时器负责，这里只管会话
+                uint32_t session_due;
+                if (rc_session_expire(&g_session, now, SESSION_TIMEOUT_MS))
                 {
-                    ESP_LOGI("UDP", "Received connection request from %s:%d",
-                             inet_ntoa(source_addr.sin_addr), ntohs(source_addr.sin_port));
-                    if (g_session.state == SESSION_IDLE)
-                    {
-                        g_session.state = SESSION_LOCKED;    // 状态变更为锁定
-                        g_session.client_addr = source_addr; // 记下这个人的地址
-                        g_session.last_packet_tick = now;    // 记录时间
-
-                        cJSON *device_item = cJSON_GetObjectItem(root, "device");
-                        char *device_str = device_item ? cJSON_GetStringValue(device_item) : "";
-                        snprintf(my_wifi_config.device_name, sizeof(my_wifi_config.device_name), "%s", device_str);
-
-                        ESP_LOGE("UDP", "Connected device: %s", my_wifi_config.device_name);
-                        // devices_name = cmd_item1 ? cJSON_GetStringValue(cmd_item1) : "";
-                        // ESP_LOGE("UDP", "Connected device: %s", devices_name);
-                        ESP_LOGI("SESSION", "New client connected!");
-
-                        // 发送回复 (ACK)，告诉手机连接成功
-                        const char *reply = "{\"status\":\"ok\"}";
-
-                        sendto(sock, reply, strlen(reply), 0, (struct sockaddr *)&source_addr, sizeof(source_addr));
-                    }
-                    else if (is_same_client(&source_addr, &g_session.client_addr))
-                    {
-                        // 已经是这个人了，重置心跳
-                        g_session.last_packet_tick = now;
-                        const char *reply = "{\"status\":\"ok\"}";
-
-                        sendto(sock, reply, strlen(reply), 0, (struct sockaddr *)&source_addr, sizeof(source_addr));
-                    }
-                    else
-                    {
-                        // 已经有别人连接了，拒绝!
-                        ESP_LOGW("SESSION", "Rejecting connection from other IP");
-
-                        // const char *reply = "{\"status\":\"busy\",\"device\":\"%s\"}";
-                        char reply[100];
-                        snprintf(reply, sizeof(reply), "{\"status\":\"busy\",\"device\":\"%s\"}", my_wifi_config.device_name);
-                        sendto(sock, reply, strlen(reply), 0, (struct sockaddr *)&source_addr, sizeof(source_addr));
-                    }
+                    const rc_link_stats_t *l = &g_session.link;
+                    ESP_LOGW("SESSION", "Client timed out! Resetting to IDLE. rx %lu lost %lu reorder %lu dup %lu jitter %luus",
+                             (unsigned long)l->received, (unsigned long)l->lost, (unsigned long)l->reordered,
+                             (unsigned long)l->duplicates, (unsigned long)l->jitter_us);
+                    rc_blog(RC_EV_SESSION_CLOSE, 1, l->received);
                 }
-
-                // ============================
-                // 场景 B: 处理控制指令 "ctrl"
-                // ============================
-                else if (strcmp(cmd_str, "ctrl") == 0)
+                else if (rc_session_deadline(&g_session, SESSION_TIMEOUT_MS, &session_due))
                 {
-                    // ESP_LOGE("UDP", "Received control command");
-                    //  char log_buf[256];
-                    //  snprintf(log_buf, sizeof(log_buf), "Received control command from %s:%d",
-                    //           inet_ntoa(source_addr.sin_addr), ntohs(source_addr.sin_port));
-                    //  ESP_LOGI("UDP", "%s", log_buf);
-
-                    // snprintf(log_buf, sizeof(log_buf), "g_session.state:%d,g_session.client_addr:%s:%d",
-                    //          g_session.state,
-                    //          inet_ntoa(g_session.client_addr.sin_addr),
-                    //          ntohs(g_session.client_addr.sin_port));
-                    // ESP_LOGI("UDP", "%s", log_buf);
-                    if (g_session.state == SESSION_LOCKED &&
-                        is_same_client(&source_addr, &g_session.client_addr))
-                    {
-                        g_session.last_packet_tick = now;
-
-                        // 解析所有字段
-                        cJSON *x1 = cJSON_GetObjectItem(root, "x1");
-                        cJSON *y1 = cJSON_GetObjectItem(root, "y1");
-
-                        cJSON *x2 = cJSON_GetObjectItem(root, "x2");
-                        cJSON *y2 = cJSON_GetObjectItem(root, "y2");
-
-                        cJSON *sc_h1 = cJSON_GetObjectItem(root, "sc_h1");
-                        cJSON *sc_v1 = cJSON_GetObjectItem(root, "sc_v1");
-
-                        // 按钮组 1
-                        cJSON *button_group1 = cJSON_GetObjectItem(root, "btn_g1");
-
-                        UiDataStruct ctrl_data = {0};
-
-                        // joystick1
-                        if (x1 && y1)
-                        {
-                            ctrl_data.joystick1.x = x1->valuedouble;
-                            ctrl_data.joystick1.y = y1->valuedouble;
-                        }
-
-                        // joystick2
-                        if (x2 && y2)
-                        {
-                            ctrl_data.joystick2.x = x2->valuedouble;
-                            ctrl_data.joystick2.y = y2->valuedouble;
-                        }
-
-                        // scroller
-                        if (sc_h1)
-                            ctrl_data.scroller_horiz1 = sc_h1->valuedouble;
-                        if (sc_v1)
-                            ctrl_data.scroller_vertical1 = sc_v1->valuedouble;
-
-                        // button group 1
-                        if (button_group1 && cJSON_IsArray(button_group1))
-                        {
-                            for (int i = 0; i < 10; i++)
-                            {
-                                cJSON *btn = cJSON_GetArrayItem(button_group1, i);
-                                ctrl_data.button_group1[i] = btn ? btn->valueint : 0;
-                            }
-                        }
-
-                        // debug log
-                        // ESP_LOGI("UDP", "Joystick1: (%.2f, %.2f)", ctrl_data.joystick1.x, ctrl_data.joystick1.y);
-                        // ESP_LOGI("UDP", "Joystick2: (%.2f, %.2f)", ctrl_data.joystick2.x, ctrl_data.joystick2.y);
-                        // ESP_LOGI("UDP", "Scroller: (%.2f, %.2f)", ctrl_data.scroller_horiz1, ctrl_data.scroller_vertical1);
-
-                        // ESP_LOGI("UDP", "Buttons:");
-                        // for (int i = 0; i < 10; i++)
-                        //     ESP_LOGI("UDP", "  [%d] = %d", i, ctrl_data.button_group1[i]);
-
-                        // 发送到电机任务
-                        xQueueOverwrite(robot_ctrl_queue, &ctrl_data);
-                        // 发送到 LVGL 任务
-                        xQueueOverwrite(lvgl_rc_queue, &ctrl_data);
-                    }
-                    else
-                    {
-                        // 忽略非连接者的控制指令
-                        // ESP_LOGD("UDP", "Ignored packet from unauthorized source");
-                    }
+                    // 期间收到过包，按最后一次收包时间重新计算
+                    rc_deadline_set(&deadlines, UDP_DL_SESSION, session_due);
                 }
+            }
+            else if (id == UDP_DL_TELEMETRY)
+            {
+                poll_telemetry(sock, now);
+            }
+            else if (id == UDP_DL_CTRL_FLUSH)
+            {
+                ctrl_state_flush(now);
+            }
+        }
+        update_deadlines(&deadlines, now);
 
-                // ============================
-                // 场景 C: 处理断开请求 "disconnect"
-                // ============================
-                else if (strcmp(cmd_str, "disconnect") == 0)
-                {
-                    if (g_session.state == SESSION_LOCKED && is_same_client(&source_addr, &g_session.client_addr))
-                    {
-                        ESP_LOGI("SESSION", "Client requested disconnect.");
-                        g_session.state = SESSION_IDLE;
-                        UiDataStruct stop_data = {0};
-                        xQueueOverwrite(robot_ctrl_queue, &stop_data);
-                        xQueueOverwrite(lvgl_rc_queue, &stop_data);
-                    }
-                }
+        // 2. 等待数据或最近的截止时间，没有会话时无限等待
+        struct timeval tv;
+        struct timeval *ptv = NULL;
+        uint32_t wait_ms;
+        if (rc_deadline_next(&deadlines, now, &wait_ms))
+        {
+            tv.tv_sec = wait_ms / 1000;
+            tv.tv_usec = (wait_ms % 1000) * 1000;
+            ptv = &tv;
+        }
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(sock, &rfds);
+        if (wake_fd >= 0)
+            FD_SET(wake_fd, &rfds);
+        int n = select(max_fd + 1, &rfds, NULL, NULL, ptv);
+        if (n < 0)
+        {
+            ESP_LOGE(TAG, "select failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        if (n == 0)
+            continue; // 截止时间到了，回到 1
+        if (wake_fd >= 0 && FD_ISSET(wake_fd, &rfds))
+            udp_telemetry_clear_wake(); // 下面第 4 步会发遥测
 
-                cJSON_Delete(root);
+        // 3. 把已经到达的包全部读完
+        for (;;)
+        {
+            socklen_t socklen = sizeof(source_addr);
+            int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, MSG_DONTWAIT,
+                               (struct sockaddr *)&source_addr, &socklen);
+            if (len < 0)
+                break;
+            s_rx_time_us = rc_lat_now();
+            now = now_ms();
+            if (len > 0)
+            {
+                // 录制原始负载 (没在录制时只是一次原子读)，要在 handle_packet 改写缓冲区之前
+                rc_peer_t peer = peer_of(&source_addr);
+                rec_capture((const uint8_t *)rx_buffer, len, s_rx_time_us, rc_session_is_client(&g_session, &peer));
+                handle_packet(sock, rx_buffer, len, &source_addr, now);
             }
         }
+
+        // 4. 收完包或者被故障变化唤醒后看一下遥测 (故障变化可以提前发送)，非阻塞，表空时什么都不做
+        poll_telemetry(sock, now);
+        update_deadlines(&deadlines, now);
     }
     vTaskDelete(NULL);
 }
 
 void wifi_udp_init()
 {
-    robot_ctrl_queue = xQueueCreate(1, sizeof(UiDataStruct));
-    lvgl_rc_queue = xQueueCreate(1, sizeof(UiDataStruct));
     wifi_info_semaphore = xSemaphoreCreateBinary();
 
     start_mdns_service();
 
+    if (load_pair_key_from_nvs(s_pair_key, sizeof(s_pair_key)) != ESP_OK || s_pair_key[0] == '\0')
+        ESP_LOGW(TAG, "No pairing key set, takeover disabled");
+
     uart_task_init();
+    ESP_ERROR_CHECK(failsafe_init());
+    ESP_ERROR_CHECK(shaping_init());
+    rec_init(); // 没有录制分区时只是不能录制
+    start_sta_webserver();
     xTaskCreate(udp_server_task, "udp_task", 4096 * 2, NULL, 5, NULL);
 }
 char wifi_info_buf[256];
@@ -334,8 +642,9 @@ static void wifi_sta_event_handler(void *arg, esp_event_base_t event_base,
                 ESP_LOGI(TAG, "网络服务启动......");
 
                 wifi_udp_init();
-                BaseType_t xHigherPriorityTaskWoken = pdFALSE; // 用于通知是否需要切换任务
-                xSemaphoreGiveFromISR(wifi_info_semaphore, &xHigherPriorityTaskWoken);
+                // 事件回调跑在事件循环任务里，不是中断；给完信号量叫醒 LVGL 任务去更新
+                xSemaphoreGive(wifi_info_semaphore);
+                lvgl_task_wake();
                 ESP_LOGI(TAG, "网络服务启动完成");
             }
         }
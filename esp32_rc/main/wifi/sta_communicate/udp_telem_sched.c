@@ -0,0 +1,34 @@
+#include "udp_telem_sched.h"
+
+void udp_telem_sched_init(udp_telem_sched_t *s, uint32_t period_ms, uint32_t urgent_min_ms)
+{
+    s->period_ms = period_ms;
+    s->urgent_min_ms = urgent_min_ms;
+    s->last_send_ms = 0;
+    s->urgent_pending = false;
+}
+
+bool udp_telem_sched_due(udp_telem_sched_t *s, bool urgent, uint32_t now_ms)
+{
+    uint32_t since = now_ms - s->last_send_ms;
+    if (urgent ? since < s->urgent_min_ms : since < s->period_ms)
+    {
+        s->urgent_pending = urgent;
+        return false;
+    }
+    return true;
+}
+
+void udp_telem_sched_done(udp_telem_sched_t *s, uint32_t now_ms)
+{
+    // 发送失败也从现在开始按常规周期退避: 链路不通时没必要 50 Hz 重试故障包
+    s->last_send_ms = now_ms;
+    s->urgent_pending = false;
+}
+
+uint32_t udp_telem_sched_next_due(const udp_telem_sched_t *s, uint32_t now_ms)
+{
+    uint32_t period = s->urgent_pending ? s->urgent_min_ms : s->period_ms;
+    uint32_t since = now_ms - s->last_send_ms;
+    return since >= period ? now_ms : s->last_send_ms + period;
+}
@@ -0,0 +1,41 @@
+#ifndef UDP_TELEM_SCHED_H
+#define UDP_TELEM_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * UDP 遥测的发送节奏 (纯逻辑，时间由调用者传入，见 udp_telemetry.c)
+ *
+ *   - 常规每 period_ms 发一包；故障变化 (urgent) 只要离上一包满 urgent_min_ms 就发;
+ *   - 这次没轮到的故障变化记为 pending，下一次到期时间按 urgent_min_ms 算;
+ *   - 发送失败 (WiFi 断开 / 发送缓冲满) 也要从这一刻起退避一个常规周期，
+ *     否则到期时间一直是 "现在"，UDP 任务的 select() 超时为 0，空转到会话超时。
+ */
+typedef struct {
+    uint32_t period_ms;
+    uint32_t urgent_min_ms;
+    uint32_t last_send_ms;    // 上一次发送 (或尝试发送) 的时间
+    bool urgent_pending;
+} udp_telem_sched_t;
+
+void udp_telem_sched_init(udp_telem_sched_t *s, uint32_t period_ms, uint32_t urgent_min_ms);
+
+/**
+ * @brief 现在该不该组包发送
+ *
+ * @param urgent 故障标志和上次发出去的不同
+ */
+bool udp_telem_sched_due(udp_telem_sched_t *s, bool urgent, uint32_t now_ms);
+
+/**
+ * @brief udp_telem_sched_due 返回 true 之后调用，不管是发出去了、没有变化不用发，还是全部发送失败
+ */
+void udp_telem_sched_done(udp_telem_sched_t *s, uint32_t now_ms);
+
+/**
+ * @brief 下一次该调用 udp_telem_sched_due 的时间 (毫秒)
+ */
+uint32_t udp_telem_sched_next_due(const udp_telem_sched_t *s, uint32_t now_ms);
+
+#endif
@@ -0,0 +1,253 @@
+#include "udp_telemetry.h"
+#include <string.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_wifi.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_vfs_eventfd.h"
+#include "rc_log.h"
+#include "rc_packet.h"
+#include "uart_telemetry.h"
+#include "udp_telem_sched.h"
+
+static const char *TAG = "UDP_TELEM";
+
+#define LINK_SEC_LEN  4
+#define MOTOR_SEC_LEN 20
+#define SYS_SEC_LEN   6
+
+static uint16_t s_seq = 0;
+static udp_telem_sched_t s_sched = {
+    .period_ms = UDP_TELEM_PERIOD_MS,
+    .urgent_min_ms = UDP_TELEM_URGENT_MIN_MS,
+};
+static uint32_t s_last_keyframe_ms = 0;
+static bool s_force_keyframe = true;
+static volatile uint32_t s_ctrl_latency_us = 0;
+
+// 上一次发出去的各段内容，用来判断是否有变化
+static uint8_t s_last_link[LINK_SEC_LEN];
+static uint8_t s_last_motor[MOTOR_SEC_LEN];
+static uint16_t s_last_faults = 0;
+static int s_wake_fd = -1;
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static uint32_t s_last_idle_counter = 0;
+static int64_t s_last_cpu_sample_us = 0;
+#endif
+
+static inline void wr_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void udp_telemetry_note_latency(uint32_t latency_us)
+{
+    s_ctrl_latency_us = latency_us;
+}
+
+void udp_telemetry_reset(void)
+{
+    s_force_keyframe = true;
+}
+
+int udp_telemetry_wake_fd(void)
+{
+    if (s_wake_fd >= 0)
+        return s_wake_fd;
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    esp_err_t err = esp_vfs_eventfd_register(&config);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) // INVALID_STATE: 已经注册过
+    {
+        ESP_LOGE(TAG, "eventfd register failed: %s", esp_err_to_name(err));
+        return -1;
+    }
+    s_wake_fd = eventfd(0, 0);
+    if (s_wake_fd < 0)
+        ESP_LOGE(TAG, "eventfd failed: errno %d", errno);
+    return s_wake_fd;
+}
+
+void udp_telemetry_kick(void)
+{
+    if (s_wake_fd < 0)
+        return;
+    uint64_t one = 1;
+    write(s_wake_fd, &one, sizeof(one));
+}
+
+void udp_telemetry_clear_wake(void)
+{
+    uint64_t cnt;
+    if (s_wake_fd >= 0)
+        read(s_wake_fd, &cnt, sizeof(cnt));
+}
+
+// 当前核的 CPU 占用率，需要开启 FreeRTOS 运行时间统计，否则返回 0xFF
+static uint8_t sample_cpu_load(void)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    int64_t now = esp_timer_get_time();
+    uint32_t idle = ulTaskGetIdleRunTimeCounter();
+    int64_t span = now - s_last_cpu_sample_us;
+    uint32_t idle_span = idle - s_last_idle_counter;
+    s_last_cpu_sample_us = now;
+    s_last_idle_counter = idle;
+    if (span <= 0 || idle_span > span)
+        return 0;
+    return (uint8_t)(100 - (idle_span * 100) / span);
+#else
+    return 0xFF;
+#endif
+}
+
+uint32_t udp_telemetry_next_due_ms(uint32_t now_ms)
+{
+    return udp_telem_sched_next_due(&s_sched, now_ms);
+}
+
+static void build_link(uint8_t *p)
+{
+    wifi_ap_record_t ap;
+    int8_t rssi = 0;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
+        rssi = ap.rssi;
+    uint32_t lat = s_ctrl_latency_us;
+    p[0] = (uint8_t)rssi;
+    p[1] = 0;
+    wr_u16(p + 2, lat > 0xFFFF ? 0xFFFF : (uint16_t)lat);
+}
+
+static bool build_motor(uint8_t *p, uint16_t *faults)
+{
+    motor_telemetry_t t;
+    if (!motor_telemetry_get(&t))
+        return false;
+    // UART 接收静默 (电机板掉电 / 线断了) 时不能一直报最后的数值，加上过期标志
+    uint16_t flags = t.fault_flags;
+    if (pdTICKS_TO_MS(xTaskGetTickCount() - t.rx_tick) > UDP_TELEM_MOTOR_STALE_MS)
+        flags |= MOTOR_FAULT_STALE;
+    wr_u16(p, t.battery_mv);
+    wr_u16(p + 2, flags);
+    for (int i = 0; i < MOTOR_COUNT; i++)
+    {
+        wr_u16(p + 4 + i * 2, (uint16_t)t.speed_rpm[i]);
+        wr_u16(p + 12 + i * 2, (uint16_t)t.current_ma[i]);
+    }
+    *faults = flags;
+    return true;
+}
+
+static void build_sys(uint8_t *p)
+{
+    uint32_t free_kb = heap_caps_get_free_size(MALLOC_CAP_DEFAULT) / 1024;
+    uint32_t min_kb = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT) / 1024;
+    wr_u16(p, free_kb > 0xFFFF ? 0xFFFF : (uint16_t)free_kb);
+    wr_u16(p + 2, min_kb > 0xFFFF ? 0xFFFF : (uint16_t)min_kb);
+    p[4] = sample_cpu_load();
+    p[5] = 0;
+}
+
+void udp_telemetry_poll(int sock, const struct sockaddr_in *dests, int n_dests, uint32_t now_ms)
+{
+    // 先看电机段：故障变化是高优先级，可以打断限速
+    uint8_t motor[MOTOR_SEC_LEN];
+    uint16_t faults = s_last_faults;
+    bool have_motor = build_motor(motor, &faults);
+    bool urgent = have_motor && faults != s_last_faults;
+
+    if (!udp_telem_sched_due(&s_sched, urgent, now_ms))
+        return;
+    if (n_dests <= 0)
+    {
+        udp_telem_sched_done(&s_sched, now_ms);
+        return;
+    }
+
+    bool keyframe = s_force_keyframe || (now_ms - s_last_keyframe_ms) >= UDP_TELEM_KEYFRAME_MS;
+
+    uint8_t link[LINK_SEC_LEN];
+    uint8_t sys[SYS_SEC_LEN];
+    build_link(link);
+    // 堆和 CPU 变化慢，只在关键帧里采样
+    if (keyframe)
+        build_sys(sys);
+
+    uint8_t sections = 0;
+    if (keyframe || memcmp(link, s_last_link, sizeof(link)) != 0)
+        sections |= UDP_TELEM_SEC_LINK;
+    if (have_motor && (keyframe || memcmp(motor, s_last_motor, sizeof(motor)) != 0))
+        sections |= UDP_TELEM_SEC_MOTOR;
+    if (keyframe)
+        sections |= UDP_TELEM_SEC_SYS;
+
+    if (sections == 0)
+    {
+        // 没有变化，不浪费空口，下一个周期再看
+        udp_telem_sched_done(&s_sched, now_ms);
+        return;
+    }
+
+    uint8_t pkt[UDP_TELEM_MAX_LEN];
+    size_t n = 0;
+    pkt[n++] = UDP_TELEM_MAGIC0;
+    pkt[n++] = UDP_TELEM_MAGIC1;
+    pkt[n++] = UDP_TELEM_VERSION;
+    pkt[n++] = sections;
+    wr_u16(pkt + n, s_seq);
+    n += 2;
+    if (sections & UDP_TELEM_SEC_LINK)
+    {
+        memcpy(pkt + n, link, sizeof(link));
+        n += sizeof(link);
+    }
+    if (sections & UDP_TELEM_SEC_MOTOR)
+    {
+        memcpy(pkt + n, motor, sizeof(motor));
+        n += sizeof(motor);
+    }
+    if (sections & UDP_TELEM_SEC_SYS)
+    {
+        memcpy(pkt + n, sys, sizeof(sys));
+        n += sizeof(sys);
+    }
+    wr_u16(pkt + n, rc_crc16_ccitt(pkt, n));
+    n += 2;
+
+    // MSG_DONTWAIT: 发送缓冲满了就丢掉这一包，绝不阻塞接收循环
+    int delivered = 0;
+    for (int i = 0; i < n_dests; i++)
+    {
+        int sent = sendto(sock, pkt, n, MSG_DONTWAIT, (const struct sockaddr *)&dests[i], sizeof(dests[i]));
+        if (sent < 0)
+        {
+            rc_blog(RC_EV_TELEM_ERR, i, errno);
+            RC_LOG(TELEM, ESP_LOG_DEBUG, TAG, "sendto failed: errno %d", errno);
+            continue;
+        }
+        delivered++;
+    }
+    // 全部失败也要推后下一次到期时间，不然 UDP 任务会以 0 超时空转；
+    // 序号和差量基准不动，链路恢复后照常发出这些变化
+    udp_telem_sched_done(&s_sched, now_ms);
+    if (delivered == 0)
+        return;
+
+    s_seq++;
+    if (sections & UDP_TELEM_SEC_LINK)
+        memcpy(s_last_link, link, sizeof(link));
+    if (sections & UDP_TELEM_SEC_MOTOR)
+    {
+        memcpy(s_last_motor, motor, sizeof(motor));
+        s_last_faults = faults;
+    }
+    if (keyframe)
+    {
+        s_last_keyframe_ms = now_ms;
+        s_force_keyframe = false;
+    }
+}
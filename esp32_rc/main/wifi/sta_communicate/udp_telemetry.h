@@ -0,0 +1,95 @@
+#ifndef UDP_TELEMETRY_H
+#define UDP_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lwip/sockets.h"
+
+/*
+ * 机器人 -> 手机 的遥测回传 (与控制共用同一个 UDP socket，发给控制者和所有旁观者)
+ *
+ * 报文 (小端):
+ *   0  magic[2]  'R' 'T'
+ *   2  version   UDP_TELEM_VERSION
+ *   3  sections  本包包含哪些数据段 (UDP_TELEM_SEC_*)，按位从低到高依次排列
+ *   4  seq       uint16
+ *   6  ...       数据段
+ *   N  crc       CRC-16/CCITT-FALSE，覆盖前面全部字节
+ *
+ * 数据段:
+ *   LINK  (4 字节) rssi int8, reserved, ctrl_latency_us uint16
+ *   MOTOR (20字节) battery_mv uint16, fault_flags uint16, speed_rpm int16[4], current_ma int16[4]
+ *                  超过 UDP_TELEM_MOTOR_STALE_MS 没收到电机板遥测时，fault_flags 带上 MOTOR_FAULT_STALE，
+ *                  其余字段是最后一次收到的值
+ *   SYS   (6 字节) free_heap_kb uint16, min_free_heap_kb uint16, cpu_load % uint8 (0xFF=未知), reserved
+ *
+ * 只发送有变化的段，每 UDP_TELEM_KEYFRAME_MS 发一次全量关键帧；
+ * 故障标志变化时跳过限速立即发送: UART 接收任务调用 udp_telemetry_kick() 唤醒 UDP 任务的 select()，
+ * 不用等到下一个周期或者下一个 UDP 包。
+ */
+#define UDP_TELEM_MAGIC0  'R'
+#define UDP_TELEM_MAGIC1  'T'
+#define UDP_TELEM_VERSION 1
+
+#define UDP_TELEM_SEC_LINK  (1u << 0)
+#define UDP_TELEM_SEC_MOTOR (1u << 1)
+#define UDP_TELEM_SEC_SYS   (1u << 2)
+#define UDP_TELEM_SEC_ALL   (UDP_TELEM_SEC_LINK | UDP_TELEM_SEC_MOTOR | UDP_TELEM_SEC_SYS)
+
+#define UDP_TELEM_MAX_LEN 40
+
+// 常规发送间隔 (10 Hz)
+#define UDP_TELEM_PERIOD_MS   100
+// 全量关键帧间隔
+#define UDP_TELEM_KEYFRAME_MS 1000
+// 高优先级 (故障) 报文之间的最小间隔
+#define UDP_TELEM_URGENT_MIN_MS 20
+// 电机板遥测多久没更新算过期 (电机板约 50 Hz 上报)
+#define UDP_TELEM_MOTOR_STALE_MS 300
+
+/**
+ * @brief 创建唤醒 UDP 任务用的 eventfd，UDP 任务启动时调用一次
+ *
+ * @return 可以放进 select() 读集合的 fd，失败返回 -1 (这时故障只能随下一个周期发出)
+ */
+int udp_telemetry_wake_fd(void);
+
+/**
+ * @brief 有高优先级遥测 (故障变化) 要发，唤醒 UDP 任务，任何任务都可以调用
+ */
+void udp_telemetry_kick(void);
+
+/**
+ * @brief select() 报告唤醒 fd 可读后调用，清掉计数
+ */
+void udp_telemetry_clear_wake(void);
+
+/**
+ * @brief 记录最近一次控制帧从 recvfrom 到分发完成的耗时
+ */
+void udp_telemetry_note_latency(uint32_t latency_us);
+
+/**
+ * @brief 会话建立 / 断开时调用，下一包强制发送全量关键帧
+ */
+void udp_telemetry_reset(void);
+
+/**
+ * @brief 在 UDP 任务的循环里调用，到期才发送，socket 非阻塞，不分配内存
+ *
+ * 每个周期只组一次包，依次发给 dests 里的每个地址 (同一个序号)。
+ * 有新的旁观者加入时调用 udp_telemetry_reset()，让它马上拿到关键帧。
+ *
+ * @param sock    UDP socket
+ * @param dests   控制者和旁观者的地址
+ * @param n_dests 地址个数
+ * @param now_ms  当前时间 (毫秒)
+ */
+void udp_telemetry_poll(int sock, const struct sockaddr_in *dests, int n_dests, uint32_t now_ms);
+
+/**
+ * @brief 下一次常规发送的时间 (毫秒)，给 UDP 任务的截止时间队列用
+ */
+uint32_t udp_telemetry_next_due_ms(uint32_t now_ms);
+
+#endif
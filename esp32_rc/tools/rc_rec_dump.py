@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+解出遥控器录下的控制会话 (GET /api/rec/data，格式见 main/wifi/sta_communicate/rc_replay.h)
+
+用法:
+    python rc_rec_dump.py rc_rec.bin
+    python rc_rec_dump.py http://my-robot.local/api/rec/data --save rc_rec.bin
+    python rc_rec_dump.py rc_rec.bin --raw                  # 每包原样打印 (JSON 是文本，二进制帧打十六进制)
+
+默认每包一行: 时间 (ms)、间隔、长度、来源、内容摘要，最后统计包间隔分布。
+"""
+import argparse
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct("<4sHHIIII8x")
+ENTRY = struct.Struct("<IHH")
+FLAG_CLIENT = 1
+
+# rc_packet.h 的二进制控制帧: 'R' 'C' version flags seq x1 y1 x2 y2 sc_h1 sc_v1 btn_g1 btn_g2 crc
+CTRL_PKT = struct.Struct("<2sBBHhhhhhhHHH")
+
+
+def load(src):
+    if src.startswith("http://") or src.startswith("https://"):
+        with urllib.request.urlopen(src, timeout=30) as r:
+            return r.read()
+    with open(src, "rb") as f:
+        return f.read()
+
+
+def parse(data):
+    if len(data) < HEADER.size:
+        raise ValueError("file too short")
+    magic, version, header_size, records, data_bytes, dropped, duration_us = HEADER.unpack_from(data)
+    if magic != b"RCRC":
+        raise ValueError("bad magic %r (recording not stopped?)" % magic)
+    if version != 1 or header_size != HEADER.size:
+        raise ValueError("unsupported version %d / header size %d" % (version, header_size))
+
+    entries = []
+    off = header_size
+    end = min(len(data), header_size + data_bytes)
+    while off + ENTRY.size <= end:
+        t_us, length, flags = ENTRY.unpack_from(data, off)
+        payload = data[off + ENTRY.size:off + ENTRY.size + length]
+        if len(payload) != length:
+            break
+        entries.append((t_us, flags, payload))
+        off += (ENTRY.size + length + 3) & ~3
+    return {"records": records, "dropped": dropped, "duration_us": duration_us}, entries
+
+
+def summary(payload):
+    if len(payload) == CTRL_PKT.size and payload[:2] == b"RC":
+        _, ver, _, seq, x1, y1, x2, y2, h1, v1, g1, g2, _ = CTRL_PKT.unpack(payload)
+        return "bin seq=%d x1=%d y1=%d x2=%d y2=%d sc=%d/%d btn=%03x/%03x" % (seq, x1, y1, x2, y2, h1, v1, g1, g2)
+    try:
+        return payload.decode("utf-8")
+    except UnicodeDecodeError:
+        return payload.hex()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="录制文件或 http://.../api/rec/data")
+    ap.add_argument("--save", help="同时把原始数据保存到这个文件")
+    ap.add_argument("--raw", action="store_true", help="不做解析，直接打印负载")
+    args = ap.parse_args()
+
+    data = load(args.source)
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(data)
+
+    try:
+        info, entries = parse(data)
+    except ValueError as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    print("# %d records (header says %d), %d dropped, %.1f s" %
+          (len(entries), info["records"], info["dropped"], info["duration_us"] / 1e6))
+    prev = None
+    gaps = []
+    for t_us, flags, payload in entries:
+        gap = (t_us - prev) / 1000.0 if prev is not None else 0.0
+        if prev is not None:
+            gaps.append(gap)
+        prev = t_us
+        src = "client" if flags & FLAG_CLIENT else "other"
+        if not args.raw:
+            body = summary(payload)
+        elif payload[:2] == b"RC":
+            body = payload.hex()
+        else:
+            body = payload.decode("utf-8", "replace")
+        print("%10.3f %+8.3f %4d %-6s %s" % (t_us / 1000.0, gap, len(payload), src, body))
+
+    if gaps:
+        gaps.sort()
+        pick = lambda p: gaps[min(len(gaps) - 1, int(p * len(gaps)))]
+        print("# gap ms: min %.3f p50 %.3f p99 %.3f max %.3f" % (gaps[0], pick(0.5), pick(0.99), gaps[-1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
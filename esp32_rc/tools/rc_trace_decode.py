@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+解码遥控器导出的二进制 trace (GET /api/trace，格式见 main/wifi/sta_communicate/rc_log.h)
+
+用法:
+    python rc_trace_decode.py rc_trace.bin
+    python rc_trace_decode.py http://192.168.4.1/api/trace      # 配网模式
+    python rc_trace_decode.py http://my-robot.local/api/trace   # 连上路由器后
+    python rc_trace_decode.py rc_trace.bin --last 2000          # 只看每次启动最后 2 秒
+
+按启动 (boot 事件) 分段输出，时间是相对这次启动里第一条记录的毫秒数。
+"""
+import argparse
+import ipaddress
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<IIHHI")
+
+# 顺序必须和 rc_log.h 里的 rc_blog_event_t 一致
+EVENTS = [
+    "none",
+    "session_open",
+    "session_close",
+    "session_busy",
+    "pkt_bad",
+    "pkt_stale",
+    "uart_tx",
+    "uart_drop",
+    "failsafe",
+    "motor_fault",
+    "telem_err",
+    "boot",
+    "pkt_rx",
+    "overwrite",
+    "lvgl_flush",
+    "button",
+    "spectate",
+    "takeover",
+]
+
+# esp_reset_reason_t
+RESET_REASONS = {
+    0: "unknown", 1: "poweron", 2: "ext", 3: "sw", 4: "panic", 5: "int_wdt",
+    6: "task_wdt", 7: "wdt", 8: "deepsleep", 9: "brownout", 10: "sdio",
+}
+
+
+def ip(b):
+    # lwIP 的 s_addr 是网络字节序，按小端读出来正好是内存里的顺序
+    return str(ipaddress.IPv4Address(struct.pack("<I", b)))
+
+
+def describe(ev, a, b):
+    name = EVENTS[ev] if ev < len(EVENTS) else "ev%d" % ev
+    if name in ("session_open", "session_busy", "spectate"):
+        return name, "%s:%d" % (ip(b), a)
+    if name == "session_close":
+        return name, "%s rx=%d" % ("timeout" if a else "disconnect", b)
+    if name == "pkt_rx":
+        return name, "len=%d from %s" % (a, ip(b))
+    if name == "pkt_stale":
+        return name, "seq=%d last=%d" % (a, b)
+    if name == "uart_tx":
+        return name, "len=%d %s" % (a, {1: "changed", 2: "keepalive"}.get(b, str(b)))
+    if name == "uart_drop":
+        return name, "len=%d err=0x%x" % (a, b)
+    if name == "failsafe":
+        return name, "len=%d emit=%dus" % (a, b)
+    if name == "motor_fault":
+        return name, "flags=0x%04x" % a
+    if name == "telem_err":
+        return name, "dest=%d errno=%d" % (a, b)
+    if name == "boot":
+        return name, "reason=%s boot#%d" % (RESET_REASONS.get(a, str(a)), b)
+    if name == "overwrite":
+        return name, "%s n=%d" % ("ctrl_bus" if a == 0 else "uart_tx", b)
+    if name == "lvgl_flush":
+        return name, "chunks=%d px=%d" % (a, b)
+    if name == "button":
+        return name, "event=%d" % a
+    if name == "takeover":
+        return name, "%s from %s" % ({0: "denied", 1: "ok", 2: "outranked"}.get(a, str(a)), ip(b))
+    return name, "a=%d b=%d" % (a, b)
+
+
+def load(src):
+    if src.startswith("http://") or src.startswith("https://"):
+        with urllib.request.urlopen(src, timeout=10) as r:
+            return r.read()
+    with open(src, "rb") as f:
+        return f.read()
+
+
+def parse(data):
+    if len(data) < HEADER.size:
+        raise ValueError("file too short")
+    magic, version, entry_size, capacity, boot_count = HEADER.unpack_from(data)
+    if magic != b"RCTR":
+        raise ValueError("bad magic %r" % magic)
+    if version != 1 or entry_size != ENTRY.size:
+        raise ValueError("unsupported version %d / entry size %d" % (version, entry_size))
+
+    entries = []
+    for off in range(HEADER.size, len(data) - ENTRY.size + 1, ENTRY.size):
+        seq, t_us, ev, a, b = ENTRY.unpack_from(data, off)
+        if seq:
+            entries.append((seq, t_us, ev, a, b))
+    entries.sort()
+    return capacity, boot_count, entries
+
+
+def is_boot(ev):
+    return ev == EVENTS.index("boot")
+
+
+def split_boots(entries):
+    boots = [[]]
+    for e in entries:
+        if is_boot(e[2]):
+            if boots[-1]:
+                boots.append([])
+        boots[-1].append(e)
+    return [b for b in boots if b]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="trace 文件或 http://.../api/trace")
+    ap.add_argument("--last", type=float, default=0, help="每次启动只显示最后 N 毫秒")
+    ap.add_argument("--save", help="同时把原始数据保存到这个文件")
+    args = ap.parse_args()
+
+    data = load(args.source)
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(data)
+
+    try:
+        capacity, boot_count, entries = parse(data)
+    except ValueError as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    print("# capacity %d, current boot #%d, %d records" % (capacity, boot_count, len(entries)))
+    for boot in split_boots(entries):
+        t0 = boot[0][1]
+        t_end = boot[-1][1]
+        header = "boot" if is_boot(boot[0][2]) else "(earlier records, boot event overwritten)"
+        print("\n=== %s, %.1f ms of history ===" % (header, ((t_end - t0) & 0xFFFFFFFF) / 1000.0))
+        for seq, t_us, ev, a, b in boot:
+            if args.last and ((t_end - t_us) & 0xFFFFFFFF) / 1000.0 > args.last:
+                continue
+            name, detail = describe(ev, a, b)
+            print("%8d %10.3f ms  %-14s %s" % (seq, ((t_us - t0) & 0xFFFFFFFF) / 1000.0, name, detail))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())